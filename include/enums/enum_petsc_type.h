@@ -94,6 +94,7 @@ namespace SolverSpecify
                            SSOR_PRECOND,
                            EISENSTAT_PRECOND,
                            BOOMERAMG_PRECOND,
+                           GAMG_PRECOND,
                            ASM_PRECOND,
                            ASMILU0_PRECOND,
                            ASMILU1_PRECOND,
@@ -106,6 +107,7 @@ namespace SolverSpecify
                            ILUT_PRECOND,
                            LU_PRECOND,
                            PARMS_PRECOND,
+                           SCHUR_PRECOND,
                            USER_PRECOND,
                            SHELL_PRECOND,
                            INVALID_PRECONDITIONER};
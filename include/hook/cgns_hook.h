@@ -110,6 +110,36 @@ private:
    * if we are in ddmac mode
    */
   bool            _ddm_ac;
+
+  /**
+   * write files in background by AsyncWriter
+   */
+  bool            _async;
+
+  /**
+   * write all the snapshots into one cgns file, the mesh is stored only once
+   */
+  bool            _series;
+
+  /**
+   * time (voltage, current) of each snapshot in the series
+   */
+  std::vector<double> _series_values;
+
+  /**
+   * voltage of the first VScan electrode
+   */
+  double scan_voltage() const;
+
+  /**
+   * current of the first IScan electrode
+   */
+  double scan_current() const;
+
+  /**
+   * write a snapshot, return the file name
+   */
+  std::string export_cgns(double value);
 };
 
 #endif
@@ -0,0 +1,114 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __gsol_hook_h__
+#define __gsol_hook_h__
+
+
+#include "hook.h"
+#include <string>
+
+/**
+ * write solution to GSOL binary files, one file (set) per solution step
+ */
+class GSOLHook : public Hook
+{
+
+public:
+  GSOLHook(SolverBase & solver, const std::string & name, void *);
+
+  virtual ~GSOLHook();
+
+  /**
+   *   This is executed before the initialization of the solver
+   */
+  virtual void on_init();
+
+  /**
+   *   This is executed previously to each solution step.
+   */
+  virtual void pre_solve();
+
+  /**
+   *  This is executed after each solution step.
+   */
+  virtual void post_solve();
+
+  /**
+   *  This is executed after each (nonlinear) iteration
+   */
+  virtual void post_iteration();
+
+  /**
+   * This is executed after the finalization of the solver
+   */
+  virtual void on_close();
+
+private:
+
+  /**
+   * the output file name
+   */
+  std::string     _gsol_prefix;
+
+  /**
+  * count
+  */
+  unsigned int count;
+
+  /**
+   * last transient time
+   */
+  double _t_last;
+
+  /**
+   * transient time step
+   */
+  double _t_step;
+
+  /**
+   * relative error bound of stored values, 0 for lossless
+   */
+  double _precision;
+
+  /**
+   * deflate the columns
+   */
+  bool            _compress;
+
+  /**
+   * write checkpoint (full solver state) instead of solution only
+   */
+  bool            _checkpoint;
+
+  /**
+   * write files in background by AsyncWriter
+   */
+  bool            _async;
+
+  /**
+   * write a snapshot with given time (or sweep) value
+   */
+  void export_gsol(double value);
+};
+
+#endif
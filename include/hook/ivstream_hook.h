@@ -0,0 +1,142 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __ivstream_hook_h__
+#define __ivstream_hook_h__
+
+
+#include "hook.h"
+#include <string>
+#include <vector>
+#include <fstream>
+
+/**
+ * stream electrode V/I/Q and other scalar monitors to a binary column file.
+ * the file is append only: rows are buffered and written as a column major block
+ * every n steps, each block is closed by its row count, so the file is always
+ * readable (i.e. while the simulation is running) and a crash loses at most the
+ * rows not yet flushed. memory usage is bounded by the block size.
+ *
+ * file layout, native byte order which is checked by a marker:
+ *   header : "GIVS", version, byte order marker, n_columns, (name, unit) for each column
+ *   block  : n_rows, n_columns x n_rows doubles (column major), n_rows again
+ *
+ * the solution DOM only keeps an index (file name and row) for each solution
+ * instead of the terminal info of every step.
+ */
+class IVStreamHook : public Hook
+{
+
+public:
+  IVStreamHook(SolverBase & solver, const std::string & name, void *);
+
+  virtual ~IVStreamHook();
+
+  /**
+   *   This is executed before the initialization of the solver
+   */
+  virtual void on_init();
+
+  /**
+   *   This is executed previously to each solution step.
+   */
+  virtual void pre_solve();
+
+  /**
+   *  This is executed after each solution step.
+   */
+  virtual void post_solve();
+
+  /**
+   *  This is executed after each (nonlinear) iteration
+   */
+  virtual void post_iteration();
+
+  /**
+   * This is executed after the finalization of the solver
+   */
+  virtual void on_close();
+
+private:
+
+  /**
+   * the output file name
+   */
+  std::string     _ivs_file;
+
+  /**
+   * file stream
+   */
+  std::ofstream   _out;
+
+  /**
+   * if we are in mixA mode
+   */
+  bool            _mixA;
+
+  /**
+   * unsupported solver type, do nothing
+   */
+  bool            _disabled;
+
+  /**
+   * remove terminal info from the solution DOM, keep index only
+   */
+  bool            _dom_compact;
+
+  /**
+   * rows per block
+   */
+  unsigned int    _block_rows;
+
+  /**
+   * total rows written or buffered
+   */
+  unsigned int    _n_rows;
+
+  /**
+   * the column (name, unit)
+   */
+  std::vector<std::pair<std::string, std::string> >  _columns;
+
+  /**
+   * rows not flushed yet, row major
+   */
+  std::vector<double> _buffer;
+
+  /**
+   * electrode current of last step, for charge integral
+   */
+  std::vector<double> _current_last;
+
+  /**
+   * electrode charge, integral of current in transient
+   */
+  std::vector<double> _charge;
+
+  /**
+   * write buffered rows as one block
+   */
+  void _flush_block();
+};
+
+#endif
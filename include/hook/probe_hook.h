@@ -26,9 +26,23 @@
 
 #include "hook.h"
 #include <ctime>
+#include <vector>
+#include <string>
+#include <fstream>
+
+class Elem;
 
 /**
- * write electrode IV into file which can be plotted by probe
+ * sample solution at a set of probe points.
+ * the points are given by x/y/z parameters (one point) and/or a file with
+ * "x y z [label]" (in um) per line. each point is located once by the mesh
+ * point locator, and the value is interpolated by the shape function of the
+ * containing element. only the processor owns the element evaluates the point,
+ * all the samples are reduced by a single collective per step.
+ *
+ * the output can be gnuplot text (default), csv, or binary. the binary file is a
+ * text header line followed by fixed size records of n_columns doubles, so column
+ * j of step k is at offset header + (k*n_columns + j)*sizeof(double).
  */
 class ProbeHook : public Hook
 {
@@ -65,17 +79,44 @@ public:
 
 private:
 
-
  SolverBase*     _p_solver;
 
  /**
-  * probe point
+  * a probe point with its interpolation data
   */
- Point _pp;
+ struct ProbePoint
+ {
+   Point          p;
+   std::string    label;
+
+   /**
+    * index of region contains this point, -1 when the point is outside the device
+    */
+   int            region;
+
+   /**
+    * first column of this point in the sample vector
+    */
+   unsigned int   column;
+
+   /**
+    * nodes and shape function weights, only on the processor owns the element
+    */
+   std::vector<const FVM_Node *> nodes;
+   std::vector<Real>             weights;
+ };
+
+ std::vector<ProbePoint> _points;
 
- const FVM_Node* _p_fvm_node;
+ /**
+  * total number of sampled values per step
+  */
+ unsigned int    _n_samples;
 
- unsigned int    _min_loc;
+ /**
+  * output format
+  */
+ enum OutputFormat {GNUPLOT, CSV, BINARY} _format;
 
  /**
   * the output file name
@@ -87,6 +128,20 @@ private:
   */
  std::ofstream   _out;
 
+ /**
+  * read probe points from file
+  */
+ void _load_points(const std::string & file);
+
+ /**
+  * @return the number of sampled variables of region r
+  */
+ unsigned int _n_variables(int r) const;
+
+ /**
+  * write the row of one step
+  */
+ void _write_row(const std::vector<double> & row);
 
 };
 
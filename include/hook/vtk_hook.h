@@ -72,6 +72,11 @@ private:
    */
   std::string     _vtk_prefix;
 
+  /**
+   * file extension, ".pvtu" for parallel output
+   */
+  std::string     _vtk_suffix;
+
   /**
   * count
   */
@@ -112,6 +117,11 @@ private:
    * if we are in ddmac mode
    */
   bool            _ddm_ac;
+
+  /**
+   * write files in background by AsyncWriter
+   */
+  bool            _async;
 };
 
 #endif
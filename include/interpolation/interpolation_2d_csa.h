@@ -42,6 +42,11 @@ public:
    */
   double get_interpolated_value(const Point & point, int group) const;
 
+  /**
+   * get interpolated values with GROUP_ID group at an array of points, evaluated by csa in one batch
+   */
+  void get_interpolated_values(const std::vector<Point> & points, int group, std::vector<double> & values) const;
+
 private:
 
   std::map<int, CSA::csa *>  field_map;  //
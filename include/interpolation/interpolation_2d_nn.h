@@ -41,6 +41,11 @@ public:
    */
   double get_interpolated_value(const Point & point, int group) const;
 
+  /**
+   * get interpolated values with GROUP_ID group at an array of points, in spatial order
+   */
+  void get_interpolated_values(const std::vector<Point> & points, int group, std::vector<double> & values) const;
+
 private:
 
 
@@ -58,6 +63,10 @@ private:
     NN::delaunay * d;
     /// linear interpolator
     NN::lpi      *li;
+    /// delaunay diagram is owned by another group with the same scatter points
+    bool shared_d;
+
+    DATA() : n(0), d(0), li(0), shared_d(false) {}
   };
 
   std::map<int, DATA> field;
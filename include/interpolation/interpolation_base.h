@@ -4,6 +4,8 @@
 #include <cassert>
 #include <map>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 #include "point.h"
 
@@ -67,6 +69,22 @@ public:
    */
   virtual double get_interpolated_value(const Point & point, int group)const=0;
 
+  /**
+   * get interpolated values with GROUP_ID group at an array of points.
+   * the queries are evaluated in spatial order, so the search of backend
+   * starts near the previous result. derived class can override it with
+   * a real batch evaluation
+   */
+  virtual void get_interpolated_values(const std::vector<Point> & points, int group, std::vector<double> & values) const
+  {
+    std::vector<unsigned int> order;
+    spatial_order(points, order);
+
+    values.resize(points.size());
+    for(unsigned int n=0; n<order.size(); ++n)
+      values[order[n]] = get_interpolated_value(points[order[n]], group);
+  }
+
   /**
    * InterpolationType, should support linear (for potential, etc) and asinh (doping concentration and carrier density)
    */
@@ -91,6 +109,44 @@ protected:
 
   //how to store the point and their value?
 
+  /**
+   * sort the points along Morton (Z-order) curve of their bounding box,
+   * order[n] is the index of n-th point in spatial order
+   */
+  static void spatial_order(const std::vector<Point> & points, std::vector<unsigned int> & order)
+  {
+    order.resize(points.size());
+    if(points.empty()) return;
+
+    Point p_min = points[0];
+    Point p_max = points[0];
+    for(unsigned int n=1; n<points.size(); ++n)
+      for(unsigned int d=0; d<3; ++d)
+      {
+        p_min(d) = std::min(p_min(d), points[n](d));
+        p_max(d) = std::max(p_max(d), points[n](d));
+      }
+
+    // 10 bits each dimension
+    std::vector<std::pair<unsigned int, unsigned int> > keys(points.size());
+    for(unsigned int n=0; n<points.size(); ++n)
+    {
+      unsigned int key = 0;
+      for(unsigned int d=0; d<3; ++d)
+      {
+        double range = p_max(d) - p_min(d);
+        unsigned int c = range > 0.0 ? static_cast<unsigned int>((points[n](d) - p_min(d))/range*1023.0) : 0;
+        for(unsigned int bit=0; bit<10; ++bit)
+          key |= ((c >> bit) & 1) << (3*bit + d);
+      }
+      keys[n] = std::make_pair(key, n);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    for(unsigned int n=0; n<keys.size(); ++n)
+      order[n] = keys[n].second;
+  }
+
   inline double scaleValue(InterpolationType type, const double value) const
   {
     switch(type)
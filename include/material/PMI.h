@@ -30,6 +30,7 @@
 
 #include "parser_parameter.h"   // for parameter calibrating from user input file
 #include "adolc.h" // for automatic differentiation
+#include "function_table.h" // for tabulated material function
 #include "variable_define.h"
 
 using namespace adtl;
@@ -37,6 +38,7 @@ using namespace adtl;
 //predefine
 class Point;
 class FVM_NodeData;
+class DataStorage;
 
 
 //enable calibrate
@@ -106,20 +108,27 @@ struct PMI_Environment
    */
   double   K;
 
+  /**
+   * relative error bound of tabulated functions (FunctionTable), 0 for direct evaluation
+   */
+  double   table_tol;
+
   /**
    * constructor
    */
   PMI_Environment(const Point** point, const FVM_NodeData **node_data, const PetscScalar *time,
                   const std::map<std::string, SimulationVariable> ** variables,
                   double _m_, double _s_, double _V_, double _C_, double _K_)
-  : pp_point(point), pp_node_data(node_data), p_clock(time), pp_variables(variables), m(_m_), s(_s_), V(_V_), C(_C_), K(_K_)
+  : pp_point(point), pp_node_data(node_data), p_clock(time), pp_variables(variables), m(_m_), s(_s_), V(_V_), C(_C_), K(_K_),
+    table_tol(FunctionTable::default_tolerance())
   {}
 
   /**
    * constructor
    */
   PMI_Environment(double _m_, double _s_, double _V_, double _C_, double _K_)
-  : pp_point(0), pp_node_data(0), p_clock(0), pp_variables(0), m(_m_), s(_s_), V(_V_), C(_C_), K(_K_)
+  : pp_point(0), pp_node_data(0), p_clock(0), pp_variables(0), m(_m_), s(_s_), V(_V_), C(_C_), K(_K_),
+    table_tol(FunctionTable::default_tolerance())
   {}
 
 };
@@ -266,6 +275,56 @@ protected:
    */
   std::string PMI_Info;
 
+  /**
+   * register a per-node constant coefficient, which only depends on doping, mole fraction
+   * or other data fixed for the whole simulation. should be called in the constructor.
+   * @return the index of the coefficient
+   */
+  unsigned int RegisterNodeCoefficient(const std::string & name);
+
+  /**
+   * read the prepared coefficient of current node.
+   * @return false when the coefficient is not prepared for current node, the model
+   * should evaluate it directly then
+   */
+  bool ReadNodeCoefficient(const unsigned int i, PetscScalar & value) const;
+
+private:
+
+  /**
+   * name of per-node coefficients
+   */
+  std::vector<std::string>  _node_coefficient_names;
+
+  /**
+   * the variable index of per-node coefficients in region data storage
+   */
+  std::vector<unsigned int> _node_coefficient_index;
+
+  /**
+   * the region data storage which holds the coefficients
+   */
+  const DataStorage *       _node_coefficient_storage;
+
+public:
+  /**
+   * @return the name of per-node coefficients
+   */
+  const std::vector<std::string> & node_coefficient_names() const
+  { return _node_coefficient_names; }
+
+  /**
+   * set the variable index of per-node coefficient i in region data storage,
+   * called by main code after the coefficients are computed by prepare_node
+   */
+  void set_node_coefficient_index(const unsigned int i, const unsigned int index, const DataStorage * storage);
+
+  /**
+   * compute the per-node coefficients of current node, called by main code once
+   * the doping is set and after PMI calibration. default do nothing
+   */
+  virtual void prepare_node(std::vector<PetscScalar> & ) {}
+
 public:
   /**
    * aux function return node coordinate.
@@ -349,7 +408,8 @@ public:
 public:
   /**
    * constructor, link PMI object to material class
-   * also set the physical constants
+   * also set the physical constants and the default tolerance of FunctionTable,
+   * expensive 1D model functions can be tabulated by FunctionTable with this tolerance
    */
   PMI_Server(const PMI_Environment &env);
 
@@ -95,10 +95,12 @@ public:
 
 
   /**
-   * function pointer to set_ad_number, set the independent variable
-   * number of automatically differentiation
+   * set the independent variable number of automatically differentiation
+   * to the material library. built-in material shares the AD globals with
+   * genius, nothing to do.
    */
-  void *              (*set_ad_num)(const unsigned int);
+  void set_ad_num(const unsigned int n)
+  { if(_set_ad_num) _set_ad_num(n); }
 
   /**
    * virtual function for set different model, calibrate parameters to PMI
@@ -128,6 +130,17 @@ public:
 
 protected:
 
+  /**
+   * find exported function of the material, from the loaded library or built-in registry
+   * @return the function address, 0 for not found
+   */
+  void * load_function( const std::string & fun_name ) const;
+
+  /**
+   * function pointer to set_ad_number of material library, 0 for built-in material
+   */
+  void *              (*_set_ad_num)(const unsigned int);
+
   /**
    * const pointer to region
    */
@@ -164,7 +177,7 @@ protected:
   const std::map<std::string, SimulationVariable>  * cell_variables;
 
   /**
-   * pointer to dynamic loaded library file
+   * pointer to dynamic loaded library file, 0 for built-in material
    */
 #ifdef WINDOWS
   HINSTANCE                  dll_file;
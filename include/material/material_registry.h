@@ -0,0 +1,64 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __material_registry_h__
+#define __material_registry_h__
+
+#include <string>
+
+/**
+ * Registry of built-in materials. When genius is configured with --static-material,
+ * the material libraries are linked into genius, and their exported PMI functions
+ * are listed in a table generated by src/material/wscript. Materials not in the
+ * registry (i.e. user PMI plugins) are still loaded as dynamic library.
+ */
+namespace Material
+{
+
+  /**
+   * item of the exported function table
+   */
+  struct BuiltinFunction
+  {
+    /**
+     * exported function name, i.e. PMIS_Si_BandStructure_Default
+     */
+    const char * name;
+
+    /**
+     * function address
+     */
+    void       * address;
+  };
+
+  /**
+   * @return true when the material library (formatted name, i.e. Si) is linked into genius
+   */
+  extern bool is_builtin_material(const std::string & lib_name);
+
+  /**
+   * @return the address of exported function of built-in materials, 0 for not found
+   */
+  extern void * builtin_material_function(const std::string & fun_name);
+
+}
+
+#endif // __material_registry_h__
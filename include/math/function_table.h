@@ -0,0 +1,281 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __function_table_h__
+#define __function_table_h__
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "adolc.h"
+
+
+/**
+ * Tabulated 1D function with guaranteed accuracy.
+ *
+ * The function is sampled on a uniform grid over [x_min, x_max] and evaluated by
+ * piecewise cubic Hermite interpolation. Nodal slopes are the exact derivative when
+ * it is given, or else a 4th order finite difference of the nodal values.
+ *
+ * At build time, the interpolant is compared with the function at the quarter points
+ * of every interval (and the derivative as well, when it is given). The grid is
+ * refined until the relative error is below the tolerance, if it can not be reached
+ * within the max interval number, the table is marked invalid and the caller should
+ * evaluate the function directly. A zero tolerance disables the table.
+ *
+ * The derivative returned by the table is the derivative of the interpolant, so the
+ * Jacobian assembled from it is consistent with the tabulated residual.
+ *
+ * The class is header only, so it can be used by PMI plugins as well. The default
+ * tolerance is set by GLOBAL card and passed to PMI by PMI_Environment.
+ */
+class FunctionTable
+{
+public:
+
+  /**
+   * constructor, an empty (invalid) table
+   */
+  FunctionTable()
+    : _x_min(0.0), _x_max(0.0), _inv_h(0.0), _n(0), _tol(-1.0), _valid(false)
+  {}
+
+  /**
+   * build the table of f on [x_min, x_max], f is a functor (or function) of double.
+   * @return true when the tolerance is reached
+   */
+  template <typename F>
+  bool build(const F & f, double x_min, double x_max, double tol, unsigned int max_intervals=1<<16)
+  {
+    return _build(f, f, false, x_min, x_max, tol, max_intervals);
+  }
+
+  /**
+   * build the table of f on [x_min, x_max] with exact derivative df,
+   * the derivative of the table is checked against df as well.
+   * @return true when the tolerance is reached
+   */
+  template <typename F, typename DF>
+  bool build(const F & f, const DF & df, double x_min, double x_max, double tol, unsigned int max_intervals=1<<16)
+  {
+    return _build(f, df, true, x_min, x_max, tol, max_intervals);
+  }
+
+  /**
+   * @return true when the table reaches its tolerance
+   */
+  bool valid() const
+  { return _valid; }
+
+  /**
+   * @return the tolerance this table is built with, negative for never built
+   */
+  double tolerance() const
+  { return _tol; }
+
+  /**
+   * @return the interval number
+   */
+  unsigned int n_intervals() const
+  { return _n; }
+
+  /**
+   * @return true when x can be evaluated by table
+   */
+  bool in_range(double x) const
+  { return _valid && x >= _x_min && x <= _x_max; }
+
+  /**
+   * @return the tabulated value at x, x should be in range
+   */
+  double value(double x) const
+  {
+    double t;
+    const double * c = _interval(x, t);
+    return c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+  }
+
+  /**
+   * @return the tabulated value at x, together with its derivative
+   */
+  double value(double x, double & dfdx) const
+  {
+    double t;
+    const double * c = _interval(x, t);
+    dfdx = (c[1] + t*(2.0*c[2] + 3.0*t*c[3]))*_inv_h;
+    return c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+  }
+
+  /**
+   * @return the AD version of tabulated value at x
+   */
+  adtl::AutoDScalar value(const adtl::AutoDScalar & x) const
+  {
+    double dfdx;
+    adtl::AutoDScalar y(value(x.getValue(), dfdx));
+    for(unsigned int i=0; i<adtl::AutoDScalar::numdir; ++i)
+      y.setADValue(i, dfdx*x.getADValue(i));
+    return y;
+  }
+
+  /**
+   * writable reference to the default relative error bound of tables
+   */
+  static double & default_tolerance()
+  {
+    static double tol = 1e-9;
+    return tol;
+  }
+
+private:
+
+  /**
+   * range of the table
+   */
+  double _x_min, _x_max;
+
+  /**
+   * inverse of the interval length
+   */
+  double _inv_h;
+
+  /**
+   * interval number
+   */
+  unsigned int _n;
+
+  /**
+   * relative error bound
+   */
+  double _tol;
+
+  /**
+   * the tolerance is reached
+   */
+  bool _valid;
+
+  /**
+   * the cubic polynomial coefficients of each interval in local coordinate t in [0, 1]
+   */
+  std::vector<double> _coeff;
+
+  /**
+   * locate the interval of x
+   * @return the coefficients of the interval, t is the local coordinate
+   */
+  const double * _interval(double x, double & t) const
+  {
+    double s = (x - _x_min)*_inv_h;
+    unsigned int i = std::min(static_cast<unsigned int>(std::max(s, 0.0)), _n-1);
+    t = s - i;
+    return &_coeff[4*i];
+  }
+
+  /**
+   * fill the coefficients from nodal values and slopes, slopes are scaled by interval length
+   */
+  void _fill(const std::vector<double> & f, const std::vector<double> & d)
+  {
+    _coeff.resize(4*_n);
+    for(unsigned int i=0; i<_n; ++i)
+    {
+      double * c = &_coeff[4*i];
+      c[0] = f[i];
+      c[1] = d[i];
+      c[2] = 3.0*(f[i+1]-f[i]) - 2.0*d[i] - d[i+1];
+      c[3] = 2.0*(f[i]-f[i+1]) + d[i] + d[i+1];
+    }
+  }
+
+  template <typename F, typename DF>
+  bool _build(const F & f, const DF & df, bool has_df, double x_min, double x_max, double tol, unsigned int max_intervals)
+  {
+    _x_min = x_min;
+    _x_max = x_max;
+    _tol   = tol;
+    _valid = false;
+    _coeff.clear();
+    if( tol <= 0.0 || !(x_max > x_min) ) return false;
+
+    std::vector<double> fv, dv;
+    for(_n=64; _n<=max_intervals; _n*=2)
+    {
+      const double h = (x_max - x_min)/_n;
+      _inv_h = 1.0/h;
+
+      fv.resize(_n+1);
+      dv.resize(_n+1);
+      for(unsigned int i=0; i<=_n; ++i)
+        fv[i] = f(x_min + i*h);
+
+      if(has_df)
+      {
+        for(unsigned int i=0; i<=_n; ++i)
+          dv[i] = df(x_min + i*h)*h;
+      }
+      else
+      {
+        // 5 point stencils, one side at both ends
+        const unsigned int n = _n;
+        dv[0]   = (-25.0*fv[0] + 48.0*fv[1] - 36.0*fv[2] + 16.0*fv[3] - 3.0*fv[4])/12.0;
+        dv[1]   = ( -3.0*fv[0] - 10.0*fv[1] + 18.0*fv[2] -  6.0*fv[3] +     fv[4])/12.0;
+        for(unsigned int i=2; i+2<=n; ++i)
+          dv[i] = (fv[i-2] - 8.0*fv[i-1] + 8.0*fv[i+1] - fv[i+2])/12.0;
+        dv[n-1] = -( -3.0*fv[n] - 10.0*fv[n-1] + 18.0*fv[n-2] -  6.0*fv[n-3] +     fv[n-4])/12.0;
+        dv[n]   = -(-25.0*fv[n] + 48.0*fv[n-1] - 36.0*fv[n-2] + 16.0*fv[n-3] - 3.0*fv[n-4])/12.0;
+      }
+
+      _fill(fv, dv);
+
+      // check the error at quarter points
+      bool pass = true;
+      for(unsigned int i=0; i<_n && pass; ++i)
+        for(unsigned int q=1; q<4 && pass; ++q)
+        {
+          const double x = x_min + (i + 0.25*q)*h;
+          double dt;
+          const double vt = value(x, dt);
+          const double ve = f(x);
+          if( !(std::abs(vt-ve) <= tol*std::abs(ve)) ) pass = false;
+          if( has_df )
+          {
+            const double de = df(x);
+            if( !(std::abs(dt-de) <= tol*(std::abs(de) + std::abs(ve))) ) pass = false;
+          }
+        }
+
+      if(pass)
+      {
+        _valid = true;
+        return true;
+      }
+    }
+
+    _n = 0;
+    _coeff.clear();
+    return false;
+  }
+
+};
+
+
+#endif // #define __function_table_h__
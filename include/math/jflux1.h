@@ -26,6 +26,8 @@
 
 
 
+#include <vector>
+
 #include "mathfunc.h"
 
 
@@ -164,12 +166,106 @@ inline PetscScalar dVIp_dd(PetscScalar Vt,PetscScalar dVv,PetscScalar p1,PetscSc
 
 inline AutoDScalar In_dd(PetscScalar Vt,const AutoDScalar &dVc,const AutoDScalar &n1,const AutoDScalar &n2, PetscScalar h)
 {
-  return Vt*(n2*bern(-dVc/Vt)-n1*bern(dVc/Vt))/h;
+  // closed form partial derivatives w.r.t. dVc, n1 and n2
+  const PetscScalar u  = dVc.getValue()/Vt;
+  const PetscScalar Bp = bern(u);
+  const PetscScalar Bm = bern(-u);
+  const PetscScalar dJ_dV  = (-n2.getValue()*pd1bern(-u)-n1.getValue()*pd1bern(u))/h;
+  const PetscScalar dJ_dn1 = -Vt*Bp/h;
+  const PetscScalar dJ_dn2 =  Vt*Bm/h;
+
+  AutoDScalar J = Vt*(n2.getValue()*Bm-n1.getValue()*Bp)/h;
+  for(unsigned int i=0; i<AutoDScalar::numdir; ++i)
+    J.setADValue(i, dJ_dV*dVc.getADValue(i) + dJ_dn1*n1.getADValue(i) + dJ_dn2*n2.getADValue(i));
+  return J;
 }
 
 inline AutoDScalar Ip_dd(PetscScalar Vt,const AutoDScalar &dVv,const AutoDScalar &p1,const AutoDScalar &p2, PetscScalar h)
 {
-  return Vt*(p1*bern(-dVv/Vt)-p2*bern(dVv/Vt))/h;
+  // closed form partial derivatives w.r.t. dVv, p1 and p2
+  const PetscScalar u  = dVv.getValue()/Vt;
+  const PetscScalar Bp = bern(u);
+  const PetscScalar Bm = bern(-u);
+  const PetscScalar dJ_dV  = (-p1.getValue()*pd1bern(-u)-p2.getValue()*pd1bern(u))/h;
+  const PetscScalar dJ_dp1 =  Vt*Bm/h;
+  const PetscScalar dJ_dp2 = -Vt*Bp/h;
+
+  AutoDScalar J = Vt*(p1.getValue()*Bm-p2.getValue()*Bp)/h;
+  for(unsigned int i=0; i<AutoDScalar::numdir; ++i)
+    J.setADValue(i, dJ_dV*dVv.getADValue(i) + dJ_dp1*p1.getADValue(i) + dJ_dp2*p2.getADValue(i));
+  return J;
+}
+
+
+//-----------------------------------------------------------------------------
+// edge batched S-G current, the edges are given by contiguous arrays.
+// the partial derivatives w.r.t. the driving potential difference and the
+// carrier densities at both ends are returned, the caller applies chain rule.
+
+/**
+ * S-G electron current of n edges, J = Vt*(n2*B(-dVc/Vt)-n1*B(dVc/Vt))/h.
+ * the derivative arrays can be NULL when only the current is required
+ */
+inline void In_dd_batch(unsigned int n, PetscScalar Vt, const PetscScalar *dVc, const PetscScalar *n1, const PetscScalar *n2, const PetscScalar *h,
+                        PetscScalar *J, PetscScalar *dJ_dV=0, PetscScalar *dJ_dn1=0, PetscScalar *dJ_dn2=0)
+{
+  if(!n) return;
+  std::vector<PetscScalar> u(2*n), B(2*n), dB(2*n);
+  for(unsigned int i=0; i<n; ++i)
+  {
+    u[i]   =  dVc[i]/Vt;
+    u[n+i] = -dVc[i]/Vt;
+  }
+  bern_batch(2*n, &u[0], &B[0], &dB[0]);
+
+  const PetscScalar * Bp = &B[0];
+  const PetscScalar * Bm = &B[n];
+  for(unsigned int i=0; i<n; ++i)
+    J[i] = Vt*(n2[i]*Bm[i]-n1[i]*Bp[i])/h[i];
+
+  if(!dJ_dV) return;
+
+  const PetscScalar * dBp = &dB[0];
+  const PetscScalar * dBm = &dB[n];
+  for(unsigned int i=0; i<n; ++i)
+  {
+    dJ_dV[i]  = (-n2[i]*dBm[i]-n1[i]*dBp[i])/h[i];
+    dJ_dn1[i] = -Vt*Bp[i]/h[i];
+    dJ_dn2[i] =  Vt*Bm[i]/h[i];
+  }
+}
+
+/**
+ * S-G hole current of n edges, J = Vt*(p1*B(-dVv/Vt)-p2*B(dVv/Vt))/h.
+ * the derivative arrays can be NULL when only the current is required
+ */
+inline void Ip_dd_batch(unsigned int n, PetscScalar Vt, const PetscScalar *dVv, const PetscScalar *p1, const PetscScalar *p2, const PetscScalar *h,
+                        PetscScalar *J, PetscScalar *dJ_dV=0, PetscScalar *dJ_dp1=0, PetscScalar *dJ_dp2=0)
+{
+  if(!n) return;
+  std::vector<PetscScalar> u(2*n), B(2*n), dB(2*n);
+  for(unsigned int i=0; i<n; ++i)
+  {
+    u[i]   =  dVv[i]/Vt;
+    u[n+i] = -dVv[i]/Vt;
+  }
+  bern_batch(2*n, &u[0], &B[0], &dB[0]);
+
+  const PetscScalar * Bp = &B[0];
+  const PetscScalar * Bm = &B[n];
+  for(unsigned int i=0; i<n; ++i)
+    J[i] = Vt*(p1[i]*Bm[i]-p2[i]*Bp[i])/h[i];
+
+  if(!dJ_dV) return;
+
+  const PetscScalar * dBp = &dB[0];
+  const PetscScalar * dBm = &dB[n];
+  for(unsigned int i=0; i<n; ++i)
+  {
+    dJ_dV[i]  = (-p1[i]*dBm[i]-p2[i]*dBp[i])/h[i];
+    dJ_dp1[i] =  Vt*Bm[i]/h[i];
+    dJ_dp2[i] = -Vt*Bp[i]/h[i];
+  }
 }
 
 
@@ -1,6 +1,8 @@
 #ifndef __mathfunc_h__
 #define __mathfunc_h__
 
+#include <cmath>
+#include <algorithm>
 
 #include "brkpnts.h"
 
@@ -13,6 +15,7 @@
 #endif
 
 #include "adolc.h"
+#include "function_table.h"
 using namespace adtl;
 
 /* define the constant */
@@ -143,6 +146,37 @@ inline double pd1bern ( double x )
 } /* pd1bern */
 
 
+/* ----------------------------------------------------------------------------
+ * bern_batch:  This function returns the Bernoulli function and its derivative
+ * for an array of arguments. It is branch free for vectorization: the series
+ * is blended in near zero, and the argument of exp is clamped to avoid overflow.
+ *
+ *                   x                 B(x)
+ *         B(x) = -------,   B'(x) = ------ (1 - B(x) - x)
+ *                e^x - 1               x
+ */
+inline void bern_batch ( unsigned int n, const double *x, double *B, double *dB )
+{
+  for(unsigned int i=0; i<n; ++i)
+  {
+    const double xi = x[i];
+    const bool   small = std::abs(xi) < 1e-2;
+    // a safe argument, the result is dropped when small
+    const double xs = small ? 1.0 : xi;
+    const double xx = xi*xi;
+
+    const double b_series  = 1.0 - xi/2.0 + xx/12.0 - xx*xx/720.0 + xx*xx*xx/30240.0;
+    const double db_series = -0.5 + xi/6.0 - xx*xi/180.0 + xx*xx*xi/5040.0;
+
+    const double b  = xs / (exp(std::min(xs, 700.0)) - 1.0);
+    const double db = b/xs * (1.0 - b - xs);
+
+    B[i]  = small ? b_series  : b;
+    dB[i] = small ? db_series : db;
+  }
+} /* bern_batch */
+
+
 /* ----------------------------------------------------------------------------
  * aux1:  This function returns the aux1 function.  To avoid under and over-
  * flows this function is defined by equivalent or approximate functions
@@ -282,9 +316,10 @@ inline double pd1erf ( double x )
 
 
 /* ----------------------------------------------------------------------------
- * fermi_half:  This function returns value of 1/2 order Fermi-Dirac Integral
+ * fermi_half_formula:  This function returns value of 1/2 order Fermi-Dirac Integral
+ * by direct evaluation
  */
-inline double fermi_half(double x)
+inline double fermi_half_formula(double x)
 {
 #ifdef HAVE_GSL
   return double(gsl_sf_fermi_dirac_half(double(x)));
@@ -311,39 +346,73 @@ inline double fermi_half(double x)
 }
 
 
-inline AutoDScalar fermi_half(const AutoDScalar &x)
+/* ----------------------------------------------------------------------------
+ * pd1fermi_half_formula:  This function returns the derivative of fermi_half_formula
+ */
+inline double pd1fermi_half_formula(double x)
 {
 #ifdef HAVE_GSL
-  genius_error();
+  return double(gsl_sf_fermi_dirac_mhalf(double(x)));
 #else
-  /* use an analytic expression. The result achieves within 0.4% error in all ranges.*/
   if(x<-4.5)
-  {
-    //for small arguments, fhfp and exp are almost identical.
-    return 1.0/exp(-x);
-  }
-  else if(x<0.0)
-  {
-    AutoDScalar v = adtl::pow(x,4) + 50 + 33.6*x*(1-0.68*exp(-0.17*(x+1)*(x+1)));
-    AutoDScalar p = 1.329340388179*adtl::pow(v,double(-0.375));
-    return 1.0/(exp(-x) + p);
-  }
-  else
-  {
-    AutoDScalar v = adtl::pow(x,4) + 50 + 33.6*x*(1-0.68*exp(-0.17*(x+1)*(x+1)));
-    AutoDScalar p = 1.329340388179*adtl::pow(v,double(-0.375));
-    return 1.0/(1.0/exp(x) + p);
-  }
+    return exp(x);
+
+  double g  = exp(-0.17*(x+1)*(x+1));
+  double v  = std::pow(x,4) + 50 + 33.6*x*(1-0.68*g);
+  double dv = 4*x*x*x + 33.6*(1-0.68*g) + 33.6*x*0.68*0.34*(x+1)*g;
+  double p  = 1.329340388179*std::pow(v,double(-0.375));
+  double dp = -0.375*p*dv/v;
+  double f  = 1.0/(exp(-x) + p);
+  return f*f*(exp(-x) - dp);
 #endif
 }
 
 
+/* ----------------------------------------------------------------------------
+ * fermi_half_table:  table of fermi_half_formula, it is (re)built when the
+ * default tolerance of FunctionTable changes
+ */
+inline const FunctionTable & fermi_half_table()
+{
+  static FunctionTable table;
+  if(table.tolerance() != FunctionTable::default_tolerance())
+    table.build(fermi_half_formula, pd1fermi_half_formula, -4.5, 50.0, FunctionTable::default_tolerance());
+  return table;
+}
+
+
+/* ----------------------------------------------------------------------------
+ * fermi_half:  This function returns value of 1/2 order Fermi-Dirac Integral
+ */
+inline double fermi_half(double x)
+{
+  const FunctionTable & table = fermi_half_table();
+  if(table.in_range(x))
+    return table.value(x);
+  return fermi_half_formula(x);
+}
+
+
+inline AutoDScalar fermi_half(const AutoDScalar &x)
+{
+  const FunctionTable & table = fermi_half_table();
+  if(table.in_range(x.getValue()))
+    return table.value(x);
+
+  AutoDScalar y(fermi_half_formula(x.getValue()));
+  double d = pd1fermi_half_formula(x.getValue());
+  for (unsigned int i=0; i<AutoDScalar::numdir; ++i)
+    y.setADValue(i, d*x.getADValue(i));
+  return y;
+}
+
+
 /*-----------------------------------------------------------------------
  *
  *     fhfm evaluates the fermi-dirac integral of minus one-half order
  *     f-1/2(x) from x
  */
-inline double fermi_mhalf(double x)
+inline double fermi_mhalf_formula(double x)
 {
 #ifdef HAVE_GSL
   return double(gsl_sf_fermi_dirac_mhalf(double(x)));
@@ -366,7 +435,7 @@ inline double fermi_mhalf(double x)
   {
     if(x<5.5)
     {
-      double f=fermi_half(x);
+      double f=fermi_half_formula(x);
       return f/(1.0+f*(a+f*(-2.0*b+f*(3*c-4*d*f))));
     }
     else
@@ -376,6 +445,34 @@ inline double fermi_mhalf(double x)
 }
 
 
+/* ----------------------------------------------------------------------------
+ * fermi_mhalf_table:  table of fermi_mhalf_formula, without GSL the table
+ * stops before the branch at 5.5
+ */
+inline const FunctionTable & fermi_mhalf_table()
+{
+  static FunctionTable table;
+  if(table.tolerance() != FunctionTable::default_tolerance())
+  {
+#ifdef HAVE_GSL
+    table.build(fermi_mhalf_formula, -4.5, 50.0, FunctionTable::default_tolerance());
+#else
+    table.build(fermi_mhalf_formula, -4.5, 5.0, FunctionTable::default_tolerance());
+#endif
+  }
+  return table;
+}
+
+
+inline double fermi_mhalf(double x)
+{
+  const FunctionTable & table = fermi_mhalf_table();
+  if(table.in_range(x))
+    return table.value(x);
+  return fermi_mhalf_formula(x);
+}
+
+
 /* ----------------------------------------------------------------------------
  * fermi_half:  AD version of fermi_half
  */
@@ -434,24 +531,72 @@ inline double inv_fermi_half(double x)
 /*-----------------------------------------------------------------------
  *   GAMMA calculates f1/2(eta)/exp(eta) according to the approximate
  *   formula in casey's book,dummy arguement x=f1/2(eta).
+ *   gamma_f_low and gamma_f_high are the two branches of it, with their
+ *   derivatives, for 0<x<=10 and x>10 respectively.
  */
+inline double gamma_f_low(double x)
+{
+  const double a=3.53553e-1,b=4.95009e-3,c=1.48386e-4,d=4.42563e-6;
+  double temx=x*(a+x*(-b+x*(c-x*d)));
+  return 1.0/exp(temx);
+}
+
+inline double pd1gamma_f_low(double x)
+{
+  const double a=3.53553e-1,b=4.95009e-3,c=1.48386e-4,d=4.42563e-6;
+  double temx=x*(a+x*(-b+x*(c-x*d)));
+  double dtemx=a+x*(-2.0*b+x*(3.0*c-4.0*x*d));
+  return -dtemx/exp(temx);
+}
+
+inline double gamma_f_high(double x)
+{
+  const double pi1=1.772453851e0,pi2=9.869604401e0;
+  double temx=sqrt(std::pow(7.5e-1*pi1*x,double(4.e0/3.e0))-pi2/6.e0);
+  return x/exp(temx);
+}
+
+inline double pd1gamma_f_high(double x)
+{
+  const double pi1=1.772453851e0,pi2=9.869604401e0;
+  double u=std::pow(7.5e-1*pi1*x,double(4.e0/3.e0));
+  double temx=sqrt(u-pi2/6.e0);
+  return (1.0-2.0/3.0*u/temx)/exp(temx);
+}
+
+
+/* ----------------------------------------------------------------------------
+ * gamma_f_table:  tables of gamma_f_low on [0, 10] and gamma_f_high on [10, MaximumExponent]
+ */
+inline const FunctionTable & gamma_f_table(bool high)
+{
+  static FunctionTable low_table, high_table;
+  if(low_table.tolerance() != FunctionTable::default_tolerance())
+  {
+    low_table.build(gamma_f_low, pd1gamma_f_low, 0.0, 1.0e1, FunctionTable::default_tolerance());
+    high_table.build(gamma_f_high, pd1gamma_f_high, 1.0e1, MaximumExponent, FunctionTable::default_tolerance());
+  }
+  return high ? high_table : low_table;
+}
+
+
 inline  double gamma_f(double x)
 {
-  const double a=3.53553e-1,b=4.95009e-3,c=1.48386e-4;
-  const double d=4.42563e-6,pi1=1.772453851e0,pi2=9.869604401e0;
-  double temx;
   if(x>1.0e1)
   {
-    temx=sqrt(std::pow(7.5e-1*pi1*x,double(4.e0/3.e0))-pi2/6.e0);
     if(x > MaximumExponent)
       return VerySmallNumericValue;
-    else
-      return x/exp(temx);
+    const FunctionTable & table = gamma_f_table(true);
+    if(table.valid())
+      return table.value(x);
+    return gamma_f_high(x);
   }
   else if(x>0.0)
   {
-    temx=x*(a+x*(-b+x*(c-x*d)));
-    return 1.0/exp(temx);
+    const FunctionTable & table = gamma_f_table(false);
+    if(table.valid())
+      return table.value(x);
+    return gamma_f_low(x);
   }
   else
     return 1.0;
@@ -465,14 +610,19 @@ inline  AutoDScalar gamma_f(const AutoDScalar &x)
   AutoDScalar temx;
   if(x>1.0e1)
   {
-    temx=sqrt(adtl::pow(7.5e-1*pi1*x,double(4.e0/3.e0))-pi2/6.e0);
     if(x > MaximumExponent)
       return VerySmallNumericValue;
-    else
-      return x/exp(temx);
+    const FunctionTable & table = gamma_f_table(true);
+    if(table.valid())
+      return table.value(x);
+    temx=sqrt(adtl::pow(7.5e-1*pi1*x,double(4.e0/3.e0))-pi2/6.e0);
+    return x/exp(temx);
   }
   else if(x>0.0)
   {
+    const FunctionTable & table = gamma_f_table(false);
+    if(table.valid())
+      return table.value(x);
     temx=x*(a+x*(-b+x*(c-x*d)));
     return 1.0/exp(temx);
   }
@@ -481,4 +631,3 @@ inline  AutoDScalar gamma_f(const AutoDScalar &x)
 }
 
 #endif
-
@@ -77,8 +77,49 @@ public:
    */
   virtual void write (const std::string& );
 
+  /**
+   * when set, processor 0 hands the collected data to the
+   * background AsyncWriter instead of writing it at once
+   */
+  void set_background(bool background)
+  { _background = background; }
+
+  /**
+   * write as one step of a time series file, the last value is the time (swept bias for DC sweep) of current step.
+   * step 0 creates the file, later steps only append solution fields and electrode data
+   */
+  void set_time_series(const std::vector<double> & time_values)
+  { _time_values = time_values; }
+
+  /**
+   * the step to be read from a time series file, -1 for the last one
+   */
+  void set_time_step(int step)
+  { _time_step = step; }
+
 
 private:
+
+  /**
+   * write file in background
+   */
+  bool _background;
+
+  /**
+   * time value of each step for time series file
+   */
+  std::vector<double> _time_values;
+
+  /**
+   * the step to be read from time series file
+   */
+  int _time_step;
+
+  /**
+   * the rank 0 part of cgns export, which holds all the data to be written
+   */
+  class WriteJob;
+
 // some id for cgns file read/write
 
   /**
@@ -161,6 +202,22 @@ private:
    */
   std::map< short int, double > electrode_iapp;
 
+  /**
+   * name of solution node at given step of time series, "Solution" for step 0, "Solution_k" for step k
+   */
+  static std::string solution_name(const std::string & sol, int step);
+
+  /**
+   * split solution node name into solution and step, return the step
+   */
+  static int solution_step(const std::string & name, std::string & sol);
+
+  /**
+   * send the solution values of each node to the processors which hold it,
+   * instead of broadcast the whole solution arrays
+   */
+  void _distribute_solution();
+
   /**
    * aux function to sort x by increase order of id
    */
@@ -175,7 +232,7 @@ private:
 inline
 CGNSIO::CGNSIO (SimulationSystem& system) :
 	FieldInput<SimulationSystem> (system),
-	FieldOutput<SimulationSystem> (system)
+	FieldOutput<SimulationSystem> (system), _background(false), _time_step(-1)
 {
 
 }
@@ -184,7 +241,7 @@ CGNSIO::CGNSIO (SimulationSystem& system) :
 
 inline
 CGNSIO::CGNSIO (const SimulationSystem& system) :
-	FieldOutput<SimulationSystem>(system)
+	FieldOutput<SimulationSystem>(system), _background(false), _time_step(-1)
 {
 
 }
@@ -316,6 +316,84 @@ public:
   { return _tensor_block[v][offset]; }
 
 
+  /**
+   * @return the number of Real components of one item of given data type
+   */
+  static unsigned int n_components(DataType type)
+  {
+    switch(type)
+    {
+      case SCALAR  : return 1;
+      case COMPLEX : return 2;
+      case VECTOR  : return DIM;
+      case TENSOR  : return DIM*DIM;
+      default      : return 0;
+    }
+  }
+
+  /**
+   * @return true when memory of variable v is allocated
+   */
+  bool allocated(DataType type, const unsigned int v) const
+  {
+    switch(type)
+    {
+      case SCALAR  : return v < _scalar_fill.size()  && _scalar_fill[v];
+      case COMPLEX : return v < _complex_fill.size() && _complex_fill[v];
+      case VECTOR  : return v < _vector_fill.size()  && _vector_fill[v];
+      case TENSOR  : return v < _tensor_fill.size()  && _tensor_fill[v];
+      default      : return false;
+    }
+  }
+
+  /**
+   * raw access to the data block of variable v, which can be used for bulk i/o.
+   * only scalar and complex blocks are plain Real arrays, each item takes
+   * n_components(type) Reals.
+   * @return NULL for vector/tensor variable or variable without memory
+   */
+  const Real * raw_block(DataType type, const unsigned int v) const
+  {
+    if( _size == 0 || !allocated(type, v) ) return NULL;
+    switch(type)
+    {
+      case SCALAR  : return &_scalar_block[v][0];
+      case COMPLEX : return reinterpret_cast<const Real *>(&_complex_block[v][0]);
+      default      : return NULL;
+    }
+  }
+
+  /**
+   * copy n_components(type) Reals of item offset of variable v to buf
+   */
+  void get_components(DataType type, const unsigned int v, const unsigned int offset, Real * buf) const
+  {
+    switch(type)
+    {
+      case SCALAR  : buf[0] = _scalar_block[v][offset]; break;
+      case COMPLEX : buf[0] = _complex_block[v][offset].real(); buf[1] = _complex_block[v][offset].imag(); break;
+      case VECTOR  : for(unsigned int i=0; i<DIM; ++i) buf[i] = _vector_block[v][offset](i); break;
+      case TENSOR  : for(unsigned int i=0; i<DIM; ++i) for(unsigned int j=0; j<DIM; ++j) buf[i*DIM+j] = _tensor_block[v][offset](i,j); break;
+      default      : break;
+    }
+  }
+
+  /**
+   * set item offset of variable v by n_components(type) Reals in buf
+   */
+  void set_components(DataType type, const unsigned int v, const unsigned int offset, const Real * buf)
+  {
+    switch(type)
+    {
+      case SCALAR  : _scalar_block[v][offset] = buf[0]; break;
+      case COMPLEX : _complex_block[v][offset] = std::complex<Real>(buf[0], buf[1]); break;
+      case VECTOR  : for(unsigned int i=0; i<DIM; ++i) _vector_block[v][offset](i) = buf[i]; break;
+      case TENSOR  : for(unsigned int i=0; i<DIM; ++i) for(unsigned int j=0; j<DIM; ++j) _tensor_block[v][offset](i,j) = buf[i*DIM+j]; break;
+      default      : break;
+    }
+  }
+
+
   /**
    * universal data access function via template
    */
@@ -106,8 +106,18 @@ private:
   // hold the boundary elems here
   std::vector<std::pair<Elem *, int> > _boundary_elem_regions;
 
+  // only valid on processor 0
   std::map<unsigned int, unsigned int> _node_id_to_dfise_node_index_map;
 
+  // which doping dataset is valid in each region
+  std::vector<int> _doping_flags;
+
+  // doping values of the local semiconductor nodes, received from processor 0
+  std::vector<double> _local_doping;
+
+  // processor 0 sends the doping values to the owner of each node instead of broadcast all the datasets
+  void _distribute_doping();
+
   void _set_region();
 
 
@@ -26,8 +26,9 @@
 #define __external_circuit_h__
 
 #include <complex>
+#include <vector>
 
-
+#include "genius_common.h"
 #include "solver_specify.h"
 
 /**
@@ -290,6 +291,44 @@ public:
   }
 
 
+  /**
+   * pack the time dependent state of the circuit, for checkpoint
+   */
+  void pack_state(std::vector<PetscScalar> & state) const
+  {
+    state.clear();
+    state.push_back(_Vapp);
+    state.push_back(_Iapp);
+    state.push_back(_potential);
+    state.push_back(_potential_itering);
+    state.push_back(_potential_old);
+    state.push_back(_current);
+    state.push_back(_current_itering);
+    state.push_back(_current_old);
+    state.push_back(_cap_current);
+    state.push_back(_cap_current_old);
+    state.push_back(static_cast<PetscScalar>(_drv));
+  }
+
+  /**
+   * restore the state packed by pack_state
+   */
+  void unpack_state(const std::vector<PetscScalar> & state)
+  {
+    genius_assert(state.size() == 11);
+    _Vapp              = state[0];
+    _Iapp              = state[1];
+    _potential         = state[2];
+    _potential_itering = state[3];
+    _potential_old     = state[4];
+    _current           = state[5];
+    _current_itering   = state[6];
+    _current_old       = state[7];
+    _cap_current       = state[8];
+    _cap_current_old   = state[9];
+    _drv               = static_cast<DRIVEN>(static_cast<int>(state[10]));
+  }
+
   /**
    * roll back to previous solution
    */
@@ -0,0 +1,211 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __gsol_io_h__
+#define __gsol_io_h__
+
+// C++ includes
+#include <string>
+#include <vector>
+#include <map>
+
+// Local includes
+#include "genius_common.h"
+#include "field_input.h"
+#include "field_output.h"
+#include "simulation_system.h"
+
+
+
+/**
+ * This class implements reading and writing node based solution data in the
+ * native GSOL binary format. Only solution is stored, the mesh must be loaded
+ * (i.e. from cgns file) before reading.
+ *
+ * Every processor writes its own piece without communication: processor 0 writes
+ * to the given file name, processor p to "<name>.p". Columns are dumped from the
+ * region DataStorage blocks, and mapped back by global node id at reading. So the
+ * file can be loaded by different processor number.
+ *
+ * File layout, native byte order which is checked by a marker:
+ *   header : "GSOL", version, byte order marker, n_pieces, piece, time, n_regions
+ *   region : name, n_rows, n_columns, node id column, n_columns data columns
+ *   column : name, unit, data type, n_components, value size, keep bits,
+ *            chunk rows, n_chunks, chunks
+ *   chunk  : raw size, stored size, payload (deflated when stored size < raw size)
+ *   states : n_states, (name, size, values) for each state, after all the regions
+ *
+ * Values are stored in internal unit. When a precision (relative error bound) is
+ * given, the low mantissa bits of each double are rounded off, which bounds the
+ * relative error and makes the columns highly compressible.
+ *
+ * In checkpoint mode, the pieces also hold the ghost nodes, the solver clock/time
+ * steps, the electrode circuits and the spice circuit state. A checkpoint can only
+ * be restored by the same processor number, each processor reads its own piece
+ * and copies the columns back by offset, no system rebuild is required.
+ */
+
+// ------------------------------------------------------------
+// GSOLIO class definition
+class GSOLIO : public FieldInput<SimulationSystem>,
+               public FieldOutput<SimulationSystem>
+{
+public:
+  /**
+   * Constructor.  Takes a writeable reference to a system object.
+   * This is the constructor required to read solution.
+   */
+  GSOLIO (SimulationSystem& system);
+
+  /**
+   * Constructor.  Takes a read-only reference to a system object.
+   * This is the constructor required to write solution.
+   */
+  GSOLIO (const SimulationSystem& system);
+
+  /**
+   * read solution from the pieces of GSOL file
+   */
+  virtual void read (const std::string& );
+
+  /**
+   * write the solution of this processor to its piece
+   */
+  virtual void write (const std::string& );
+
+  /**
+   * when set, the piece is written by the AsyncWriter I/O thread
+   */
+  void set_background(bool background)
+  { _background = background; }
+
+  /**
+   * relative error bound of stored values, 0 for lossless
+   */
+  void set_precision(double precision)
+  { _precision = precision; }
+
+  /**
+   * deflate the chunks, only takes effect when zlib is available
+   */
+  void set_compress(bool compress)
+  { _compress = compress; }
+
+  /**
+   * rows per chunk
+   */
+  void set_chunk_size(unsigned int rows)
+  { _chunk_rows = rows; }
+
+  /**
+   * time (or sweep value) recorded in file header
+   */
+  void set_time(double time)
+  { _time = time; }
+
+  /**
+   * write/read checkpoint
+   */
+  void set_checkpoint(bool checkpoint)
+  { _checkpoint = checkpoint; }
+
+  /**
+   * @return the file name of piece p
+   */
+  static std::string piece_name(const std::string & name, unsigned int p);
+
+private:
+
+  /**
+   * write file in background
+   */
+  bool _background;
+
+  /**
+   * relative error bound
+   */
+  double _precision;
+
+  /**
+   * deflate chunks
+   */
+  bool _compress;
+
+  /**
+   * rows per chunk
+   */
+  unsigned int _chunk_rows;
+
+  /**
+   * time value
+   */
+  double _time;
+
+  /**
+   * checkpoint mode
+   */
+  bool _checkpoint;
+
+  /**
+   * the serialization part of gsol export
+   */
+  class WriteJob;
+
+  /**
+   * read one piece file, the states recorded in file are returned
+   */
+  void _read_piece(const std::string & name, unsigned int & n_pieces, std::map<std::string, std::vector<double> > & states);
+
+  /**
+   * collect solver and circuit state for checkpoint
+   */
+  void _pack_states(std::map<std::string, std::vector<double> > & states) const;
+
+  /**
+   * restore solver and circuit state from checkpoint
+   */
+  void _unpack_states(const std::map<std::string, std::vector<double> > & states);
+
+};
+
+
+
+// ------------------------------------------------------------
+// GSOLIO inline members
+inline
+GSOLIO::GSOLIO (SimulationSystem& system) :
+    FieldInput<SimulationSystem> (system),
+    FieldOutput<SimulationSystem> (system),
+    _background(false), _precision(0.0), _compress(true), _chunk_rows(65536), _time(0.0), _checkpoint(false)
+{}
+
+
+
+inline
+GSOLIO::GSOLIO (const SimulationSystem& system) :
+    FieldOutput<SimulationSystem>(system),
+    _background(false), _precision(0.0), _compress(true), _chunk_rows(65536), _time(0.0), _checkpoint(false)
+{}
+
+
+
+#endif // #define __gsol_io_h__
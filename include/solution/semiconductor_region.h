@@ -260,6 +260,12 @@ public:
    */
   bool check_fvm_cell() const;
 
+  /**
+   * allocate the per-node constant coefficients of PMIs in node data storage and compute them,
+   * call this function after doping profile done and after PMI calibration
+   */
+  void prepare_pmi_coefficients();
+
 private:
 
   /**
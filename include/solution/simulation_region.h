@@ -566,6 +566,18 @@ public:
   const std::map<std::string, SimulationVariable> & region_cell_variables() const
   { return _region_cell_variables; }
 
+  /**
+   * @return the data block of node based variables, for bulk i/o
+   */
+  const DataStorage & node_data_storage() const
+  { return _node_data_storage; }
+
+  /**
+   * @return the data block of node based variables, for bulk i/o
+   */
+  DataStorage & node_data_storage()
+  { return _node_data_storage; }
+
   /**
    * sync point variable with ghost node
    * @return true for success
@@ -131,13 +131,24 @@ public:
   /**
    * @brief the main saving / loading mechanism, from cgnsfile
    */
-  void import_cgns(const std::string& filename);
+  void import_cgns(const std::string& filename, int step=-1);
 
   /**
    * @brief load system from xml vtk file, only for debug reason
    */
   void import_vtk(const std::string& filename);
 
+  /**
+   * @brief load node based solution from GSOL binary file, the mesh should already exist
+   */
+  void import_gsol(const std::string& filename);
+
+  /**
+   * @brief restore the full solver state from checkpoint, with the same processor number.
+   * the system must already be built by the same mesh and partition
+   */
+  void import_checkpoint(const std::string& filename);
+
   /**
    * @brief load device information from Silvaco file, which is used by Silvaco ATLAS and other tools.
    */
@@ -158,11 +169,31 @@ public:
    */
   void import_ise(const std::string& filename);
 
+  /**
+   * @brief load the imported structure (mesh, region, boundary and doping) from its cache.
+   * @return false when the cache does not exist, the system is not changed then
+   */
+  bool import_structure_cache(const std::string& cache_file);
 
   /**
-   * @brief save complete system information to cgns file, which can be loaded again
+   * @brief save the imported structure to cache, for the later runs with the same source.
+   * the file is written under a temporary name and renamed, concurrent runs never see a partial cache
    */
-  void export_cgns(const std::string& filename) const;
+  void export_structure_cache(const std::string& cache_file) const;
+
+
+  /**
+   * @brief save complete system information to cgns file, which can be loaded again.
+   * when background is true, the file is written by the AsyncWriter I/O thread
+   */
+  void export_cgns(const std::string& filename, bool background=false) const;
+
+  /**
+   * @brief append a snapshot to a time series cgns file. the first snapshot creates the file
+   * with mesh and all the data, later ones only add solution fields and update the iterative data.
+   * time_values holds the time (or sweep value) of every snapshot, the last one is the current
+   */
+  void export_cgns_series(const std::string& filename, const std::vector<double> & time_values, bool background=false) const;
 
   /**
    * @brief save mesh and doping to df-ise file
@@ -170,9 +201,24 @@ public:
   void export_ise(const std::string& filename) const;
 
   /**
-   * @brief export solution to vtk file
+   * @brief export solution to vtk file.
+   * when background is true, the XML vtk file is written by the AsyncWriter I/O thread
+   */
+  void export_vtk(const std::string& filename, bool ascii, bool background=false) const;
+
+  /**
+   * @brief save node based solution to GSOL binary file, one piece per processor.
+   * precision is the relative error bound of stored values, 0 for lossless.
+   * time is recorded in the file header
+   */
+  void export_gsol(const std::string& filename, double precision=0.0, bool compress=true,
+                   double time=0.0, bool background=false) const;
+
+  /**
+   * @brief save the full solver state (node data include ghost nodes, time step history,
+   * electrode and spice circuit) for restart. each processor writes its own piece
    */
-  void export_vtk(const std::string& filename, bool ascii) const;
+  void export_checkpoint(const std::string& filename, bool background=false) const;
 
   /**
    * @brief write geometry and material info to gdml file
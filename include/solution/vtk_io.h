@@ -81,8 +81,56 @@ public:
    */
   virtual void write (const std::string& );
 
+  /**
+   * when set, processor 0 hands the assembled vtkUnstructuredGrid to the
+   * background AsyncWriter instead of writing it at once
+   */
+  void set_background(bool background)
+  { _background = background; }
+
 private:
 
+  /**
+   * write file in background
+   */
+  bool _background;
+
+  /**
+   * each processor writes its own piece instead of gathering everything to processor 0
+   */
+  bool _parallel;
+
+  /**
+   * gather data to processor 0, do nothing in parallel mode
+   */
+  template <typename T>
+  void _gather(std::vector<T> & data) const;
+
+  /**
+   * @return true if this processor builds a vtk grid
+   */
+  bool _is_writer() const;
+
+  /**
+   * map node id to point index of local piece
+   */
+  std::map<unsigned int, unsigned int> _piece_nodes;
+
+  /**
+   * map elem id to cell index of local piece
+   */
+  std::map<unsigned int, unsigned int> _piece_cells;
+
+  /**
+   * map boundary (elem id, side) to cell index of local piece
+   */
+  std::map<std::pair<unsigned int, unsigned short int>, unsigned int> _piece_boundary_cells;
+
+  /**
+   * @return the file name of piece p for a pvtu file
+   */
+  static std::string piece_name(const std::string & name, unsigned int p);
+
   // boundary info
   std::vector<unsigned int>       _el;
   std::vector<unsigned short int> _sl;
@@ -114,6 +162,17 @@ private:
    */
   void meshinfo_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid);
 
+  /**
+   * write local elements, their nodes and boundary sides of this processor
+   * together with region and partition information into a vtkUnstructuredGrid
+   */
+  void piece_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid);
+
+  /**
+   * the pvtu index file, which lists data arrays and all the pieces
+   */
+  std::string export_pvtu_index(const std::string & name, vtkUnstructuredGrid* grid);
+
   /**
    * write mesh relative solution data to vtk file
    */
@@ -163,6 +222,8 @@ private:
   vtkUnstructuredGrid* _vtk_grid;
 
   class XMLUnstructuredGridWriter;
+
+  class WriteJob;
 #endif
 
   /**
@@ -239,7 +300,7 @@ private:
 inline
 VTKIO::VTKIO (SimulationSystem& system) :
     FieldInput<SimulationSystem> (system),
-    FieldOutput<SimulationSystem> (system)
+    FieldOutput<SimulationSystem> (system), _background(false), _parallel(false)
 {
 #ifdef HAVE_VTK
   _vtk_grid = NULL;
@@ -250,7 +311,7 @@ VTKIO::VTKIO (SimulationSystem& system) :
 
 inline
 VTKIO::VTKIO (const SimulationSystem& system) :
-    FieldOutput<SimulationSystem>(system)
+    FieldOutput<SimulationSystem>(system), _background(false), _parallel(false)
 {
 #ifdef HAVE_VTK
   _vtk_grid = NULL;
@@ -308,6 +308,39 @@ protected:
    */
   PetscInt nonlinear_iteration;
 
+  /**
+   * relative tolerance of the linear solver for next newton step,
+   * updated by Eisenstat-Walker method when SolverSpecify::ksp_ew is set
+   */
+  PetscReal ksp_forcing;
+
+  /**
+   * the scaled function norm of previous newton step
+   */
+  PetscReal scaled_function_norm_prev;
+
+  /**
+   * total linear iterations at previous newton step
+   */
+  PetscInt  linear_iteration_prev;
+
+  /**
+   * @return the max ratio of each equation norm to its abs tolerance,
+   * it is the measurement of nonlinear residual used by forcing term.
+   * derived class can override it as needed.
+   */
+  virtual PetscReal scaled_function_norm() const;
+
+  /**
+   * compute the forcing term (relative tolerance of linear solver) by Eisenstat-Walker method
+   */
+  void update_forcing_term(PetscInt its);
+
+  /**
+   * @return true if Eisenstat-Walker forcing term is used by current linear solver
+   */
+  bool forcing_term_enabled() const;
+
 };
 
 #endif //#define __ddm_solver_h__
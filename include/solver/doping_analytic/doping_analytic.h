@@ -118,17 +118,21 @@ private:
  void set_doping_function_file(const Parser::Card & c);
 
 
- double _do_doping_interp(int i, const Node *node, const std::string &msg=std::string());
-
  /**
-  * @return the acceptor concentration of node
+  * interpolate the i-th doping data to all the nodes in one batch,
+  * the signed doping concentration is returned in values
   */
- double doping_Na(const Node * node);
+ void _do_doping_interp(int i, const std::vector<FVM_Node *> &fvm_nodes, std::vector<double> &values);
 
  /**
-  * @return the donor concentration of node
+  * evaluate the doping function at the points given by coordinate arrays,
+  * box_min/box_max bound all the points. points out of the bounding box
+  * of doping function are culled.
+  * the signed doping concentration is returned in values
   */
- double doping_Nd(const Node * node);
+ void _do_doping_function(DopingFunction * df, const std::vector<double> &x, const std::vector<double> &y,
+                          const std::vector<double> &z, const Point &box_min, const Point &box_max,
+                          std::vector<double> &values);
 
  /**
   * the pointer vector to DopingFunction
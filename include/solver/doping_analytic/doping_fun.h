@@ -71,6 +71,24 @@ public:
    */
   virtual double profile(double x, double y, double z)=0;
 
+  /**
+   * compute doping concentration of n points given by coordinate arrays.
+   * the default version calls profile() for each point
+   */
+  virtual void profile_batch(unsigned int n, const double *x, const double *y, const double *z, double *values)
+  {
+    for(unsigned int i=0; i<n; ++i)
+      values[i] = profile(x[i], y[i], z[i]);
+  }
+
+  /**
+   * the box out of which the doping concentration is zero or negligible,
+   * used to cull points before evaluation.
+   * @return false if the support of doping function is not bounded
+   */
+  virtual bool bounding_box(Point & /* p_min */, Point & /* p_max */) const
+  { return false; }
+
 protected:
   /**
    * impurity ion type N-ion or P-ion
@@ -105,6 +123,11 @@ public:
    */
   double profile(double x,double y,double z);
 
+  /**
+   * the doping box
+   */
+  bool bounding_box(Point &p_min, Point &p_max) const;
+
 private:
   /**
    * the peak value of doping concentration
@@ -171,6 +194,16 @@ public:
    */
   double profile(double x, double y, double z);
 
+  /**
+   * compute doping concentration of n points, direction by direction
+   */
+  void profile_batch(unsigned int n, const double *x, const double *y, const double *z, double *values);
+
+  /**
+   * the doping box extended by the gauss/erfc tails
+   */
+  bool bounding_box(Point &p_min, Point &p_max) const;
+
 private:
   /**
    * the peak value of doping concentration
@@ -339,6 +372,11 @@ public:
    */
   double profile(double x, double y, double z);
 
+  /**
+   * the region reached by doping lines from mask
+   */
+  bool bounding_box(Point &p_min, Point &p_max) const;
+
 private:
 
   /**
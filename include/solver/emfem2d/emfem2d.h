@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "enum_petsc_type.h"
+#include "dense_matrix.h"
 #include "fem_linear_solver.h"
 #include "petscksp.h"
 
@@ -155,6 +156,45 @@ private:
    */
   void build_TM_matrix_rhs(double lamda, double power, double phase0);
 
+  /**
+   * the wave length independent integrals of a local elem, the elem matrix of each
+   * wave length is a combination of them by region permittivity and wave vector
+   */
+  struct ElemIntegral
+  {
+    unsigned int              region;      // region index of the elem
+    std::vector<const Node *> nodes;
+    std::vector<PetscInt>     dof_indices;
+    DenseMatrix<Real>         stiffness;   // \int \nabla phi_m \cdot \nabla phi_n
+    DenseMatrix<Real>         mass;        // \int phi_m phi_n
+    std::vector<Real>         load;        // \int phi_m
+  };
+
+  /**
+   * the wave length independent integrals of a local edge on Absorbing Boundary
+   */
+  struct BoundaryIntegral
+  {
+    std::vector<PetscInt>     dof_indices;
+    std::vector<double>       curvatures;
+    DenseMatrix<Real>         mass;        // \int phi_m phi_n
+    DenseMatrix<Real>         dxi;         // \sum dphidxi_m dphidxi_n / edge length
+  };
+
+  std::vector<ElemIntegral>     _elem_integrals;
+
+  std::vector<BoundaryIntegral> _boundary_integrals;
+
+  /**
+   * compute _elem_integrals and _boundary_integrals, only once for all the wave lengths
+   */
+  void build_fem_integrals();
+
+  /**
+   * add Absorbing Boundary to matrix A
+   */
+  void build_absorbing_boundary_matrix(double k);
+
   /**
    * save nodal solution to fvm node data structure
    * when append is true, the new solution will be added to previous solution
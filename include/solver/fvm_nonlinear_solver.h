@@ -239,6 +239,46 @@ protected:
    */
   void set_petsc_preconditioner_type();
 
+  /**
+   * @return the block size used by AMG preconditioner, which is the nodal dofs
+   * of semiconductor regions, or 1 if semiconductor regions have different nodal dofs
+   */
+  unsigned int amg_block_size() const;
+
+  /**
+   * @return true when all the dofs are nodal ones with the same block size,
+   * then the whole jacobian matrix can be blocked for AMG
+   */
+  bool amg_uniform_block() const;
+
+  /**
+   * attach the near null space (piecewise constant vector for each nodal variable)
+   * to jacobian matrix, which is used by smoothed aggregation AMG preconditioner
+   */
+  void set_petsc_amg_near_null_space();
+
+  /**
+   * setup field split preconditioner with nodal AMG on the semiconductor dofs
+   * and ILU on the others (insulator/electrode nodes and bc dofs)
+   * @return false if it is not supported
+   */
+  bool set_petsc_amg_fieldsplit_preconditioner();
+
+  /**
+   * split the on processor dofs into two sets by region type:
+   * the dofs of insulator/conductor/resistance/vacuum regions, whose equations are (almost) linear,
+   * and the dofs of semiconductor regions together with bc and extra dofs.
+   */
+  void split_linear_region_dofs(std::vector<PetscInt> & linear_dofs, std::vector<PetscInt> & nonlinear_dofs) const;
+
+  /**
+   * setup field split preconditioner of the linear solver. the block of linear region dofs
+   * is factorized directly and the Schur complement of semiconductor dofs is preconditioned
+   * by its diagonal block. the newton iteration itself is not changed.
+   * @return false if no linear region dofs exist
+   */
+  bool set_petsc_schur_complement_preconditioner();
+
   /**
    * the global solution vector
    */
@@ -176,6 +176,11 @@ protected:
    */
   PetscScalar spice_norm;
 
+  /**
+   * scaled function norm, include spice equation
+   */
+  virtual PetscReal scaled_function_norm() const;
+
 };
 
 #endif //#define __mixA_solver_h__
@@ -24,11 +24,15 @@
 #define __light_thread_h__
 
 
+//C++ include
+#include <vector>
+
 //local include
 #include "point.h"
 #include "elem_intersection.h"
 
 class Elem;
+class LightThreadPool;
 
 /**
  * class to define a light
@@ -118,8 +122,10 @@ public:
    * @param norm the norm of interface, form material 2 to material 1
    * @param n1   refraction index of material 1
    * @param n2   refraction index of material 2
+   * @param pool when given, the new lights are allocated from this pool
    */
-  std::pair<LightThread *, LightThread *> interface_light_gen_linear_polarized(const Point & in_p, const Point & norm, double n1, double n2);
+  std::pair<LightThread *, LightThread *> interface_light_gen_linear_polarized(const Point & in_p, const Point & norm, double n1, double n2,
+                                                                                LightThreadPool * pool=0);
 
   /**
    * pointer to the elem this light hit
@@ -168,6 +174,55 @@ private:
    */
   double _power;
 
+  /**
+   * create a light from pool, or from heap if no pool given
+   */
+  static LightThread * _new_light(LightThreadPool * pool, const Point & p, const Point & dir, const Point & E_dir,
+                                  double wavelength, double init_power, double power);
+};
+
+
+
+/**
+ * free list allocator of LightThread. a single ray splits into many secondary
+ * rays at material interfaces, the pool keeps the released storage for reuse
+ * instead of going through the heap each time.
+ * @note the pool is owned by one tracing thread, it is not thread safe.
+ */
+class LightThreadPool
+{
+public:
+
+  LightThreadPool() {}
+
+  /**
+   * release all the storage hold by pool
+   */
+  ~LightThreadPool();
+
+  /**
+   * create a light, the arguments are the same as LightThread constructor
+   */
+  LightThread * create(const Point & p, const Point & dir, const Point & E_dir, double wavelength, double init_power, double power);
+
+  /**
+   * destroy the light created by this pool, NULL is allowed
+   */
+  void recycle(LightThread * light);
+
+private:
+
+  /**
+   * released storage
+   */
+  std::vector<void *> _free_list;
+
+  /**
+   * no copy
+   */
+  LightThreadPool(const LightThreadPool &);
+
+  LightThreadPool & operator= (const LightThreadPool &);
 };
 
 #endif
@@ -36,7 +36,9 @@
 
 
 class ObjectTree;
+class SurfaceBVH;
 class LightThread;
+class LightThreadPool;
 class LightLenses;
 
 /**
@@ -119,6 +121,11 @@ private:
   {return _region_refractive_index.find(sub_id)->second.second;}
 
 
+  /**
+   * the region has no absorption for current lamda
+   */
+  std::vector<bool> _region_transparent;
+
   /**
    * carrier density in each semiconductor elem
    */
@@ -214,6 +221,24 @@ private:
    */
   ObjectTree *surface_elem_tree;
 
+  /**
+   * bvh over the surface (boundary and interface sides) of each non-semiconductor region,
+   * NULL for semiconductor region, since free carrier absorption always exists there.
+   */
+  std::vector<SurfaceBVH *> _region_surface_bvh;
+
+  /**
+   * build _region_surface_bvh
+   */
+  void build_region_surface_bvh();
+
+  /**
+   * the ray is in a transparent region, no energy deposit before it reaches the region surface.
+   * find the elem on region surface the ray will go out from, and let the ray hit that elem directly.
+   * the ray is not changed when any thing is uncertain, the elem by elem walk will handle it.
+   */
+  void jump_to_region_surface(LightThread *) const;
+
   /**
    * when the light source can be considered as plane wave, this struct stores the plane norm to wave direction.
    * we will build a bounding sphere(C,R) of the mesh, then we build the plane with plane_norm = light_direction
@@ -306,26 +331,105 @@ private:
   void define_lenses();
 
   /**
-   * do ray tracing of a single ray
+   * energy deposited into an elem by a ray segment
+   */
+  struct EnergyDeposit
+  {
+    unsigned int elem;
+    double       band;
+    double       total;
+  };
+
+  /**
+   * append an energy deposit record
    */
-  void ray_tracing(LightThread *);
+  static void deposit(std::vector<EnergyDeposit> & deposits, unsigned int elem, double band, double total)
+  {
+    EnergyDeposit d;
+    d.elem  = elem;
+    d.band  = band;
+    d.total = total;
+    deposits.push_back(d);
+  }
 
   /**
-   * save the energy deposit. for parallel simulation, we must gather this vector
-   * from all the processors (call Parallel::sum(_band_absorption_energy_in_elem))
+   * do ray tracing of a single ray. the ray and its secondary rays are allocated from pool,
+   * the energy deposit along the path is appended to deposits in the order of tracing.
+   * only read the solver data, so it can be called by several threads at the same time.
    */
-  std::vector<double> _band_absorption_energy_in_elem;
+  void ray_tracing(LightThread *, LightThreadPool & pool, std::vector<EnergyDeposit> & deposits) const;
 
   /**
-   * save the energy deposit. for parallel simulation, we must gather this vector
-   * from all the processors (call Parallel::sum(_total_absorption_energy_in_elem))
+   * number of threads for ray tracing
+   */
+  unsigned int _n_threads;
+
+  /**
+   * the on processor rays are grouped into chunks of this size, a chunk is the unit of thread work
+   */
+  static const unsigned int _rays_per_chunk = 64;
+
+  /**
+   * a batch of ray chunks processed by threads together
+   */
+  struct TraceBatch;
+
+  /**
+   * the tracing threads kept alive during solve
+   */
+  struct TraceWorkers;
+
+  /**
+   * trace the rays [begin, end) of the wave plane
+   */
+  void trace_rays(unsigned int begin, unsigned int end, double lamda, double power,
+                  LightThreadPool & pool, std::vector<EnergyDeposit> & deposits) const;
+
+  /**
+   * take chunks from batch and trace them until the batch is empty
+   */
+  void trace_batch(TraceBatch & batch, LightThreadPool & pool) const;
+
+  /**
+   * entry of tracing thread, runs the worker loop until the solve is finished
+   */
+  static void * _thread_entry(void *);
+
+  /**
+   * carrier generation of each elem, summed over all the wave lengths. the deposit
+   * records of tracing threads are added in ray order, so the result does not depend
+   * on thread number. for parallel simulation, each processor only holds the part
+   * traced by itself until exchange_energy_deposit() is called.
+   */
+  std::vector<double> _optical_gen_in_elem;
+
+  /**
+   * heat of band absorption (photon energy above band gap) of each elem, summed over all the wave lengths
+   */
+  std::vector<double> _optical_heat_in_elem;
+
+  /**
+   * total absorbed energy of each elem, summed over all the wave lengths
    */
   std::vector<double> _total_absorption_energy_in_elem;
 
   /**
-   * convert energy to optical Generation
+   * add the deposit records of wave length n to the elem generation/heat/energy
+   */
+  void accumulate_deposits(unsigned int n, const std::vector<std::vector<EnergyDeposit> > & deposits);
+
+  /**
+   * send the deposit of elems not on this processor to their owners, then the owners
+   * send the summed value to the processors which hold the elem as ghost.
+   * only the elems with energy deposit are exchanged, the communication volume
+   * depends on the region the rays reached, not the mesh size.
+   */
+  void exchange_energy_deposit();
+
+  /**
+   * convert the accumulated energy to optical Generation at nodes
    */
-  void optical_generation(unsigned int );
+  void optical_generation();
 };
 
 #endif
@@ -0,0 +1,134 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+
+#ifndef __surface_bvh_h__
+#define __surface_bvh_h__
+
+#include <vector>
+#include <utility>
+
+#include "point.h"
+
+// Forward Declarations
+class Elem;
+
+/**
+ * bounding volume hierarchy over a set of elem sides, built with the surface
+ * area heuristic. the nodes and faces are stored in flat arrays, the left child
+ * of a node always follows it in the node array.
+ *
+ * ray tracing uses one tree for the surface (boundary and interface sides) of each
+ * region, so a ray in non-absorbing region can go to the region surface directly
+ * instead of stepping through every elem.
+ */
+class SurfaceBVH
+{
+public:
+
+  /**
+   * build the tree over the elem sides
+   * @param faces  (elem, side) pairs
+   * @param dim    2 for 2d mesh, where the sides are edges in xy plane
+   */
+  SurfaceBVH(const std::vector<std::pair<const Elem *, unsigned int> > & faces, unsigned int dim);
+
+  /**
+   * find the nearest side hit by the ray p + t*d with t > t_min
+   * @param d  unit direction of the ray
+   * @return false if no side hit
+   */
+  bool hit(const Point & p, const Point & d, double t_min, const Elem * & elem, unsigned int & side, double & t) const;
+
+  /**
+   * @return the number of sides in the tree
+   */
+  unsigned int n_faces() const
+  { return static_cast<unsigned int>(_faces.size()); }
+
+private:
+
+  /**
+   * a side, quad side is split into two triangles at intersection test
+   */
+  struct Face
+  {
+    const Elem * elem;
+    unsigned int side;
+    unsigned int n_points;
+    Point        points[4];
+    Point        lower;
+    Point        upper;
+    Point        centroid;
+  };
+
+  /**
+   * interior node has count = 0, its children are at (this+1) and offset.
+   * leaf node holds faces [offset, offset+count)
+   */
+  struct Node
+  {
+    Point        lower;
+    Point        upper;
+    unsigned int offset;
+    unsigned int count;
+  };
+
+  std::vector<Face> _faces;
+
+  std::vector<Node> _nodes;
+
+  unsigned int _dim;
+
+  /**
+   * max faces in a leaf
+   */
+  static const unsigned int _leaf_size = 4;
+
+  /**
+   * build the subtree of faces [begin, end)
+   * @return the node index
+   */
+  unsigned int _build(unsigned int begin, unsigned int end);
+
+  /**
+   * the cost measure of a box, surface area in 3d, perimeter in 2d
+   */
+  double _box_area(const Point & lower, const Point & upper) const;
+
+  /**
+   * slab test, return the entry parameter of the box in t_near
+   */
+  bool _hit_box(const Node & node, const Point & p, const Point & d, double t_min, double t_max, double & t_near) const;
+
+  /**
+   * ray-side intersection test
+   */
+  bool _hit_face(const Face & face, const Point & p, const Point & d, double t_min, double & t) const;
+
+  /**
+   * ray-triangle intersection test
+   */
+  static bool _hit_triangle(const Point & a, const Point & b, const Point & c, const Point & p, const Point & d, double & t);
+};
+
+#endif
@@ -176,6 +176,32 @@ namespace SolverSpecify
    */
   extern bool     ksp_singular;
 
+  /**
+   * use Eisenstat-Walker forcing term as the relative tolerance
+   * of the linear solver (iterative solvers only)
+   */
+  extern bool     ksp_ew;
+
+  /**
+   * initial forcing term of Eisenstat-Walker method
+   */
+  extern double   ksp_ew_rtol0;
+
+  /**
+   * max forcing term of Eisenstat-Walker method
+   */
+  extern double   ksp_ew_rtol_max;
+
+  /**
+   * gamma parameter of Eisenstat-Walker method
+   */
+  extern double   ksp_ew_gamma;
+
+  /**
+   * alpha parameter of Eisenstat-Walker method
+   */
+  extern double   ksp_ew_alpha;
+
   //--------------------------------------------
   // nonlinear solver convergence criteria
   //--------------------------------------------
@@ -367,6 +393,17 @@ namespace SolverSpecify
    */
   extern int       T_Cycles;
 
+  /**
+   * the time step at clock is accepted, but clock is not advanced to the next step yet
+   */
+  extern bool      TimeStepDone;
+
+  /**
+   * time integration state is restored from checkpoint, the next transient solve
+   * continues from it instead of TStart. it is not reset by set_default_parameter()
+   */
+  extern bool      Resume;
+
 
   //------------------------------------------------------
   // parameters for DC and TRACE simulation
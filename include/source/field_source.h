@@ -155,6 +155,11 @@ private:
    */
   Waveform * current_waveform;
 
+  /**
+   * rebuild optical generation only, the particle generation depends on mesh only
+   */
+  void _update_light_sources();
+
   /**
    * private functions for setting each waveform
    */
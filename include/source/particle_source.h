@@ -24,6 +24,9 @@
 #ifndef __particle_source_h__
 #define __particle_source_h__
 
+#include <vector>
+#include <string>
+
 #include "auto_ptr.h"
 #include "point.h"
 #include "interpolation_base.h"
@@ -33,6 +36,7 @@ namespace Parser{
   class Card;
 }
 class SimulationSystem;
+class FVM_Node;
 
 /**
  * set the carrier generation of Particle
@@ -224,6 +228,61 @@ private:
    */
   double _lateral_char;
 
+  /**
+   * on processor fvm nodes of all the regions, in region order.
+   * used to detect the change of mesh/system
+   */
+  std::vector<FVM_Node *> _indexed_fvm_nodes;
+
+  /**
+   * bin index of on processor fvm nodes, nodes are sorted by bin
+   * and the coordinates/volumes are stored continuously for batch evaluation
+   */
+  std::vector<FVM_Node *>   _bin_nodes;
+  std::vector<double>       _bin_node_x;
+  std::vector<double>       _bin_node_y;
+  std::vector<double>       _bin_node_z;
+  std::vector<double>       _bin_node_volume;
+
+  /**
+   * nodes in bin b are [_bin_offset[b], _bin_offset[b+1]) of the above arrays
+   */
+  std::vector<unsigned int> _bin_offset;
+
+  /**
+   * lower corner of the bin grid
+   */
+  Point _bin_origin;
+
+  /**
+   * edge length of a (cubic) bin
+   */
+  double _bin_size;
+
+  /**
+   * bin number in each direction
+   */
+  unsigned int _n_bins[3];
+
+  /**
+   * cached energy density deposited by all the tracks, for each node in _bin_nodes
+   */
+  std::vector<double> _node_energy;
+
+  /**
+   * build bin index of on processor fvm nodes
+   */
+  void _build_node_index();
+
+  /**
+   * evaluate the energy deposit of all the tracks into _node_energy
+   */
+  void _deposit_tracks();
+
+  /**
+   * @return the bin range [lo, hi] covered by bounding box [p_min, p_max]
+   */
+  void _bin_range(const Point &p_min, const Point &p_max, unsigned int lo[3], unsigned int hi[3]) const;
 
 };
 
@@ -0,0 +1,188 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __async_writer_h__
+#define __async_writer_h__
+
+// C++ includes
+#include <deque>
+#include <string>
+
+#include "genius_common.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+
+/**
+ * background output pipeline for solution snapshots.
+ * the collective part of an export (gathering data to processor 0) is still done by
+ * all the processors. after that, processor 0 packs everything it needs into a Job
+ * and submits it here. the job is serialized and written to disk by a dedicated I/O
+ * thread, and the solver continues with next step at once.
+ *
+ * the memory hold by pending jobs is bounded. when the limit is reached, submit()
+ * blocks until the I/O thread has finished enough jobs (back-pressure).
+ *
+ * without pthread support, jobs are executed at once in the calling thread.
+ */
+class AsyncWriter
+{
+public:
+
+  /**
+   * a self contained write request. run() is executed by the I/O thread,
+   * it must not access any mesh/solution data or do MPI communication.
+   */
+  class Job
+  {
+  public:
+    virtual ~Job() {}
+
+    /**
+     * do the actual serialization/write
+     */
+    virtual void run()=0;
+
+    /**
+     * @return approximate memory (in byte) hold by this job
+     */
+    virtual size_t memory_size() const=0;
+
+    /**
+     * @return the file name this job writes to
+     */
+    virtual std::string file_name() const=0;
+  };
+
+  /**
+   * @return the unique writer instance
+   */
+  static AsyncWriter & instance();
+
+  /**
+   * submit a job, the writer takes the ownership of it.
+   * block when pending memory exceeds the limit.
+   */
+  void submit(Job * job);
+
+  /**
+   * wait until all the submitted jobs are written
+   */
+  void flush();
+
+  /**
+   * @return the number of jobs not yet written
+   */
+  unsigned int n_pending_jobs() const;
+
+  /**
+   * set the max memory (in byte) can be hold by pending jobs
+   */
+  void set_max_pending_memory(size_t size)
+  { _max_pending_memory = size; }
+
+  /**
+   * @return the max memory (in byte) can be hold by pending jobs
+   */
+  size_t max_pending_memory() const
+  { return _max_pending_memory; }
+
+private:
+
+  AsyncWriter();
+
+  ~AsyncWriter();
+
+  /**
+   * execute a job and free it
+   */
+  static void _execute(Job * job);
+
+  /**
+   * job queue
+   */
+  std::deque<Job *> _jobs;
+
+  /**
+   * memory hold by jobs in queue and the running one
+   */
+  size_t _pending_memory;
+
+  /**
+   * max memory can be hold by pending jobs
+   */
+  size_t _max_pending_memory;
+
+  /**
+   * the I/O thread is writing a job
+   */
+  bool _busy;
+
+#ifdef HAVE_PTHREAD
+
+  /**
+   * entry of I/O thread
+   */
+  static void * _thread_entry(void *);
+
+  /**
+   * main loop of I/O thread
+   */
+  void _thread_loop();
+
+  /**
+   * the I/O thread
+   */
+  pthread_t _thread;
+
+  /**
+   * I/O thread started
+   */
+  bool _thread_started;
+
+  /**
+   * ask I/O thread to exit
+   */
+  bool _stop;
+
+  /**
+   * protect the job queue
+   */
+  mutable pthread_mutex_t _mutex;
+
+  /**
+   * signaled when new job arrives
+   */
+  pthread_cond_t _job_cond;
+
+  /**
+   * signaled when a job is finished
+   */
+  pthread_cond_t _done_cond;
+
+#endif
+};
+
+
+#endif
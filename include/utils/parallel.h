@@ -411,6 +411,27 @@ namespace Parallel
   template <typename T>
   inline void alltoall(std::vector<T> &r);
 
+  //-------------------------------------------------------------------
+  /**
+   * Personalized all-to-all exchange of variable length vectors:
+   * processor i sends \p send[j] to processor j, and receives the vector
+   * processor j sent to it in \p recv[j].
+   */
+  template <typename T>
+  inline void alltoall(const std::vector<std::vector<T> > &send,
+                       std::vector<std::vector<T> > &recv);
+
+  //-------------------------------------------------------------------
+  /**
+   * The inverse of gather: processor root_id holds one vector for each
+   * processor in \p data, processor i receives data[i] into \p r.
+   * The vectors may have different length. \p data is only used on root_id.
+   */
+  template <typename T>
+  inline void scatter(const unsigned int root_id,
+                      const std::vector<std::vector<T> > &data,
+                      std::vector<T> &r);
+
 
 
   //-------------------------------------------------------------------
@@ -2018,6 +2039,60 @@ namespace Parallel
   }
 
 
+  template <typename T>
+  inline void scatter(const unsigned int root_id,
+                      const std::vector<std::vector<T> > &data,
+                      std::vector<T> &r)
+  {
+    if (Genius::n_processors() == 1)
+    {
+      assert (Genius::processor_id()==root_id);
+      r = data[0];
+      return;
+    }
+
+    START_LOG("scatter()", "Parallel");
+
+    std::vector<int>
+    sendlengths  (Genius::n_processors(), 0),
+    displacements(Genius::n_processors(), 0);
+
+    // flatten the data on root processor
+    std::vector<T> buf;
+    if (root_id == Genius::processor_id())
+    {
+      genius_assert(data.size() == Genius::n_processors());
+      unsigned int globalsize = 0;
+      for (unsigned int i=0; i != Genius::n_processors(); ++i)
+      {
+        sendlengths[i]   = data[i].size();
+        displacements[i] = globalsize;
+        globalsize += data[i].size();
+      }
+      buf.reserve(globalsize);
+      for (unsigned int i=0; i != Genius::n_processors(); ++i)
+        buf.insert(buf.end(), data[i].begin(), data[i].end());
+    }
+
+    int mysize = 0;
+    MPI_Scatter(&sendlengths[0], 1, MPI_INT, &mysize, 1, MPI_INT, root_id, Genius::comm_world());
+
+    r.resize(mysize);
+
+    const int ierr =
+      MPI_Scatterv (buf.empty() ? NULL : &buf[0], &sendlengths[0],
+                    &displacements[0], datatype<T>(),
+                    r.empty() ? NULL : &r[0], mysize, datatype<T>(),
+                    root_id,
+                    Genius::comm_world());
+
+    assert (ierr == MPI_SUCCESS);
+
+    STOP_LOG("scatter()", "Parallel");
+  }
+
+
+
   /**
    * Replaces the input buffer with the result of MPI_Alltoall.
    * The vector size must be of te form N*n_procs, where N is
@@ -2056,6 +2131,57 @@ namespace Parallel
   }
 
 
+  template <typename T>
+  inline void alltoall(const std::vector<std::vector<T> > &send,
+                       std::vector<std::vector<T> > &recv)
+  {
+    if (Genius::n_processors() == 1)
+    {
+      recv = send;
+      return;
+    }
+
+    genius_assert(send.size() == Genius::n_processors());
+
+    // exchange the lengths first
+    std::vector<int> sendlengths(Genius::n_processors(), 0);
+    std::vector<int> senddispls (Genius::n_processors(), 0);
+    std::vector<T> sendbuf;
+    for (unsigned int i=0; i != Genius::n_processors(); ++i)
+    {
+      sendlengths[i] = send[i].size();
+      senddispls[i]  = sendbuf.size();
+      sendbuf.insert(sendbuf.end(), send[i].begin(), send[i].end());
+    }
+
+    std::vector<int> recvlengths(sendlengths);
+    alltoall(recvlengths);
+
+    START_LOG("alltoall()", "Parallel");
+
+    std::vector<int> recvdispls (Genius::n_processors(), 0);
+    unsigned int recvsize = 0;
+    for (unsigned int i=0; i != Genius::n_processors(); ++i)
+    {
+      recvdispls[i] = recvsize;
+      recvsize += recvlengths[i];
+    }
+    std::vector<T> recvbuf(recvsize);
+
+    const int ierr =
+      MPI_Alltoallv (sendbuf.empty() ? NULL : &sendbuf[0], &sendlengths[0], &senddispls[0], datatype<T>(),
+                     recvbuf.empty() ? NULL : &recvbuf[0], &recvlengths[0], &recvdispls[0], datatype<T>(),
+                     Genius::comm_world());
+    assert (ierr == MPI_SUCCESS);
+
+    recv.resize(Genius::n_processors());
+    for (unsigned int i=0; i != Genius::n_processors(); ++i)
+      recv[i].assign(recvbuf.begin() + recvdispls[i], recvbuf.begin() + recvdispls[i] + recvlengths[i]);
+
+    STOP_LOG("alltoall()", "Parallel");
+  }
+
+
 
   template <typename T>
   inline void broadcast (T &data, const unsigned int root_id)
@@ -2491,6 +2617,20 @@ namespace Parallel
   template <typename T>
   inline void alltoall(std::vector<T> &) {}
 
+  template <typename T>
+  inline void alltoall(const std::vector<std::vector<T> > &send,
+                       std::vector<std::vector<T> > &recv)
+  { recv = send; }
+
+  template <typename T>
+  inline void scatter(const unsigned int root_id,
+                      const std::vector<std::vector<T> > &data,
+                      std::vector<T> &r)
+  {
+    assert (!root_id);
+    r = data[0];
+  }
+
   template <typename T>
   inline void broadcast (T &, const unsigned int) {}
 
@@ -0,0 +1,37 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __structure_cache_h__
+#define __structure_cache_h__
+
+#include <string>
+#include <vector>
+
+/**
+ * the cache file name of an imported device structure. the name is placed next to
+ * the first source file and contains the hash of the format and source file contents,
+ * so a modified source never hits an old cache.
+ * collective, the hash is computed on processor 0.
+ * @return empty string when any source file can not be read
+ */
+extern std::string structure_cache_file(const std::vector<std::string> & sources, const std::string & format);
+
+#endif
@@ -22,6 +22,7 @@
 
 #include "genius_common.h"
 #include "genius_env.h"
+#include "async_writer.h"
 
 #ifdef HAVE_SLEPC
   #include "slepcsys.h"
@@ -67,6 +68,8 @@ bool Genius::init_processors(int *argc, char *** args)
 
 bool Genius::clean_processors()
 {
+  // finish background output before shutdown
+  AsyncWriter::instance().flush();
 
 #ifdef HAVE_MPI
   MPI_Comm_free(&Genius::GeniusPrivateData::_comm_world);
@@ -44,6 +44,9 @@ namespace DFISE
   // functions for class DFISE_MESH
 
 
+  // the mesh being parsed, the parser drops the datasets it does not want
+  static const DFISE_MESH * parsing_mesh = NULL;
+
   // avoid isatty() problem of Bison 2.3
 #define YY_NEVER_INTERACTIVE 1
 #ifdef WINDOWS
@@ -408,11 +411,13 @@ namespace DFISE
 
     BLOCK *block = new BLOCK;
 
+    parsing_mesh = this;
     yyin = fopen(dataset_file.c_str(), "r");
     assert( yyin != NULL );
     assert(!yyparse(block));
     fclose(yyin);
     YY_FLUSH_BUFFER;
+    parsing_mesh = NULL;
 
     for(unsigned int n=0; n<block->n_sub_blocks(); ++n)
     {
@@ -470,6 +475,9 @@ namespace DFISE
       BLOCK * dataset_block = block->get_sub_block(n);
       assert(dataset_block->keyword()=="Dataset");
 
+      // dropped by parser
+      if(!is_dataset_wanted(dataset_block->label())) continue;
+
       DATASET * dataset = new DATASET;
 
       dataset->name = dataset_block->label();
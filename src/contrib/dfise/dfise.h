@@ -67,6 +67,26 @@ namespace DFISE
      */
     void write_dfise(const std::string & file) const;
 
+    /**
+     * only the datasets whose name contains one of the patterns are loaded,
+     * the others are dropped as soon as they are parsed.
+     * empty filter (default) loads all the datasets
+     */
+    void set_dataset_filter(const std::vector<std::string> & patterns)
+    { dataset_filter = patterns; }
+
+    /**
+     * @return true when dataset with name should be loaded
+     */
+    bool is_dataset_wanted(const std::string & name) const
+    {
+      if(dataset_filter.empty()) return true;
+      for(unsigned int n=0; n<dataset_filter.size(); ++n)
+        if(name.find(dataset_filter[n])!=std::string::npos)
+          return true;
+      return false;
+    }
+
 
 
     /**
@@ -242,6 +262,11 @@ namespace DFISE
      */
     std::vector<DATASET *> data_sets;
 
+    /**
+     * name patterns of the datasets to be loaded
+     */
+    std::vector<std::string> dataset_filter;
+
   };
 
 
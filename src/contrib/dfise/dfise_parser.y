@@ -81,7 +81,11 @@ block    : KEYWORD '{' body '}'
          /* new block */
          $$ = new BLOCK($1);
          $$->set_label($3);
-         $$->append(*$6);
+         /* free the values of unwanted dataset at once, keep memory bounded */
+         if( parsing_mesh && std::string($1)=="Dataset" && !parsing_mesh->is_dataset_wanted($3) )
+           $6->clear();
+         else
+           $$->append(*$6);
          delete $6;
 }
          ;
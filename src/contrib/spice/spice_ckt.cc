@@ -696,6 +696,64 @@ void SPICE_CKT::get_state_vector(int i, std::vector<double> &state) const
 
 
 
+void SPICE_CKT::set_state_vector(int i, const std::vector<double> &state)
+{
+  unsigned int (*n_state)();
+  n_state = (unsigned int (*)())LDFUN(dll_file,"ngspice_n_state");
+  assert(n_state);
+  assert(state.size() == n_state());
+
+  double ** (*get_state)(int);
+  get_state = (double ** (*)(int))LDFUN(dll_file,"ngspice_get_state");
+  assert(get_state);
+
+  double * state_array = *(get_state(i));
+  for(unsigned int n=0; n<state.size(); ++n)
+    state_array[n] = state[n];
+}
+
+
+void SPICE_CKT::pack_state(std::vector<double> &state) const
+{
+  state.clear();
+  if(!Genius::is_last_processor()) return;
+
+  // layout: n_nodes, rhs_old, n_state, state0, state1
+  state.push_back(_n_nodes);
+  for(unsigned int n=0; n<_n_nodes; ++n)
+    state.push_back((*_p_rhs_old)[n]);
+
+  for(int i=0; i<2; ++i)
+  {
+    std::vector<double> ckt_state;
+    get_state_vector(i, ckt_state);
+    if(i==0) state.push_back(ckt_state.size());
+    state.insert(state.end(), ckt_state.begin(), ckt_state.end());
+  }
+}
+
+
+void SPICE_CKT::unpack_state(const std::vector<double> &state)
+{
+  if(Genius::is_last_processor() && !state.empty())
+  {
+    assert(state.size() > _n_nodes+1);
+    assert(static_cast<unsigned int>(state[0]) == _n_nodes);
+    for(unsigned int n=0; n<_n_nodes; ++n)
+      (*_p_rhs_old)[n] = state[1+n];
+
+    const unsigned int n_state = static_cast<unsigned int>(state[_n_nodes+1]);
+    std::vector<double>::const_iterator it = state.begin() + _n_nodes + 2;
+    for(int i=0; i<2; ++i, it+=n_state)
+      set_state_vector(i, std::vector<double>(it, it+n_state));
+  }
+
+  // sync the converged solution to all the processors
+  save_solution();
+}
+
+
+
 void SPICE_CKT::prepare_ckt_state_first_time()
 {
   void (*set_state)();
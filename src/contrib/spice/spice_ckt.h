@@ -462,6 +462,23 @@ public:
    */
   void get_state_vector(int i, std::vector<double> &) const;
 
+  /**
+   * set the ith state vector
+   */
+  void set_state_vector(int i, const std::vector<double> &);
+
+  /**
+   * pack converged solution and the current/previous state vectors, for checkpoint.
+   * only meaningful on the last processor which runs spice
+   */
+  void pack_state(std::vector<double> &) const;
+
+  /**
+   * restore the state packed by pack_state. must call in parallel,
+   * state is only required on the last processor
+   */
+  void unpack_state(const std::vector<double> &);
+
   /**
    * load circuit, and reorder the matrix
    */
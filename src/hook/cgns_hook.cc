@@ -26,13 +26,14 @@
 #include "cgns_hook.h"
 #include "spice_ckt.h"
 #include "MXMLUtil.h"
+#include "async_writer.h"
 
 
 /*----------------------------------------------------------------------
  * constructor, open the file for writing
  */
 CGNSHook::CGNSHook ( SolverBase & solver, const std::string & name, void * param)
-    : Hook ( solver, name ), _cgns_prefix ( SolverSpecify::out_prefix ), _mixA ( false )
+    : Hook ( solver, name ), _cgns_prefix ( SolverSpecify::out_prefix ), _ddm ( false ), _mixA ( false ), _ddm_ac ( false ), _async ( true ), _series ( false )
 {
   this->count  =0;
   this->_t_step=0;
@@ -52,15 +53,15 @@ CGNSHook::CGNSHook ( SolverBase & solver, const std::string & name, void * param
       _v_step=parm_it->get_real() * PhysicalUnit::V;
     if ( parm_it->name() == "istep" && parm_it->type() == Parser::REAL )
       _i_step=parm_it->get_real() * PhysicalUnit::A;
+    if ( parm_it->name() == "async" && parm_it->type() == Parser::BOOL )
+      _async=parm_it->get_bool();
+    if ( parm_it->name() == "series" && parm_it->type() == Parser::BOOL )
+      _series=parm_it->get_bool();
+    if ( parm_it->name() == "async.buffer" && parm_it->type() == Parser::REAL )
+      AsyncWriter::instance().set_max_pending_memory( static_cast<size_t>(parm_it->get_real()*1024*1024) );
   }
 
 
-  const SimulationSystem &system = get_solver().get_system();
-
-  std::ostringstream cgns_filename;
-  cgns_filename << _cgns_prefix << '.' << ( this->count++ ) << ".cgns";
-  system.export_cgns ( cgns_filename.str() );
-
   SolverSpecify::SolverType solver_type = this->get_solver().solver_type();
 
   // if we are called by mixA solver?
@@ -75,6 +76,14 @@ CGNSHook::CGNSHook ( SolverBase & solver, const std::string & name, void * param
     case SolverSpecify::DDMAC     :   _ddm_ac = true; break;
     default : break;
   }
+
+  // initial snapshot, series value is the swept voltage/current for DC sweep
+  if ( SolverSpecify::Type==SolverSpecify::DCSWEEP && SolverSpecify::Electrode_VScan.size() )
+    this->export_cgns ( this->scan_voltage()/PhysicalUnit::V );
+  else if ( SolverSpecify::Type==SolverSpecify::DCSWEEP && SolverSpecify::Electrode_IScan.size() )
+    this->export_cgns ( this->scan_current()/PhysicalUnit::A );
+  else
+    this->export_cgns ( SolverSpecify::clock/PhysicalUnit::s );
 }
 
 
@@ -112,29 +121,11 @@ void CGNSHook::post_solve()
   std::ostringstream cgns_filename;
   if ( SolverSpecify::Type==SolverSpecify::DCSWEEP && SolverSpecify::Electrode_VScan.size() )
   {
-    double Vscan = 0;
-
-    // DDM solver
-    if ( _ddm )
-    {
-      const BoundaryConditionCollector * bcs = _solver.get_system().get_bcs();
-      const BoundaryCondition * bc = bcs->get_bc ( SolverSpecify::Electrode_VScan[0] );
-      Vscan = bc->ext_circuit()->Vapp();
-    }
-    // MIXA solver
-    if ( _mixA )
-    {
-      SPICE_CKT * spice_ckt = _solver.get_system().get_circuit();
-      Vscan = spice_ckt->get_voltage_from_sync ( SolverSpecify::Electrode_VScan[0] );
-    }
-
+    double Vscan = this->scan_voltage();
 
     if ( std::fabs ( Vscan - this->_v_last ) >= this->_v_step )
     {
-      const SimulationSystem &system = get_solver().get_system();
-
-      cgns_filename << _cgns_prefix << '.' << ( this->count++ ) << ".cgns";
-      system.export_cgns ( cgns_filename.str() );
+      cgns_filename << this->export_cgns ( Vscan/PhysicalUnit::V );
 
       _v_last = Vscan;
     }
@@ -142,29 +133,11 @@ void CGNSHook::post_solve()
 
   if ( SolverSpecify::Type==SolverSpecify::DCSWEEP && SolverSpecify::Electrode_IScan.size() )
   {
-    double Iscan = 0;
-
-    // DDM solver
-    if ( _ddm )
-    {
-      const BoundaryConditionCollector * bcs = _solver.get_system().get_bcs();
-      const BoundaryCondition * bc = bcs->get_bc ( SolverSpecify::Electrode_IScan[0] );
-      Iscan = bc->ext_circuit()->Iapp();
-    }
-
-    // MIXA solver
-    if ( _mixA )
-    {
-      SPICE_CKT * spice_ckt = _solver.get_system().get_circuit();
-      Iscan = spice_ckt->get_current_from_sync ( SolverSpecify::Electrode_IScan[0] );
-    }
+    double Iscan = this->scan_current();
 
     if ( std::fabs ( Iscan - this->_i_last ) >= this->_i_step )
     {
-      const SimulationSystem &system = get_solver().get_system();
-
-      cgns_filename << _cgns_prefix << '.' << ( this->count++ ) << ".cgns";
-      system.export_cgns ( cgns_filename.str() );
+      cgns_filename << this->export_cgns ( Iscan/PhysicalUnit::A );
 
       _i_last = Iscan;
     }
@@ -175,10 +148,7 @@ void CGNSHook::post_solve()
   {
     if ( SolverSpecify::clock - this->_t_last >= this->_t_step )
     {
-      const SimulationSystem &system = get_solver().get_system();
-
-      cgns_filename << _cgns_prefix << '.' << ( this->count++ ) << ".cgns";
-      system.export_cgns ( cgns_filename.str() );
+      cgns_filename << this->export_cgns ( SolverSpecify::clock/PhysicalUnit::s );
 
       _t_last = SolverSpecify::clock;
 
@@ -202,6 +172,85 @@ void CGNSHook::post_solve()
 
 
 
+/*----------------------------------------------------------------------
+ *  voltage of the first VScan electrode
+ */
+double CGNSHook::scan_voltage() const
+{
+  double Vscan = 0;
+
+  // DDM solver
+  if ( _ddm )
+  {
+    const BoundaryConditionCollector * bcs = _solver.get_system().get_bcs();
+    const BoundaryCondition * bc = bcs->get_bc ( SolverSpecify::Electrode_VScan[0] );
+    Vscan = bc->ext_circuit()->Vapp();
+  }
+  // MIXA solver
+  if ( _mixA )
+  {
+    SPICE_CKT * spice_ckt = _solver.get_system().get_circuit();
+    Vscan = spice_ckt->get_voltage_from_sync ( SolverSpecify::Electrode_VScan[0] );
+  }
+
+  return Vscan;
+}
+
+
+
+/*----------------------------------------------------------------------
+ *  current of the first IScan electrode
+ */
+double CGNSHook::scan_current() const
+{
+  double Iscan = 0;
+
+  // DDM solver
+  if ( _ddm )
+  {
+    const BoundaryConditionCollector * bcs = _solver.get_system().get_bcs();
+    const BoundaryCondition * bc = bcs->get_bc ( SolverSpecify::Electrode_IScan[0] );
+    Iscan = bc->ext_circuit()->Iapp();
+  }
+
+  // MIXA solver
+  if ( _mixA )
+  {
+    SPICE_CKT * spice_ckt = _solver.get_system().get_circuit();
+    Iscan = spice_ckt->get_current_from_sync ( SolverSpecify::Electrode_IScan[0] );
+  }
+
+  return Iscan;
+}
+
+
+
+/*----------------------------------------------------------------------
+ *  write a snapshot, return the file name
+ */
+std::string CGNSHook::export_cgns ( double value )
+{
+  const SimulationSystem &system = get_solver().get_system();
+
+  std::ostringstream cgns_filename;
+
+  // all the steps go into one file, mesh is written only once
+  if ( _series )
+  {
+    cgns_filename << _cgns_prefix << ".cgns";
+    _series_values.push_back ( value );
+    system.export_cgns_series ( cgns_filename.str(), _series_values, _async );
+    this->count++;
+    return cgns_filename.str();
+  }
+
+  cgns_filename << _cgns_prefix << '.' << ( this->count++ ) << ".cgns";
+  system.export_cgns ( cgns_filename.str(), _async );
+  return cgns_filename.str();
+}
+
+
+
 /*----------------------------------------------------------------------
  *  This is executed after each (nonlinear) iteration
  */
@@ -214,7 +263,10 @@ void CGNSHook::post_iteration()
  * This is executed after the finalization of the solver
  */
 void CGNSHook::on_close()
-{}
+{
+  // make sure all the snapshots are on disk
+  AsyncWriter::instance().flush();
+}
 
 
 #ifdef DLLHOOK
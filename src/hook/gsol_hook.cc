@@ -0,0 +1,159 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <sstream>
+
+#include "solver_base.h"
+#include "gsol_hook.h"
+#include "MXMLUtil.h"
+#include "async_writer.h"
+
+
+/*----------------------------------------------------------------------
+ * constructor
+ */
+GSOLHook::GSOLHook ( SolverBase & solver, const std::string & name, void * param)
+    : Hook ( solver, name ), _gsol_prefix ( SolverSpecify::out_prefix ),
+      _precision ( 0.0 ), _compress ( true ), _checkpoint ( false ), _async ( true )
+{
+  this->count  =0;
+  this->_t_step=0;
+  this->_t_last=0;
+
+  const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
+  for ( std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
+        parm_it != parm_list.end(); parm_it++ )
+  {
+    if ( parm_it->name() == "tstep" && parm_it->type() == Parser::REAL )
+      _t_step=parm_it->get_real() * PhysicalUnit::s;
+    if ( parm_it->name() == "precision" && parm_it->type() == Parser::REAL )
+      _precision=parm_it->get_real();
+    if ( parm_it->name() == "compress" && parm_it->type() == Parser::BOOL )
+      _compress=parm_it->get_bool();
+    if ( parm_it->name() == "checkpoint" && parm_it->type() == Parser::BOOL )
+      _checkpoint=parm_it->get_bool();
+    if ( parm_it->name() == "async" && parm_it->type() == Parser::BOOL )
+      _async=parm_it->get_bool();
+    if ( parm_it->name() == "async.buffer" && parm_it->type() == Parser::REAL )
+      AsyncWriter::instance().set_max_pending_memory( static_cast<size_t>(parm_it->get_real()*1024*1024) );
+  }
+}
+
+
+/*----------------------------------------------------------------------
+ * destructor
+ */
+GSOLHook::~GSOLHook()
+{}
+
+
+/*----------------------------------------------------------------------
+ *   This is executed before the initialization of the solver
+ */
+void GSOLHook::on_init()
+{}
+
+
+/*----------------------------------------------------------------------
+ *   This is executed previously to each solution step.
+ */
+void GSOLHook::pre_solve()
+{}
+
+
+/*----------------------------------------------------------------------
+ *  This is executed after each solution step.
+ */
+void GSOLHook::post_solve()
+{
+  if ( SolverSpecify::Type==SolverSpecify::TRANSIENT )
+  {
+    if ( SolverSpecify::clock - this->_t_last >= this->_t_step )
+    {
+      export_gsol ( SolverSpecify::clock );
+      _t_last = SolverSpecify::clock;
+    }
+    return;
+  }
+
+  if ( SolverSpecify::Type==SolverSpecify::ACSWEEP )
+  {
+    export_gsol ( SolverSpecify::Freq );
+    return;
+  }
+
+  // DC sweep, trace and operator point, record the step number
+  export_gsol ( this->count );
+}
+
+
+/*----------------------------------------------------------------------
+ *  This is executed after each (nonlinear) iteration
+ */
+void GSOLHook::post_iteration()
+{}
+
+
+/*----------------------------------------------------------------------
+ * This is executed after the finalization of the solver
+ */
+void GSOLHook::on_close()
+{
+  // make sure all the snapshots are on disk
+  AsyncWriter::instance().flush();
+}
+
+
+void GSOLHook::export_gsol(double value)
+{
+  std::ostringstream gsol_filename;
+  gsol_filename << _gsol_prefix << ( this->count++ ) << ".gsol";
+
+  const SimulationSystem &system = get_solver().get_system();
+  if ( _checkpoint )
+    system.export_checkpoint ( gsol_filename.str(), _async );
+  else
+    system.export_gsol ( gsol_filename.str(), _precision, _compress, value, _async );
+
+  mxml_node_t *eSolution = get_solver().current_dom_solution_elem();
+  if ( eSolution )
+  {
+    mxml_node_t *eOutput  = mxmlFindElement ( eSolution, eSolution, "output", NULL, NULL, MXML_DESCEND_FIRST );
+    mxml_node_t *eGsol    = mxmlNewElement ( eOutput, "gsol" );
+    mxml_node_t *eFile    = mxmlNewElement ( eGsol, "file" );
+    mxmlAdd ( eFile, MXML_ADD_AFTER, NULL, MXMLQVariant::makeQVString ( gsol_filename.str() ) );
+  }
+}
+
+
+#ifdef DLLHOOK
+
+// dll interface
+extern "C"
+{
+  Hook* get_hook ( SolverBase & solver, const std::string & name, void * fun_data )
+  {
+    return new GSOLHook ( solver, name, fun_data );
+  }
+
+}
+
+#endif
@@ -0,0 +1,331 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <string>
+#include <algorithm>
+
+#include "solver_base.h"
+#include "ivstream_hook.h"
+#include "spice_ckt.h"
+#include "mxml.h"
+#include "MXMLUtil.h"
+
+
+namespace {
+
+  void ivs_put_uint(std::ofstream & out, unsigned int v)
+  { out.write(reinterpret_cast<const char *>(&v), sizeof(unsigned int)); }
+
+  void ivs_put_string(std::ofstream & out, const std::string & s)
+  {
+    ivs_put_uint(out, s.size());
+    out.write(s.c_str(), s.size());
+  }
+
+}
+
+
+/*----------------------------------------------------------------------
+ * constructor, open the file for writing
+ */
+IVStreamHook::IVStreamHook(SolverBase & solver, const std::string & name, void * param)
+    : Hook(solver, name), _ivs_file(SolverSpecify::out_prefix + ".ivs"), _mixA(false), _disabled(false),
+      _dom_compact(true), _block_rows(100), _n_rows(0)
+{
+  const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
+  for ( std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
+        parm_it != parm_list.end(); parm_it++ )
+  {
+    if ( parm_it->name() == "file" && parm_it->type() == Parser::STRING )
+      _ivs_file = parm_it->get_string();
+    if ( parm_it->name() == "flush" && parm_it->type() == Parser::REAL )
+      _block_rows = std::max(1, static_cast<int>(parm_it->get_real()));
+    if ( parm_it->name() == "dom.compact" && parm_it->type() == Parser::BOOL )
+      _dom_compact = parm_it->get_bool();
+  }
+
+  SolverSpecify::SolverType solver_type = this->get_solver().solver_type();
+
+  // if we are called by mixA solver?
+  if(solver_type == SolverSpecify::DDML1MIXA ||
+      solver_type == SolverSpecify::DDML2MIXA ||
+      solver_type == SolverSpecify::EBML3MIXA
+    )
+    _mixA = true;
+}
+
+
+/*----------------------------------------------------------------------
+ * destructor
+ */
+IVStreamHook::~IVStreamHook()
+{}
+
+
+/*----------------------------------------------------------------------
+ *   This is executed before the initialization of the solver
+ */
+void IVStreamHook::on_init()
+{
+  if( SolverSpecify::Type!=SolverSpecify::DCSWEEP &&
+      SolverSpecify::Type!=SolverSpecify::TRACE   &&
+      SolverSpecify::Type!=SolverSpecify::TRANSIENT )
+  {
+    MESSAGE<<"Warning: IV stream hook only supports DC sweep, trace and transient solver, ignored." << std::endl; RECORD();
+    _disabled = true;
+    return;
+  }
+
+  // only root processor do this command
+  if ( Genius::processor_id() ) return;
+
+  _columns.push_back( std::make_pair(std::string("step"), std::string("")) );
+
+  // if transient simulation, we need to record time
+  if ( SolverSpecify::Type == SolverSpecify::TRANSIENT )
+  {
+    _columns.push_back( std::make_pair(std::string("time"), std::string("s")) );
+    _columns.push_back( std::make_pair(std::string("time_step"), std::string("s")) );
+  }
+
+  if( _mixA )
+  {
+    const SPICE_CKT * spice_ckt = this->get_solver().get_system().get_circuit();
+    for(unsigned int n=0; n<spice_ckt->n_ckt_nodes(); n++)
+      _columns.push_back( std::make_pair(spice_ckt->ckt_node_name(n), std::string(spice_ckt->is_voltage_node(n) ? "V" : "A")) );
+  }
+  else
+  {
+    const BoundaryConditionCollector * bcs = this->get_solver().get_system().get_bcs();
+    for(unsigned int n=0; n<bcs->n_bcs(); n++)
+    {
+      const BoundaryCondition * bc = bcs->get_bc(n);
+
+      // electrode
+      if( bc->is_electrode() )
+      {
+        std::string bc_label = bc->label();
+        if(!bc->electrode_label().empty())
+          bc_label = bc->electrode_label();
+
+        _columns.push_back( std::make_pair(bc_label + "_Vapp", std::string("V")) );
+        _columns.push_back( std::make_pair(bc_label + "_potential", std::string("V")) );
+        _columns.push_back( std::make_pair(bc_label + "_current", std::string("A")) );
+
+        // charge flow out of the electrode since the beginning of transient
+        if ( SolverSpecify::Type == SolverSpecify::TRANSIENT )
+        {
+          _columns.push_back( std::make_pair(bc_label + "_charge", std::string("C")) );
+          _current_last.push_back( bc->ext_circuit()->current()/PhysicalUnit::A );
+          _charge.push_back(0.0);
+        }
+        continue;
+      }
+
+      if( bc->has_current_flow() )
+        _columns.push_back( std::make_pair(bc->label() + "_current", std::string("A")) );
+
+      if( bc->bc_type() == IF_Metal_Ohmic || bc->bc_type() == IF_Metal_Schottky)
+        _columns.push_back( std::make_pair(bc->label() + "_average_potential", std::string("V")) );
+
+      // charge integral interface
+      if( bc->bc_type() == ChargeIntegral )
+      {
+        _columns.push_back( std::make_pair(bc->label() + "_Q", std::string("C")) );
+        _columns.push_back( std::make_pair(bc->label() + "_potential", std::string("V")) );
+      }
+    }
+  }
+
+  _buffer.reserve( _block_rows*_columns.size() );
+
+  // write file head
+  _out.open(_ivs_file.c_str(), std::ios::binary | std::ios::trunc);
+  if( !_out.good() )
+  {
+    MESSAGE<<"Warning: IV stream hook can not open file " << _ivs_file << ", ignored." << std::endl; RECORD();
+    _disabled = true;
+    return;
+  }
+
+  _out.write("GIVS", 4);
+  ivs_put_uint(_out, 1);          // version
+  ivs_put_uint(_out, 0x01020304); // byte order marker
+  ivs_put_uint(_out, _columns.size());
+  for(unsigned int c=0; c<_columns.size(); c++)
+  {
+    ivs_put_string(_out, _columns[c].first);
+    ivs_put_string(_out, _columns[c].second);
+  }
+  _out.flush();
+}
+
+
+/*----------------------------------------------------------------------
+ *   This is executed previously to each solution step.
+ */
+void IVStreamHook::pre_solve()
+{}
+
+
+/*----------------------------------------------------------------------
+ *  This is executed after each solution step.
+ */
+void IVStreamHook::post_solve()
+{
+  if ( _disabled || Genius::processor_id() ) return;
+
+  _buffer.push_back( _n_rows );
+
+  if (SolverSpecify::Type == SolverSpecify::TRANSIENT)
+  {
+    _buffer.push_back( SolverSpecify::clock/PhysicalUnit::s );
+    _buffer.push_back( SolverSpecify::dt/PhysicalUnit::s );
+  }
+
+  if( _mixA )
+  {
+    const SPICE_CKT * spice_ckt = this->get_solver().get_system().get_circuit();
+    for(unsigned int n=0; n<spice_ckt->n_ckt_nodes(); n++)
+      _buffer.push_back( spice_ckt->get_solution(n) );
+  }
+  else
+  {
+    unsigned int e=0;
+    const BoundaryConditionCollector * bcs = this->get_solver().get_system().get_bcs();
+    for(unsigned int n=0; n<bcs->n_bcs(); n++)
+    {
+      const BoundaryCondition * bc = bcs->get_bc(n);
+
+      if( bc->is_electrode() )
+      {
+        double I = bc->ext_circuit()->current()/PhysicalUnit::A;
+        _buffer.push_back( bc->ext_circuit()->Vapp()/PhysicalUnit::V );
+        _buffer.push_back( bc->ext_circuit()->potential()/PhysicalUnit::V );
+        _buffer.push_back( I );
+
+        if ( SolverSpecify::Type == SolverSpecify::TRANSIENT )
+        {
+          // trapezoidal integral of electrode current
+          _charge[e] += 0.5*(I + _current_last[e])*SolverSpecify::dt/PhysicalUnit::s;
+          _current_last[e] = I;
+          _buffer.push_back( _charge[e] );
+          e++;
+        }
+        continue;
+      }
+
+      if( bc->has_current_flow() )
+        _buffer.push_back( bc->current()/PhysicalUnit::A );
+
+      if( bc->bc_type() == IF_Metal_Ohmic || bc->bc_type() == IF_Metal_Schottky)
+        _buffer.push_back( bc->psi()/PhysicalUnit::V );
+
+      if( bc->bc_type() == ChargeIntegral )
+      {
+        _buffer.push_back( bc->scalar("qf")/PhysicalUnit::C );
+        _buffer.push_back( bc->psi()/PhysicalUnit::V );
+      }
+    }
+  }
+
+  genius_assert( _buffer.size() % _columns.size() == 0 );
+
+  // keep only the index of this row in the solution DOM
+  mxml_node_t *eSolution = get_solver().current_dom_solution_elem();
+  if (eSolution)
+  {
+    if ( _dom_compact )
+    {
+      mxml_node_t *eTerm = mxmlFindElement(eSolution, eSolution, "terminal-info", NULL, NULL, MXML_DESCEND_FIRST);
+      if (eTerm) mxmlDelete(eTerm);
+    }
+
+    mxml_node_t *eOutput = mxmlFindElement(eSolution, eSolution, "output", NULL, NULL, MXML_DESCEND_FIRST);
+    mxml_node_t *eIVS    = mxmlNewElement(eOutput, "ivstream");
+    mxml_node_t *eFile   = mxmlNewElement(eIVS, "file");
+    mxmlAdd(eFile, MXML_ADD_AFTER, NULL, MXMLQVariant::makeQVString(_ivs_file));
+    mxml_node_t *eRow    = mxmlNewElement(eIVS, "row");
+    mxmlAdd(eRow, MXML_ADD_AFTER, NULL, MXMLQVariant::makeQVInt(static_cast<int>(_n_rows)));
+  }
+
+  _n_rows++;
+
+  if ( _buffer.size() >= _block_rows*_columns.size() )
+    _flush_block();
+}
+
+
+/*----------------------------------------------------------------------
+ *  This is executed after each (nonlinear) iteration
+ */
+void IVStreamHook::post_iteration()
+{}
+
+
+/*----------------------------------------------------------------------
+ * This is executed after the finalization of the solver
+ */
+void IVStreamHook::on_close()
+{
+  if ( _disabled || Genius::processor_id() ) return;
+
+  _flush_block();
+  _out.close();
+}
+
+
+void IVStreamHook::_flush_block()
+{
+  if ( _buffer.empty() ) return;
+
+  const unsigned int n_columns = _columns.size();
+  const unsigned int n_rows = _buffer.size()/n_columns;
+
+  // transpose to column major
+  std::vector<double> block(_buffer.size());
+  for(unsigned int r=0; r<n_rows; r++)
+    for(unsigned int c=0; c<n_columns; c++)
+      block[c*n_rows + r] = _buffer[r*n_columns + c];
+
+  ivs_put_uint(_out, n_rows);
+  _out.write(reinterpret_cast<const char *>(&block[0]), sizeof(double)*block.size());
+  // the trailing row count commits this block
+  ivs_put_uint(_out, n_rows);
+  _out.flush();
+
+  _buffer.clear();
+}
+
+
+#ifdef DLLHOOK
+
+// dll interface
+extern "C"
+{
+  Hook* get_hook ( SolverBase & solver, const std::string & name, void * fun_data )
+  {
+    return new IVStreamHook ( solver, name, fun_data );
+  }
+
+}
+
+#endif
@@ -23,9 +23,15 @@
 #include <cstdlib>
 #include <ctime>
 #include <iomanip>
+#include <sstream>
 
 #include "solver_base.h"
 #include "probe_hook.h"
+#include "mesh_base.h"
+#include "elem.h"
+#include "point_locator_base.h"
+#include "fe_type.h"
+#include "fe_interface.h"
 #include "parallel.h"
 
 
@@ -33,29 +39,45 @@
  * constructor, open the file for writing
  */
 ProbeHook::ProbeHook(SolverBase & solver, const std::string & name, void * param)
-    : Hook(solver, name), _probe_file(SolverSpecify::out_prefix + ".probe")
+    : Hook(solver, name), _n_samples(0), _format(GNUPLOT), _probe_file(SolverSpecify::out_prefix + ".probe")
 {
   _p_solver = & solver;
-  _p_fvm_node   = NULL;
-  _min_loc = invalid_uint;
+
+  Point pp;
+  bool single_point = false;
 
   const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
   for(std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
       parm_it != parm_list.end(); parm_it++)
   {
     if(parm_it->name() == "x" && parm_it->type() == Parser::REAL)
-      _pp(0)=parm_it->get_real() * PhysicalUnit::um;
+    { pp(0)=parm_it->get_real() * PhysicalUnit::um; single_point = true; }
     if(parm_it->name() == "y" && parm_it->type() == Parser::REAL)
-      _pp(1)=parm_it->get_real() * PhysicalUnit::um;
+    { pp(1)=parm_it->get_real() * PhysicalUnit::um; single_point = true; }
     if(parm_it->name() == "z" && parm_it->type() == Parser::REAL)
-      _pp(2)=parm_it->get_real() * PhysicalUnit::um;
+    { pp(2)=parm_it->get_real() * PhysicalUnit::um; single_point = true; }
     if(parm_it->name() == "file" && parm_it->type() == Parser::STRING)
       _probe_file = parm_it->get_string();
+    if(parm_it->name() == "points" && parm_it->type() == Parser::STRING)
+      _load_points(parm_it->get_string());
+    if(parm_it->name() == "format" && parm_it->type() == Parser::STRING)
+    {
+      if(parm_it->get_string() == "csv")    _format = CSV;
+      if(parm_it->get_string() == "binary") _format = BINARY;
+    }
   }
 
+  // keep the single point defined by x/y/z, also the default when nothing given
+  if( single_point || _points.empty() )
+  {
+    ProbePoint point;
+    point.p = pp;
+    point.label = "probe";
+    _points.insert(_points.begin(), point);
+  }
 
   if ( !Genius::processor_id() )
-    _out.open(_probe_file.c_str());
+    _out.open(_probe_file.c_str(), _format == BINARY ? std::ios::out | std::ios::binary : std::ios::out);
 
 }
 
@@ -71,116 +93,224 @@ ProbeHook::~ProbeHook()
 
 
 /*----------------------------------------------------------------------
- *   This is executed before the initialization of the solver
+ * read "x y z [label]" lines, '#' for comment
  */
-void ProbeHook::on_init()
+void ProbeHook::_load_points(const std::string & file)
 {
+  // read on processor 0 and broadcast, the file may not be visible to others
+  std::vector<double> coords;
+  std::vector<std::string> labels;
 
-  double min_dis = 1e100;
-  for( unsigned int r=0; r<_p_solver->get_system().n_regions(); r++)
+  if ( !Genius::processor_id() )
   {
-    const SimulationRegion * region = _p_solver->get_system().region(r);
-
-    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
-    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
-    for(; node_it!=node_it_end; ++node_it)
+    std::ifstream in(file.c_str());
+    if(!in.good())
     {
-      const FVM_Node * fvm_node = *node_it;
-      const Node * node = fvm_node->root_node();
+      MESSAGE<<"WARNING: Probe points file " << file << " can not be opened." << std::endl; RECORD();
+    }
 
-      double dis = ((*node)-_pp).size();
-      if(dis<min_dis)
+    std::string line;
+    while( std::getline(in, line) )
+    {
+      if( line.empty() || line[0] == '#' ) continue;
+      std::istringstream ss(line);
+      double x=0, y=0, z=0;
+      std::string label;
+      if( !(ss >> x >> y) ) continue;
+      ss >> z;
+      if( !(ss >> label) )
       {
-        min_dis = dis;
-        _p_fvm_node = fvm_node;
+        std::ostringstream ls;
+        ls << "p" << labels.size();
+        label = ls.str();
       }
+      coords.push_back(x);
+      coords.push_back(y);
+      coords.push_back(z);
+      labels.push_back(label);
     }
   }
 
-  // after this call, the _min_loc contains processor_id with minimal min_dis
-  Parallel::min_loc(min_dis, _min_loc);
+  Parallel::broadcast(coords, 0);
+  unsigned int n_points = labels.size();
+  Parallel::broadcast(n_points, 0);
+  labels.resize(n_points);
+  for(unsigned int n=0; n<n_points; ++n)
+    Parallel::broadcast(labels[n], 0);
 
-  double x,y,z;
-  std::string region;
-  std::vector<std::string> var_name;
-  int n_var;
+  for(unsigned int n=0; n<n_points; ++n)
+  {
+    ProbePoint point;
+    point.p = Point(coords[3*n]*PhysicalUnit::um, coords[3*n+1]*PhysicalUnit::um, coords[3*n+2]*PhysicalUnit::um);
+    point.label = labels[n];
+    _points.push_back(point);
+  }
+}
 
-  x = (*_p_fvm_node->root_node())(0);
-  y = (*_p_fvm_node->root_node())(1);
-  z = (*_p_fvm_node->root_node())(2);
-  region = _p_solver->get_system().region(_p_fvm_node->subdomain_id())->label();
-  Parallel::broadcast(x, _min_loc);
-  Parallel::broadcast(y, _min_loc);
-  Parallel::broadcast(z, _min_loc);
-  Parallel::broadcast(region, _min_loc);
 
-  if (Genius::processor_id() == _min_loc)
-  {
-    const FVM_NodeData * node_data = _p_fvm_node->node_data();
-    switch (node_data->type())
-    {
-      case FVM_NodeData::SemiconductorData:
-        n_var = 3;
-        var_name.push_back("psi [V]");
-        var_name.push_back("n [cm^-3]");
-        var_name.push_back("p [cm^-3]");
-        break;
-      case FVM_NodeData::InsulatorData:
-      case FVM_NodeData::ConductorData:
-      case FVM_NodeData::ResistanceData:
-        n_var = 1;
-        var_name.push_back("psi [V]");
-        break;
-      default:
-        n_var = 0;
-    }
+unsigned int ProbeHook::_n_variables(int r) const
+{
+  if( r < 0 ) return 0;
 
+  switch( _p_solver->get_system().region(r)->type() )
+  {
+    case SemiconductorRegion : return 3;
+    case InsulatorRegion     :
+    case ElectrodeRegion     :
+    case MetalRegion         : return 1;
+    default                  : return 0;
   }
+}
 
-  Parallel::broadcast(n_var, _min_loc);
-  var_name.resize(n_var);
-  for(int i=0; i<n_var; i++)
-    Parallel::broadcast(var_name[i], _min_loc);
 
-  if ( !Genius::processor_id() )
+/*----------------------------------------------------------------------
+ *   This is executed before the initialization of the solver
+ */
+void ProbeHook::on_init()
+{
+  const SimulationSystem & system = _p_solver->get_system();
+  const MeshBase & mesh = system.mesh();
+  // own locator, points outside the device should not stop the simulation
+  AutoPtr<PointLocatorBase> locator = PointLocatorBase::build(PointLocator_TREE, mesh);
+  locator->enable_out_of_mesh_mode();
+
+  FEType fe_type;
+
+  // locate the points once, the processor owns the element does the interpolation
+  std::vector<int> point_region(_points.size(), -1);
+  for(unsigned int n=0; n<_points.size(); ++n)
   {
-    time_t          _time;
-    time(&_time);
-
-    _out << "# Title: Gnuplot File Created by Genius TCAD Simulation" << std::endl;
-    _out << "# Date: " << ctime(&_time) << std::endl;
-    _out << "# Plotname: Probe"  << std::endl;
-    _out << "# Node location (um): ";
-    _out << "x=" << x/PhysicalUnit::um << "\ty=" << y/PhysicalUnit::um << "\tz=" << z/PhysicalUnit::um << std::endl;
-    _out << "# Node in region: " << region << std::endl;
-    _out << "# Variables: " << std::endl;
-    int cCnt=0;
-
-    // DC Sweep
-    if( SolverSpecify::Type==SolverSpecify::DCSWEEP || SolverSpecify::Type==SolverSpecify::TRACE)
+    ProbePoint & point = _points[n];
+    point.nodes.clear();
+    point.weights.clear();
+
+    const Elem * elem = (*locator)(point.p);
+    if( !elem || elem->processor_id() != Genius::processor_id() ) continue;
+
+    const SimulationRegion * region = system.region(elem->subdomain_id());
+    const Point ref = FEInterface::inverse_map(elem->dim(), fe_type, elem, point.p);
+
+    // nodes without FVM node are dropped, the weights of the others are renormalized
+    Real weight_sum = 0.0;
+    const FVM_Node * nearest_node = NULL;
+    Real nearest_distance = 0.0;
+    for(unsigned int i=0; i<elem->n_nodes(); ++i)
     {
-      if ( SolverSpecify::Electrode_VScan.size() )
-        for(unsigned int n=0; n<SolverSpecify::Electrode_VScan.size(); ++n)
-          _out << '#' << std::setw(10) << ++cCnt << std::setw(20) << SolverSpecify::Electrode_VScan[n]  << " [V]"<< std::endl;
+      const FVM_Node * fvm_node = region->region_fvm_node(elem->get_node(i));
+      if( !fvm_node ) continue;
+
+      const Real w = FEInterface::shape(elem->dim(), fe_type, elem, i, ref);
+      point.nodes.push_back(fvm_node);
+      point.weights.push_back(w);
+      weight_sum += w;
 
-      if ( SolverSpecify::Electrode_IScan.size() )
-        for(unsigned int n=0; n<SolverSpecify::Electrode_IScan.size(); ++n)
-          _out << '#' << std::setw(10) << ++cCnt << std::setw(20) << SolverSpecify::Electrode_IScan[n]  << " [A]"<< std::endl;
+      const Real distance = (*elem->get_node(i) - point.p).size();
+      if( !nearest_node || distance < nearest_distance )
+      {
+        nearest_node = fvm_node;
+        nearest_distance = distance;
+      }
     }
+    if( !nearest_node ) continue;
 
-    // Transient
-    if(SolverSpecify::Type==SolverSpecify::TRANSIENT)
+    if( weight_sum > 1e-3 )
     {
-      _out << '#' << std::setw(10) << ++cCnt << std::setw(20) << "Time [s]"  << std::endl;
+      for(unsigned int i=0; i<point.weights.size(); ++i)
+        point.weights[i] /= weight_sum;
     }
+    else
+    {
+      // the point is next to the dropped nodes, take the nearest valid one
+      point.nodes.assign(1, nearest_node);
+      point.weights.assign(1, 1.0);
+    }
+    point_region[n] = elem->subdomain_id();
+  }
+
+  // each point is owned by only one processor
+  Parallel::max(point_region);
+
+  _n_samples = 0;
+  for(unsigned int n=0; n<_points.size(); ++n)
+  {
+    _points[n].region = point_region[n];
+    _points[n].column = _n_samples;
+    _n_samples += _n_variables(point_region[n]);
+  }
+
+  if ( Genius::processor_id() ) return;
 
-    for(int i=0; i<n_var; i++)
+  std::vector<std::string> columns;
+
+  // DC Sweep
+  if( SolverSpecify::Type==SolverSpecify::DCSWEEP || SolverSpecify::Type==SolverSpecify::TRACE)
+  {
+    for(unsigned int n=0; n<SolverSpecify::Electrode_VScan.size(); ++n)
+      columns.push_back(SolverSpecify::Electrode_VScan[n] + " [V]");
+    for(unsigned int n=0; n<SolverSpecify::Electrode_IScan.size(); ++n)
+      columns.push_back(SolverSpecify::Electrode_IScan[n] + " [A]");
+  }
+
+  // Transient
+  if(SolverSpecify::Type==SolverSpecify::TRANSIENT)
+    columns.push_back("Time [s]");
+
+  for(unsigned int n=0; n<_points.size(); ++n)
+  {
+    const ProbePoint & point = _points[n];
+    if( point.region < 0 )
     {
-      _out << '#' << std::setw(10) << ++cCnt << std::setw(20) << var_name[i]  << std::endl;
+      MESSAGE<<"WARNING: Probe point " << point.label << " is outside the device, ignored." << std::endl; RECORD();
+      continue;
+    }
+    columns.push_back(point.label + ".psi [V]");
+    if( _n_variables(point.region) == 3 )
+    {
+      columns.push_back(point.label + ".n [cm^-3]");
+      columns.push_back(point.label + ".p [cm^-3]");
     }
-    _out << std::endl;
   }
 
+  switch(_format)
+  {
+    case CSV:
+    {
+      for(unsigned int c=0; c<columns.size(); ++c)
+        _out << (c ? "," : "") << '"' << columns[c] << '"';
+      _out << std::endl;
+      break;
+    }
+    case BINARY:
+    {
+      // one header line: number of columns followed by tab separated names
+      _out << "GeniusProbe " << columns.size();
+      for(unsigned int c=0; c<columns.size(); ++c)
+        _out << '\t' << columns[c];
+      _out << '\n';
+      break;
+    }
+    default:
+    {
+      time_t          _time;
+      time(&_time);
+
+      _out << "# Title: Gnuplot File Created by Genius TCAD Simulation" << std::endl;
+      _out << "# Date: " << ctime(&_time) << std::endl;
+      _out << "# Plotname: Probe"  << std::endl;
+      for(unsigned int n=0; n<_points.size(); ++n)
+      {
+        if( _points[n].region < 0 ) continue;
+        _out << "# Probe " << _points[n].label << " location (um): ";
+        _out << "x=" << _points[n].p(0)/PhysicalUnit::um << "\ty=" << _points[n].p(1)/PhysicalUnit::um << "\tz=" << _points[n].p(2)/PhysicalUnit::um;
+        _out << "\tregion: " << system.region(_points[n].region)->label() << std::endl;
+      }
+      _out << "# Variables: " << std::endl;
+      for(unsigned int c=0; c<columns.size(); ++c)
+        _out << '#' << std::setw(10) << c+1 << std::setw(20) << columns[c] << std::endl;
+      _out << std::endl;
+    }
+  }
+  _out.flush();
 }
 
 /*----------------------------------------------------------------------
@@ -196,73 +326,88 @@ void ProbeHook::pre_solve()
  */
 void ProbeHook::post_solve()
 {
-  int n_var;
-  std::vector<double> var;
-  if (Genius::processor_id() == _min_loc)
+  // interpolate the points owned by this processor, others are zero
+  std::vector<double> samples(_n_samples, 0.0);
+  for(unsigned int n=0; n<_points.size(); ++n)
   {
-    const FVM_NodeData * node_data = _p_fvm_node->node_data();
-    switch (node_data->type())
+    const ProbePoint & point = _points[n];
+    if( point.nodes.empty() ) continue;
+
+    const bool semiconductor = _n_variables(point.region) == 3;
+    for(unsigned int i=0; i<point.nodes.size(); ++i)
     {
-      case FVM_NodeData::SemiconductorData:
-        n_var = 3;
-        var.push_back(node_data->psi()/PhysicalUnit::V);
-        var.push_back(node_data->n()/std::pow(PhysicalUnit::cm, -3));
-        var.push_back(node_data->p()/std::pow(PhysicalUnit::cm, -3));
-        break;
-      case FVM_NodeData::InsulatorData:
-      case FVM_NodeData::ConductorData:
-      case FVM_NodeData::ResistanceData:
-        n_var = 1;
-        var.push_back(node_data->psi()/PhysicalUnit::V);
-        break;
-      default:
-        n_var = 0;
+      const FVM_NodeData * node_data = point.nodes[i]->node_data();
+      const Real w = point.weights[i];
+      samples[point.column] += w*node_data->psi()/PhysicalUnit::V;
+      if( semiconductor )
+      {
+        samples[point.column+1] += w*node_data->n()/std::pow(PhysicalUnit::cm, -3);
+        samples[point.column+2] += w*node_data->p()/std::pow(PhysicalUnit::cm, -3);
+      }
     }
   }
 
-  Parallel::broadcast(n_var,_min_loc);
-  if(n_var)
-    Parallel::broadcast(var,_min_loc);
+  // the only collective of this step
+  Parallel::sum(samples);
 
-  if ( !Genius::processor_id() )
+  if ( Genius::processor_id() ) return;
+
+  std::vector<double> row;
+
+  // DC Sweep
+  if( SolverSpecify::Type==SolverSpecify::DCSWEEP || SolverSpecify::Type==SolverSpecify::TRACE )
   {
-    // set the float number precision
-    _out.precision(6);
+    const BoundaryConditionCollector * bcs = this->get_solver().get_system().get_bcs();
 
-    // set output width and format
-    _out<< std::scientific << std::right;
+    for(unsigned int n=0; n<SolverSpecify::Electrode_VScan.size(); ++n)
+      row.push_back(bcs->get_bc(SolverSpecify::Electrode_VScan[n])->ext_circuit()->Vapp()/PhysicalUnit::V);
 
-    _out<<' ';
+    for(unsigned int n=0; n<SolverSpecify::Electrode_IScan.size(); ++n)
+      row.push_back(bcs->get_bc(SolverSpecify::Electrode_IScan[n])->ext_circuit()->Iapp()/PhysicalUnit::A);
+  }
 
-    // DC Sweep
-    if( SolverSpecify::Type==SolverSpecify::DCSWEEP || SolverSpecify::Type==SolverSpecify::TRACE )
-    {
-      const BoundaryConditionCollector * bcs = this->get_solver().get_system().get_bcs();
+  if(SolverSpecify::Type==SolverSpecify::TRANSIENT)
+    row.push_back(SolverSpecify::clock/PhysicalUnit::s);
 
-      if ( SolverSpecify::Electrode_VScan.size() )
-        for(unsigned int n=0; n<SolverSpecify::Electrode_VScan.size(); ++n)
-      {
-        const BoundaryCondition * bc = bcs->get_bc(SolverSpecify::Electrode_VScan[n]);
-        _out << std::setw(20) << bc->ext_circuit()->Vapp()/PhysicalUnit::V;
-      }
+  row.insert(row.end(), samples.begin(), samples.end());
+
+  _write_row(row);
+}
 
-      if ( SolverSpecify::Electrode_IScan.size() )
-        for(unsigned int n=0; n<SolverSpecify::Electrode_IScan.size(); ++n)
-      {
-        const BoundaryCondition * bc = bcs->get_bc(SolverSpecify::Electrode_IScan[n]);
-        _out << std::setw(20) << bc->ext_circuit()->Iapp()/PhysicalUnit::A;
-      }
-    }
 
-    if(SolverSpecify::Type==SolverSpecify::TRANSIENT)
+void ProbeHook::_write_row(const std::vector<double> & row)
+{
+  switch(_format)
+  {
+    case CSV:
     {
-      _out << std::setw(15) << SolverSpecify::clock/PhysicalUnit::s;
+      _out.precision(8);
+      _out << std::scientific;
+      for(unsigned int c=0; c<row.size(); ++c)
+        _out << (c ? "," : "") << row[c];
+      _out << std::endl;
+      break;
     }
+    case BINARY:
+    {
+      if(!row.empty())
+        _out.write(reinterpret_cast<const char *>(&row[0]), row.size()*sizeof(double));
+      _out.flush();
+      break;
+    }
+    default:
+    {
+      // set the float number precision
+      _out.precision(6);
 
-    for(unsigned int i=0; i<var.size(); i++)
-      _out << std::setw(15) << var[i];
+      // set output width and format
+      _out<< std::scientific << std::right;
 
-    _out << std::endl;
+      _out<<' ';
+      for(unsigned int c=0; c<row.size(); ++c)
+        _out << std::setw(15) << row[c];
+      _out << std::endl;
+    }
   }
 }
 
@@ -296,4 +441,3 @@ extern "C"
 }
 
 #endif
-
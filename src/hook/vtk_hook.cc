@@ -26,14 +26,15 @@
 #include "vtk_hook.h"
 #include "spice_ckt.h"
 #include "MXMLUtil.h"
+#include "async_writer.h"
 
 
 /*----------------------------------------------------------------------
  * constructor, open the file for writing
  */
 VTKHook::VTKHook ( SolverBase & solver, const std::string & name, void * param)
-    : Hook ( solver, name ), _vtk_prefix ( SolverSpecify::out_prefix ),
-      _ddm ( false ), _mixA ( false ), _ddm_ac ( false )
+    : Hook ( solver, name ), _vtk_prefix ( SolverSpecify::out_prefix ), _vtk_suffix ( ".vtu" ),
+      _ddm ( false ), _mixA ( false ), _ddm_ac ( false ), _async ( true )
 {
   this->count  =0;
   this->_t_step=0;
@@ -55,13 +56,19 @@ VTKHook::VTKHook ( SolverBase & solver, const std::string & name, void * param)
       _v_step=parm_it->get_real() * PhysicalUnit::V;
     if ( parm_it->name() == "istep" && parm_it->type() == Parser::REAL )
       _i_step=parm_it->get_real() * PhysicalUnit::A;
+    if ( parm_it->name() == "async" && parm_it->type() == Parser::BOOL )
+      _async=parm_it->get_bool();
+    if ( parm_it->name() == "parallel" && parm_it->type() == Parser::BOOL )
+      _vtk_suffix = parm_it->get_bool() ? ".pvtu" : ".vtu";
+    if ( parm_it->name() == "async.buffer" && parm_it->type() == Parser::REAL )
+      AsyncWriter::instance().set_max_pending_memory( static_cast<size_t>(parm_it->get_real()*1024*1024) );
   }
 
   const SimulationSystem &system = get_solver().get_system();
 
   std::ostringstream vtk_filename;
-  vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-  system.export_vtk ( vtk_filename.str(), false );
+  vtk_filename << _vtk_prefix << ( this->count++ ) << _vtk_suffix;
+  system.export_vtk ( vtk_filename.str(), false, _async );
 
   SolverSpecify::SolverType solver_type = this->get_solver().solver_type();
 
@@ -136,8 +143,8 @@ void VTKHook::post_solve()
     {
       const SimulationSystem &system = get_solver().get_system();
 
-      vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-      system.export_vtk ( vtk_filename.str(),false );
+      vtk_filename << _vtk_prefix << ( this->count++ ) << _vtk_suffix;
+      system.export_vtk ( vtk_filename.str(), false, _async );
 
       time_sequence.push_back ( std::make_pair ( Vscan/PhysicalUnit::V, vtk_filename.str() ) );
       _v_last = Vscan;
@@ -167,8 +174,8 @@ void VTKHook::post_solve()
     {
       const SimulationSystem &system = get_solver().get_system();
 
-      vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-      system.export_vtk ( vtk_filename.str(),false );
+      vtk_filename << _vtk_prefix << ( this->count++ ) << _vtk_suffix;
+      system.export_vtk ( vtk_filename.str(), false, _async );
 
       time_sequence.push_back ( std::make_pair ( Iscan/PhysicalUnit::A, vtk_filename.str() ) );
       _i_last = Iscan;
@@ -180,16 +187,16 @@ void VTKHook::post_solve()
   {
     const SimulationSystem &system = get_solver().get_system();
 
-    vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-    system.export_vtk ( vtk_filename.str(), false );
+    vtk_filename << _vtk_prefix << ( this->count++ ) << _vtk_suffix;
+    system.export_vtk ( vtk_filename.str(), false, _async );
   }
 
   if ( SolverSpecify::Type==SolverSpecify::TRACE )
   {
     const SimulationSystem &system = get_solver().get_system();
 
-    vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-    system.export_vtk ( vtk_filename.str(), false );
+    vtk_filename << _vtk_prefix << ( this->count++ ) << _vtk_suffix;
+    system.export_vtk ( vtk_filename.str(), false, _async );
   }
 
   if ( SolverSpecify::Type==SolverSpecify::TRANSIENT )
@@ -198,8 +205,8 @@ void VTKHook::post_solve()
     {
       const SimulationSystem &system = get_solver().get_system();
 
-      vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-      system.export_vtk ( vtk_filename.str(), false );
+      vtk_filename << _vtk_prefix << ( this->count++ ) << _vtk_suffix;
+      system.export_vtk ( vtk_filename.str(), false, _async );
 
       time_sequence.push_back ( std::make_pair ( SolverSpecify::clock/PhysicalUnit::ps, vtk_filename.str() ) );
       _t_last = SolverSpecify::clock;
@@ -212,8 +219,8 @@ void VTKHook::post_solve()
   {
     const SimulationSystem &system = get_solver().get_system();
 
-    vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-    system.export_vtk ( vtk_filename.str(), false );
+    vtk_filename << _vtk_prefix << ( this->count++ ) << _vtk_suffix;
+    system.export_vtk ( vtk_filename.str(), false, _async );
 
     time_sequence.push_back ( std::make_pair ( SolverSpecify::Freq*PhysicalUnit::us, vtk_filename.str() ) );
     _f_last = SolverSpecify::Freq;
@@ -224,8 +231,8 @@ void VTKHook::post_solve()
   {
     const SimulationSystem &system = get_solver().get_system();
 
-    vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-    system.export_vtk ( vtk_filename.str(),false );
+    vtk_filename << _vtk_prefix << ( this->count++ ) << _vtk_suffix;
+    system.export_vtk ( vtk_filename.str(), false, _async );
   }
   */
 
@@ -258,6 +265,9 @@ void VTKHook::post_iteration()
  */
 void VTKHook::on_close()
 {
+  // make sure all the snapshots are on disk
+  AsyncWriter::instance().flush();
+
   if ( time_sequence.size() ==0 ) return;
 
   if ( !Genius::processor_id() )
@@ -139,3 +139,39 @@ double Interpolation2D_CSA::get_interpolated_value(const Point & point, int grou
   return pout.z;
 }
 
+
+
+void Interpolation2D_CSA::get_interpolated_values(const std::vector<Point> & points, int group, std::vector<double> & values) const
+{
+  values.resize(points.size());
+  if(points.empty()) return;
+
+  CSA::csa * field = field_map.find(group)->second;
+
+  std::vector<unsigned int> order;
+  spatial_order(points, order);
+
+  std::vector<CSA::point> pout(points.size());
+  for(unsigned int n=0; n<order.size(); ++n)
+  {
+    pout[n].x = points[order[n]].x();
+    pout[n].y = points[order[n]].y();
+  }
+  CSA::csa_approximatepoints(field, pout.size(), &pout[0]);
+
+  InterpolationType type = _interpolation_type.find(group)->second;
+  double vmin = field_limit.find(group)->second.first;
+  double vmax = field_limit.find(group)->second.second;
+
+  for(unsigned int n=0; n<order.size(); ++n)
+  {
+    double z = unscaleValue(type, pout[n].z);
+    if(z<vmin) z = vmin;
+    if(z>vmax) z = vmax;
+    values[order[n]] = z;
+  }
+
+#if defined(HAVE_FENV_H) && defined(DEBUG)
+  feclearexcept(FE_INVALID);
+#endif
+}
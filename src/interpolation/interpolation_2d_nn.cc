@@ -4,6 +4,7 @@
 #include "genius_common.h"
 #include "asinh.hpp"
 #include "interpolation_2d_nn.h"
+#include "delaunay.h"
 #include "parallel.h"
 
 #include "log.h"
@@ -23,8 +24,10 @@ void Interpolation2D_NN::clear()
   std::map<int, DATA>::iterator it=field.begin();
   for(; it!=field.end(); ++it)
   {
-    NN::delaunay_destroy( it->second.d );
-    NN::lpi_destroy(it->second.li);
+    if( it->second.d && !it->second.shared_d )
+      NN::delaunay_destroy( it->second.d );
+    if( it->second.li )
+      NN::lpi_destroy(it->second.li);
   }
   field.clear();
 }
@@ -53,6 +56,25 @@ void Interpolation2D_NN::add_scatter_data(const Point & point, int group, double
 void Interpolation2D_NN::setup(int group)
 {
   DATA & data = field[group];
+
+  // groups (i.e. Na, Nd and mole fraction) loaded from the same file share the scatter points,
+  // reuse the delaunay diagram already built. lpi only takes the values from it at build time
+  std::map<int, DATA>::iterator it=field.begin();
+  for(; it!=field.end(); ++it)
+  {
+    const DATA & other = it->second;
+    if( it->first == group || !other.d || other.shared_d ) continue;
+    if( other.x == data.x && other.y == data.y )
+    {
+      data.d = other.d;
+      data.shared_d = true;
+      for( unsigned int i=0; i<data.n; ++i )
+        data.d->points[i].z = data.f[i];
+      data.li = NN::lpi_build(data.d);
+      return;
+    }
+  }
+
   std::vector<NN::point> points;
   for( unsigned int i=0; i<data.n; ++i )
   {
@@ -60,6 +82,7 @@ void Interpolation2D_NN::setup(int group)
     points.push_back(p);
   }
   data.d = NN::delaunay_build(data.n, &points[0], 0, 0, 0, 0 );
+  data.shared_d = false;
   data.li = NN::lpi_build(data.d);
 }
 
@@ -91,3 +114,22 @@ double Interpolation2D_NN::get_interpolated_value(const Point & point, int group
   return p.z;
 }
 
+
+
+void Interpolation2D_NN::get_interpolated_values(const std::vector<Point> & points, int group, std::vector<double> & values) const
+{
+  const DATA & data = field.find(group)->second;
+
+  // the triangle walk starts from the last found one, spatial order keeps it short
+  std::vector<unsigned int> order;
+  spatial_order(points, order);
+
+  values.resize(points.size());
+  for(unsigned int n=0; n<order.size(); ++n)
+  {
+    const Point & point = points[order[n]];
+    NN::point  p = { point.x(), point.y(), 0 };
+    NN::lpi_interpolate_point(data.li, &p);
+    values[order[n]] = p.z;
+  }
+}
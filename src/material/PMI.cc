@@ -103,6 +103,41 @@ PetscScalar PMI_Server::ReadRealVariable (const std::string & v) const
 }
 
 
+/**
+ * register a per-node constant coefficient
+ */
+unsigned int PMI_Server::RegisterNodeCoefficient(const std::string & name)
+{
+  _node_coefficient_names.push_back(name);
+  _node_coefficient_index.push_back(invalid_uint);
+  return _node_coefficient_names.size()-1;
+}
+
+
+/**
+ * set the variable index of per-node coefficient
+ */
+void PMI_Server::set_node_coefficient_index(const unsigned int i, const unsigned int index, const DataStorage * storage)
+{
+  _node_coefficient_index[i] = index;
+  _node_coefficient_storage = storage;
+}
+
+
+/**
+ * read the prepared coefficient of current node
+ */
+bool PMI_Server::ReadNodeCoefficient(const unsigned int i, PetscScalar & value) const
+{
+  // the node should belong to the region which coefficients are prepared for
+  if( !pp_node_data || !(*pp_node_data) ) return false;
+  if( _node_coefficient_index[i] == invalid_uint || (*pp_node_data)->data_storage() != _node_coefficient_storage ) return false;
+
+  value = (*pp_node_data)->data<Real>(_node_coefficient_index[i]);
+  return true;
+}
+
+
 #ifdef   __CALIBRATE__
 
 /**
@@ -234,7 +269,8 @@ std::string PMI_Server::get_parameter_string(const int verbosity)
  * also set the physical constants
  */
 PMI_Server::PMI_Server(const PMI_Environment &env)
-  : pp_variables(env.pp_variables), pp_point(env.pp_point), pp_node_data(env.pp_node_data), p_clock(env.p_clock)
+  : pp_variables(env.pp_variables), pp_point(env.pp_point), pp_node_data(env.pp_node_data), p_clock(env.p_clock),
+    _node_coefficient_storage(0)
 {
 
   m  = env.m;
@@ -243,6 +279,9 @@ PMI_Server::PMI_Server(const PMI_Environment &env)
   C  = env.C;
   K  = env.K;
 
+  // the material library may hold its own copy of the tables
+  FunctionTable::default_tolerance() = env.table_tol;
+
   cm = 1e-2*m;
   um = 1e-4*cm;
   J  = C*V;
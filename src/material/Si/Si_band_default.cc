@@ -103,8 +103,8 @@ public:
   }
 
   //---------------------------------------------------------------------------
-  // procedure of Bandgap Narrowing due to Heavy Doping
-  PetscScalar EgNarrow(const PetscScalar &p, const PetscScalar &n, const PetscScalar &Tl)
+  // procedure of Bandgap Narrowing due to Heavy Doping, only depends on doping
+  PetscScalar EgNarrowDoping() const
   {
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
@@ -112,16 +112,29 @@ public:
     PetscScalar x = log(N/N0_BGN);
     return V0_BGN*(x+sqrt(x*x+CON_BGN));
   }
+
+  // the index of prepared bandgap narrowing
+  unsigned int BGN_Coefficient;
+
+  void prepare_node(std::vector<PetscScalar> & coefficients)
+  {
+    coefficients[BGN_Coefficient] = EgNarrowDoping();
+  }
+
+  PetscScalar EgNarrow(const PetscScalar &p, const PetscScalar &n, const PetscScalar &Tl)
+  {
+    PetscScalar bgn;
+    if( ReadNodeCoefficient(BGN_Coefficient, bgn) ) return bgn;
+    return EgNarrowDoping();
+  }
   PetscScalar EgNarrowToEc   (const PetscScalar &p, const PetscScalar &n, const PetscScalar &Tl){return 0.5*EgNarrow(p, n, Tl);}
   PetscScalar EgNarrowToEv   (const PetscScalar &p, const PetscScalar &n, const PetscScalar &Tl){return 0.5*EgNarrow(p, n, Tl);}
 
   AutoDScalar EgNarrow(const AutoDScalar &p, const AutoDScalar &n, const AutoDScalar &Tl)
   {
-    PetscScalar Na = ReadDopingNa();
-    PetscScalar Nd = ReadDopingNd();
-    PetscScalar N = Na+Nd+1.0*std::pow(cm,-3);
-    PetscScalar x = log(N/N0_BGN);
-    return V0_BGN*(x+sqrt(x*x+CON_BGN));
+    PetscScalar bgn;
+    if( ReadNodeCoefficient(BGN_Coefficient, bgn) ) return bgn;
+    return EgNarrowDoping();
   }
   AutoDScalar EgNarrowToEc   (const AutoDScalar &p, const AutoDScalar &n, const AutoDScalar &Tl){return 0.5*EgNarrow(p, n, Tl);}
   AutoDScalar EgNarrowToEv   (const AutoDScalar &p, const AutoDScalar &n, const AutoDScalar &Tl){return 0.5*EgNarrow(p, n, Tl);}
@@ -1073,6 +1086,7 @@ public:
     T300 = 300.0*K;
     PMI_Info = "This is the Default model for band structure parameters of Silicon";
     Eg_Init();
+    BGN_Coefficient = RegisterNodeCoefficient("BGN");
     IncompleteIonization_Init();
     Lifetime_Init();
     Recomb_Init();
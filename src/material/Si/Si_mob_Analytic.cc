@@ -93,38 +93,65 @@ private:
   }
 
 private:
+  // the index of prepared doping terms
+  unsigned int DopingN_Coefficient;
+  unsigned int DopingP_Coefficient;
+
   //---------------------------------------------------------------------------
-  // Electron low field mobility
-  PetscScalar ElecMobLowField(const PetscScalar &Tl) const
+  // doping terms of low field mobility
+  PetscScalar ElecDopingTerm() const
   {
+    PetscScalar N;
+    if( ReadNodeCoefficient(DopingN_Coefficient, N) ) return N;
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
-    return MUN_MIN+(MUN_MAX*std::pow(Tl/T300,NUN)-MUN_MIN)/ \
-           (1+std::pow(Tl/T300,XIN)*std::pow((Na+Nd)/NREFN,ALPHAN));
+    return std::pow((Na+Nd)/NREFN,ALPHAN);
   }
-  AutoDScalar ElecMobLowField(const AutoDScalar &Tl) const
+  PetscScalar HoleDopingTerm() const
   {
+    PetscScalar N;
+    if( ReadNodeCoefficient(DopingP_Coefficient, N) ) return N;
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
+    return std::pow((Na+Nd)/NREFP,ALPHAP);
+  }
+
+  //---------------------------------------------------------------------------
+  // Electron low field mobility
+  PetscScalar ElecMobLowField(const PetscScalar &Tl) const
+  {
+    return MUN_MIN+(MUN_MAX*std::pow(Tl/T300,NUN)-MUN_MIN)/ \
+           (1+std::pow(Tl/T300,XIN)*ElecDopingTerm());
+  }
+  AutoDScalar ElecMobLowField(const AutoDScalar &Tl) const
+  {
     return MUN_MIN+(MUN_MAX*adtl::pow(Tl/T300,NUN)-MUN_MIN)/ \
-           (1+adtl::pow(Tl/T300,XIN)*std::pow((Na+Nd)/NREFN,ALPHAN));
+           (1+adtl::pow(Tl/T300,XIN)*ElecDopingTerm());
   }
 
   //---------------------------------------------------------------------------
   // Hole low field mobility
   PetscScalar HoleMobLowField(const PetscScalar &Tl) const
   {
-    PetscScalar Na = ReadDopingNa();
-    PetscScalar Nd = ReadDopingNd();
     return MUP_MIN+(MUP_MAX*std::pow(Tl/T300,NUP)-MUP_MIN)/ \
-           (1+std::pow(Tl/T300,XIP)*std::pow((Na+Nd)/NREFP,ALPHAP));
+           (1+std::pow(Tl/T300,XIP)*HoleDopingTerm());
   }
   AutoDScalar HoleMobLowField(const AutoDScalar &Tl) const
+  {
+    return MUP_MIN+(MUP_MAX*adtl::pow(Tl/T300,NUP)-MUP_MIN)/ \
+           (1+adtl::pow(Tl/T300,XIP)*HoleDopingTerm());
+  }
+
+
+public:
+  //---------------------------------------------------------------------------
+  // compute the doping terms once
+  void prepare_node(std::vector<PetscScalar> & coefficients)
   {
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
-    return MUP_MIN+(MUP_MAX*adtl::pow(Tl/T300,NUP)-MUP_MIN)/ \
-           (1+adtl::pow(Tl/T300,XIP)*std::pow((Na+Nd)/NREFP,ALPHAP));
+    coefficients[DopingN_Coefficient] = std::pow((Na+Nd)/NREFN,ALPHAN);
+    coefficients[DopingP_Coefficient] = std::pow((Na+Nd)/NREFP,ALPHAP);
   }
 
 
@@ -176,6 +203,8 @@ public:
   {
     PMI_Info = "This is the Default analytic mobility model of Silicon";
     Mob_Analytic_Init();
+    DopingN_Coefficient = RegisterNodeCoefficient("DopingN");
+    DopingP_Coefficient = RegisterNodeCoefficient("DopingP");
   }
 
 
@@ -42,6 +42,7 @@
 
 
 #include "material.h"
+#include "material_registry.h"
 #include "simulation_region.h"
 
 
@@ -51,7 +52,7 @@ namespace Material
 {
 
   MaterialBase::MaterialBase(const SimulationRegion * reg)
-  : set_ad_num(0),  region(reg) , material(reg->material()), p_point(0), p_node_data(0), dll_file(0)
+  : _set_ad_num(0),  region(reg) , material(reg->material()), p_point(0), p_node_data(0), dll_file(0)
   {
     point_variables = &(region->region_point_variables());
     cell_variables = &(region->region_cell_variables());
@@ -78,6 +79,13 @@ namespace Material
 
   void MaterialBase::load_material( const std::string & _material )
   {
+    // material linked into genius, no library to load
+    if( is_builtin_material(_material) )
+    {
+      dll_file = 0;
+      return;
+    }
+
 #ifdef WINDOWS
     std::string filename =  Genius::genius_dir() + "\\lib\\lib" + _material + ".dll";
 #else
@@ -108,6 +116,14 @@ namespace Material
   }
 
 
+  void * MaterialBase::load_function( const std::string & fun_name ) const
+  {
+    if( dll_file )
+      return (void *)LDFUN(dll_file, fun_name.c_str());
+    return builtin_material_function(fun_name);
+  }
+
+
   MaterialSemiconductor::MaterialSemiconductor(const SimulationRegion * reg)
       : MaterialBase(reg)
   {
@@ -125,55 +141,58 @@ namespace Material
     PMIS_Optical*       (*woptical)  (const PMI_Environment& env);
     PMIS_Trap*          (*wtrap)     (const PMI_Environment& env);
 
-    //init AD indepedent variable set routine
-    set_ad_num = (void* (*) (const unsigned int))LDFUN(dll_file,"set_ad_number");
-    if(!set_ad_num) { MESSAGE<<"Open PMIS AD_SET_VARIABLE function error!\n"; RECORD(); genius_error();}
+    //init AD indepedent variable set routine, built-in material shares AD globals with genius
+    if(dll_file)
+    {
+      _set_ad_num = (void* (*) (const unsigned int))LDFUN(dll_file,"set_ad_number");
+      if(!_set_ad_num) { MESSAGE<<"Open PMIS AD_SET_VARIABLE function error!\n"; RECORD(); genius_error();}
+    }
 
     std::string model_fun_name;
 
     // init basic parameters for the material
     model_fun_name = "PMIS_" + _material + "_BasicParameter_Default";
-    wbasic = (PMIS_BasicParameter* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wbasic = (PMIS_BasicParameter* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wbasic) { MESSAGE<<"Open PMIS "<< material <<" BasicParameter function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Basic] = model_fun_name;
 
     // init band structure model
     model_fun_name = "PMIS_" + _material + "_BandStructure_Default";
-    wband =  (PMIS_BandStructure* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wband =  (PMIS_BandStructure* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wband) { MESSAGE<<"Open PMIS "<< material <<" BandStructure function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Band] = model_fun_name;
 
 
     // init mobility model
     model_fun_name = "PMIS_" + _material + "_Mob_Default";
-    wmob  =  (PMIS_Mobility* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wmob  =  (PMIS_Mobility* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wmob) { MESSAGE<<"Open PMIS "<< material <<" Mobility function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Mobility] = model_fun_name;
 
 
     // init Avalanche generation model
     model_fun_name = "PMIS_" + _material + "_Avalanche_Default";
-    wgen  =  (PMIS_Avalanche* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wgen  =  (PMIS_Avalanche* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wgen) { MESSAGE<<"Open PMIS "<< material <<" Avalanche function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Impact] = model_fun_name;
 
 
     // init Thermal model for lattice temperature equation
     model_fun_name = "PMIS_" + _material + "_Thermal_Default";
-    wthermal  = (PMIS_Thermal* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wthermal  = (PMIS_Thermal* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wthermal) { MESSAGE<<"Open PMIS "<< material <<" Thermal function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Thermal] = model_fun_name;
 
 
     // init optical data
     model_fun_name = "PMIS_" + _material + "_Optical_Default";
-    woptical  = (PMIS_Optical* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    woptical  = (PMIS_Optical* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!woptical) { MESSAGE<<"Open PMIS "<< material <<" Optical function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Optical] = model_fun_name;
 
     // init trap data
     model_fun_name = "PMIS_" + _material + "_Trap_Default";
-    wtrap = (PMIS_Trap* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wtrap = (PMIS_Trap* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wtrap ) { MESSAGE<<"Open PMIS "<< material <<" Trap function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Trap] = model_fun_name;
 
@@ -303,7 +322,7 @@ namespace Material
         std::string model_fun_name = "PMIS_" + _material + "_BasicParameter_" + model_name;
         if (active_models[Basic] != model_fun_name)
         {
-          wbasic = (PMIS_BasicParameter* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wbasic = (PMIS_BasicParameter* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wbasic) { MESSAGE<<"Open PMIS "<< material <<" BasicParameter function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete basic;
@@ -322,7 +341,7 @@ namespace Material
         std::string model_fun_name = "PMIS_" + _material + "_BandStructure_" + model_name;
         if (active_models[Band] != model_fun_name)
         {
-          wband = (PMIS_BandStructure* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wband = (PMIS_BandStructure* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wband) { MESSAGE<<"Open PMIS "<< material <<" BandStructure function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete band;
@@ -341,7 +360,7 @@ namespace Material
         std::string model_fun_name = "PMIS_" + _material + "_Mob_" + model_name;
         if (active_models[Mobility] != model_fun_name)
         {
-          wmob = (PMIS_Mobility* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wmob = (PMIS_Mobility* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wmob) { MESSAGE<<"Open PMIS "<< material <<" Mobility function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete mob;
@@ -360,7 +379,7 @@ namespace Material
         std::string model_fun_name = "PMIS_" + _material + "_Avalanche_" + model_name;
         if (active_models[Impact] != model_fun_name)
         {
-          wgen = (PMIS_Avalanche* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wgen = (PMIS_Avalanche* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wgen) { MESSAGE<<"Open PMIS "<< material <<" Avalanche function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete gen;
@@ -379,7 +398,7 @@ namespace Material
         std::string model_fun_name = "PMIS_" + _material + "_Thermal_" + model_name;
         if (active_models[Thermal] != model_fun_name)
         {
-          wthermal = (PMIS_Thermal* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wthermal = (PMIS_Thermal* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wthermal) { MESSAGE<<"Open PMIS "<< material <<" Thermal function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete thermal;
@@ -398,7 +417,7 @@ namespace Material
         std::string model_fun_name = "PMIS_" + _material + "_Optical_" + model_name;
         if (active_models[Optical] != model_fun_name)
         {
-          woptical = (PMIS_Optical* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          woptical = (PMIS_Optical* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!woptical) { MESSAGE<<"Open PMIS "<< material <<" Optical function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete optical;
@@ -417,7 +436,7 @@ namespace Material
         std::string model_fun_name = "PMIS_" + _material + "_Trap_" + model_name;
         if (active_models[Trap] != model_fun_name)
         {
-          wtrap = (PMIS_Trap* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wtrap = (PMIS_Trap* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wtrap) { MESSAGE<<"Open PMIS "<< material <<" Trap function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete trap;
@@ -453,33 +472,36 @@ namespace Material
     PMII_Thermal*       (*wthermal)  (const PMI_Environment& env);
     PMII_Optical*       (*woptical)  (const PMI_Environment& env);
 
-    //init AD indepedent variable set routine
-    set_ad_num = (void* (*) (const unsigned int))LDFUN(dll_file,"set_ad_number");
-    if(!set_ad_num) { MESSAGE<<"Open PMII AD_SET_VARIABLE function error!\n"; RECORD(); genius_error();}
+    //init AD indepedent variable set routine, built-in material shares AD globals with genius
+    if(dll_file)
+    {
+      _set_ad_num = (void* (*) (const unsigned int))LDFUN(dll_file,"set_ad_number");
+      if(!_set_ad_num) { MESSAGE<<"Open PMII AD_SET_VARIABLE function error!\n"; RECORD(); genius_error();}
+    }
 
     std::string model_fun_name;
 
     // init basic parameters for the material
     model_fun_name = "PMII_" + _material + "_BasicParameter_Default";
-    wbasic = (PMII_BasicParameter* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wbasic = (PMII_BasicParameter* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wbasic) { MESSAGE<<"Open PMII "<< material <<" BasicParameter function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Basic] = model_fun_name;
 
     // init band structure model
     model_fun_name = "PMII_" + _material + "_BandStructure_Default";
-    wband =  (PMII_BandStructure* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wband =  (PMII_BandStructure* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wband) { MESSAGE<<"Open PMII "<< material <<" BandStructure function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Band] = model_fun_name;
 
     // init Thermal model for lattice temperature equation
     model_fun_name = "PMII_" + _material + "_Thermal_Default";
-    wthermal  = (PMII_Thermal* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wthermal  = (PMII_Thermal* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wthermal) { MESSAGE<<"Open PMII "<< material <<" Thermal function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Thermal] = model_fun_name;
 
     // init optical data
     model_fun_name = "PMII_" + _material + "_Optical_Default";
-    woptical  = (PMII_Optical* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    woptical  = (PMII_Optical* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!woptical) { MESSAGE<<"Open PMII "<< material <<" Optical function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Optical] = model_fun_name;
 
@@ -578,7 +600,7 @@ namespace Material
         std::string model_fun_name = "PMII_" + _material + "_BasicParameter_" + model_name;
         if (active_models[Basic] != model_fun_name)
         {
-          wbasic = (PMII_BasicParameter* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wbasic = (PMII_BasicParameter* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wbasic) { MESSAGE<<"Open PMII "<< material <<" BasicParameter function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete basic;
@@ -597,7 +619,7 @@ namespace Material
         std::string model_fun_name = "PMII_" + _material + "_BandStructure_" + model_name;
         if (active_models[Band] != model_fun_name)
         {
-          wband = (PMII_BandStructure* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wband = (PMII_BandStructure* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wband) { MESSAGE<<"Open PMII "<< material <<" BandStructure function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete band;
@@ -616,7 +638,7 @@ namespace Material
         std::string model_fun_name = "PMII_" + _material + "_Thermal_" + model_name;
         if (active_models[Thermal] != model_fun_name)
         {
-          wthermal = (PMII_Thermal* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wthermal = (PMII_Thermal* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wthermal) { MESSAGE<<"Open PMII "<< material <<" Thermal function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete thermal;
@@ -635,7 +657,7 @@ namespace Material
         std::string model_fun_name = "PMII_" + _material + "_Optical_" + model_name;
         if (active_models[Optical] != model_fun_name)
         {
-          woptical = (PMII_Optical* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          woptical = (PMII_Optical* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!woptical) { MESSAGE<<"Open PMII "<< material <<" Optical function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete optical;
@@ -670,27 +692,30 @@ namespace Material
     PMIC_Thermal*       (*wthermal)  (const PMI_Environment& env);
     PMIC_Optical*       (*woptical)  (const PMI_Environment& env);
 
-    //init AD indepedent variable set routine
-    set_ad_num = (void* (*) (const unsigned int))LDFUN(dll_file,"set_ad_number");
-    if(!set_ad_num) { MESSAGE<<"Open PMIC AD_SET_VARIABLE function error!\n"; RECORD(); genius_error();}
+    //init AD indepedent variable set routine, built-in material shares AD globals with genius
+    if(dll_file)
+    {
+      _set_ad_num = (void* (*) (const unsigned int))LDFUN(dll_file,"set_ad_number");
+      if(!_set_ad_num) { MESSAGE<<"Open PMIC AD_SET_VARIABLE function error!\n"; RECORD(); genius_error();}
+    }
 
     std::string model_fun_name;
 
     // init basic parameters for the material
     model_fun_name = "PMIC_" + _material + "_BasicParameter_Default";
-    wbasic = (PMIC_BasicParameter* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wbasic = (PMIC_BasicParameter* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wbasic) { MESSAGE<<"Open PMIC "<< material <<" BasicParameter function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Basic] = model_fun_name;
 
     // init Thermal model for lattice temperature equation
     model_fun_name = "PMIC_" + _material + "_Thermal_Default";
-    wthermal  = (PMIC_Thermal* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wthermal  = (PMIC_Thermal* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wthermal) { MESSAGE<<"Open PMIC "<< material <<" Thermal function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Thermal] = model_fun_name;
 
     // init optical data
     model_fun_name = "PMIC_" + _material + "_Optical_Default";
-    woptical  = (PMIC_Optical* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    woptical  = (PMIC_Optical* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!woptical) { MESSAGE<<"Open PMIC "<< material <<" Optical function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Optical] = model_fun_name;
 
@@ -783,7 +808,7 @@ namespace Material
         std::string model_fun_name = "PMIC_" + _material + "_BasicParameter_" + model_name;
         if (active_models[Basic] != model_fun_name)
         {
-          wbasic = (PMIC_BasicParameter* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wbasic = (PMIC_BasicParameter* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wbasic) { MESSAGE<<"Open PMIC "<< material <<" BasicParameter function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete basic;
@@ -802,7 +827,7 @@ namespace Material
         std::string model_fun_name = "PMIC_" + _material + "_Thermal_" + model_name;
         if (active_models[Thermal] != model_fun_name)
         {
-          wthermal = (PMIC_Thermal* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wthermal = (PMIC_Thermal* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wthermal) { MESSAGE<<"Open PMIC "<< material <<" Thermal function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete thermal;
@@ -821,7 +846,7 @@ namespace Material
         std::string model_fun_name = "PMIC_" + _material + "_Optical_" + model_name;
         if (active_models[Optical] != model_fun_name)
         {
-          woptical = (PMIC_Optical* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          woptical = (PMIC_Optical* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!woptical) { MESSAGE<<"Open PMIC "<< material <<" Optical function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete optical;
@@ -858,27 +883,30 @@ namespace Material
     PMIV_Thermal*       (*wthermal)  (const PMI_Environment& env);
     PMIV_Optical*       (*woptical)  (const PMI_Environment& env);
 
-    //init AD indepedent variable set routine
-    set_ad_num = (void* (*) (const unsigned int))LDFUN(dll_file,"set_ad_number");
-    if(!set_ad_num) { MESSAGE<<"Open PMIV AD_SET_VARIABLE function error!\n"; RECORD(); genius_error();}
+    //init AD indepedent variable set routine, built-in material shares AD globals with genius
+    if(dll_file)
+    {
+      _set_ad_num = (void* (*) (const unsigned int))LDFUN(dll_file,"set_ad_number");
+      if(!_set_ad_num) { MESSAGE<<"Open PMIV AD_SET_VARIABLE function error!\n"; RECORD(); genius_error();}
+    }
 
     std::string model_fun_name;
 
     // init basic parameters for the material
     model_fun_name = "PMIV_" + _material + "_BasicParameter_Default";
-    wbasic = (PMIV_BasicParameter* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wbasic = (PMIV_BasicParameter* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wbasic) { MESSAGE<<"Open PMIV "<< material <<" BasicParameter function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Basic] = model_fun_name;
 
     // init Thermal model for lattice temperature equation
     model_fun_name = "PMIV_" + _material + "_Thermal_Default";
-    wthermal  = (PMIV_Thermal* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wthermal  = (PMIV_Thermal* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wthermal) { MESSAGE<<"Open PMIV "<< material <<" Thermal function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Thermal] = model_fun_name;
 
     // init optical data
     model_fun_name = "PMIV_" + _material + "_Optical_Default";
-    woptical  = (PMIV_Optical* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    woptical  = (PMIV_Optical* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!woptical) { MESSAGE<<"Open PMIV "<< material <<" Optical function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Optical] = model_fun_name;
 
@@ -970,7 +998,7 @@ namespace Material
         std::string model_fun_name = "PMIV_" + _material + "_BasicParameter_" + model_name;
         if (active_models[Basic] != model_fun_name)
         {
-          wbasic = (PMIV_BasicParameter* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wbasic = (PMIV_BasicParameter* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wbasic) { MESSAGE<<"Open PMIV "<< material <<" BasicParameter function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete basic;
@@ -989,7 +1017,7 @@ namespace Material
         std::string model_fun_name = "PMIV_" + _material + "_Thermal_" + model_name;
         if (active_models[Thermal] != model_fun_name)
         {
-          wthermal = (PMIV_Thermal* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wthermal = (PMIV_Thermal* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wthermal) { MESSAGE<<"Open PMIV "<< material <<" Thermal function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete thermal;
@@ -1008,7 +1036,7 @@ namespace Material
         std::string model_fun_name = "PMIV_" + _material + "_Optical_" + model_name;
         if (active_models[Optical] != model_fun_name)
         {
-          woptical = (PMIV_Optical* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          woptical = (PMIV_Optical* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!woptical) { MESSAGE<<"Open PMIV "<< material <<" Optical function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete optical;
@@ -1045,21 +1073,24 @@ namespace Material
     PMIP_BasicParameter*(*wbasic)    (const PMI_Environment& env);
     PMIP_Thermal*       (*wthermal)  (const PMI_Environment& env);
 
-    //init AD indepedent variable set routine
-    set_ad_num = (void* (*) (const unsigned int))LDFUN(dll_file,"set_ad_number");
-    if(!set_ad_num) { MESSAGE<<"Open PMIP AD_SET_VARIABLE function error!\n"; RECORD(); genius_error();}
+    //init AD indepedent variable set routine, built-in material shares AD globals with genius
+    if(dll_file)
+    {
+      _set_ad_num = (void* (*) (const unsigned int))LDFUN(dll_file,"set_ad_number");
+      if(!_set_ad_num) { MESSAGE<<"Open PMIP AD_SET_VARIABLE function error!\n"; RECORD(); genius_error();}
+    }
 
     std::string model_fun_name;
 
     // init basic parameters for the material
     model_fun_name = "PMIP_" + _material + "_BasicParameter_Default";
-    wbasic = (PMIP_BasicParameter* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wbasic = (PMIP_BasicParameter* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wbasic) { MESSAGE<<"Open PMIP "<< material <<" BasicParameter function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Basic] = model_fun_name;
 
     // init Thermal model for lattice temperature equation
     model_fun_name = "PMIP_" + _material + "_Thermal_Default";
-    wthermal  = (PMIP_Thermal* (*) (const PMI_Environment& env))LDFUN(dll_file, model_fun_name.c_str());
+    wthermal  = (PMIP_Thermal* (*) (const PMI_Environment& env))load_function(model_fun_name);
     if(!wthermal) { MESSAGE<<"Open PMIP "<< material <<" Thermal function "<< "Default" <<" error!\n"; RECORD(); genius_error(); }
     active_models[Thermal] = model_fun_name;
 
@@ -1142,7 +1173,7 @@ namespace Material
         std::string model_fun_name = "PMIP_" + _material + "_BasicParameter_" + model_name;
         if (active_models[Basic] != model_fun_name)
         {
-          wbasic = (PMIP_BasicParameter* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wbasic = (PMIP_BasicParameter* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wbasic) { MESSAGE<<"Open PMIP "<< material <<" BasicParameter function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete basic;
@@ -1161,7 +1192,7 @@ namespace Material
         std::string model_fun_name = "PMIP_" + _material + "_Thermal_" + model_name;
         if (active_models[Thermal] != model_fun_name)
         {
-          wthermal = (PMIP_Thermal* (*) (const PMI_Environment& env))LDFUN( dll_file, model_fun_name.c_str() );
+          wthermal = (PMIP_Thermal* (*) (const PMI_Environment& env))load_function(model_fun_name);
           if(!wthermal) { MESSAGE<<"Open PMIP "<< material <<" Thermal function "<< model_name <<" error!\n"; RECORD(); genius_error(); }
           // delete old PMI object
           delete thermal;
@@ -0,0 +1,65 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <map>
+
+#include "config.h"
+#include "material_registry.h"
+
+
+#ifdef STATIC_MATERIAL
+// generated by src/material/wscript, null terminated
+extern const char *                      builtin_material_names[];
+extern const Material::BuiltinFunction   builtin_material_functions[];
+#endif
+
+
+namespace Material
+{
+
+  bool is_builtin_material(const std::string & lib_name)
+  {
+#ifdef STATIC_MATERIAL
+    for(unsigned int n=0; builtin_material_names[n]; ++n)
+      if( lib_name == builtin_material_names[n] ) return true;
+#endif
+    return false;
+  }
+
+
+  void * builtin_material_function(const std::string & fun_name)
+  {
+#ifdef STATIC_MATERIAL
+    // build the name index at first call
+    static std::map<std::string, void *> functions;
+    if( functions.empty() )
+    {
+      for(unsigned int n=0; builtin_material_functions[n].name; ++n)
+        functions[builtin_material_functions[n].name] = builtin_material_functions[n].address;
+    }
+
+    std::map<std::string, void *>::const_iterator it = functions.find(fun_name);
+    if( it != functions.end() ) return it->second;
+#endif
+    return 0;
+  }
+
+}
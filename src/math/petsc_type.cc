@@ -123,6 +123,7 @@ namespace SolverSpecify
       PreconditionerName_to_PreconditionerType["asmilu3"     ]  = ASMILU3_PRECOND;
       PreconditionerName_to_PreconditionerType["asmlu"       ]  = ASMLU_PRECOND;
       PreconditionerName_to_PreconditionerType["amg"         ]  = BOOMERAMG_PRECOND;
+      PreconditionerName_to_PreconditionerType["gamg"        ]  = GAMG_PRECOND;
       PreconditionerName_to_PreconditionerType["bjacobian"   ]  = CHOLESKY_PRECOND;
       PreconditionerName_to_PreconditionerType["eisenstat"   ]  = EISENSTAT_PRECOND;
       PreconditionerName_to_PreconditionerType["icc"         ]  = ICC_PRECOND;
@@ -130,6 +131,7 @@ namespace SolverSpecify
       PreconditionerName_to_PreconditionerType["ilut"        ]  = ILUT_PRECOND;
       PreconditionerName_to_PreconditionerType["lu"          ]  = LU_PRECOND;
       PreconditionerName_to_PreconditionerType["parms"       ]  = PARMS_PRECOND;
+      PreconditionerName_to_PreconditionerType["schur"       ]  = SCHUR_PRECOND;
     }
   }
 
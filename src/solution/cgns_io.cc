@@ -21,6 +21,7 @@
 
 // C++ includes
 #include <numeric>
+#include <cstdlib>
 
 // cgns lib include
 #include <cgnslib.h>
@@ -35,6 +36,8 @@
 
 #include "parallel.h"
 #include "mesh_communication.h"
+#include "async_writer.h"
+#include "solver_specify.h"
 
 using PhysicalUnit::cm;
 using PhysicalUnit::um;
@@ -65,6 +68,9 @@ void CGNSIO::read (const std::string& filename)
 
   if( Genius::processor_id() == 0)
   {
+    // cgns library is not thread safe, wait for the background writes
+    AsyncWriter::instance().flush();
+
     // open CGNS file for read
     genius_assert(!cg_open(filename.c_str(), MODE_READ, &fn));
 
@@ -487,9 +493,12 @@ void CGNSIO::read (const std::string& filename)
         // read extra boundary data: potential for electrode
         if( nuserdata == 2)
         {
-          double potential=0;
           if(!cg_gopath(fn, "extra_data_for_electrode"))
           {
+            // time series file keeps data of step k as "electrode_potential_k",
+            // select the latest step not after the required one
+            std::map<std::string, std::pair<int, double> > data_select;
+
             int narray;
             genius_assert(!cg_narrays(&narray));
             for(int a=1; a<=narray; a++)
@@ -501,14 +510,21 @@ void CGNSIO::read (const std::string& filename)
               double data;
               genius_assert(!cg_array_info(a, array, &type, &dimension, &vector));
               genius_assert(!cg_array_read_as(a, type, &data));
-              if( std::string(array) == "electrode_potential" )
-                electrode_potential[bd_id] = data;
-              if( std::string(array) == "electrode_vapp" )
-                electrode_vapp[bd_id] = data;
-              if( std::string(array) == "electrode_iapp" )
-                electrode_iapp[bd_id] = data;
+
+              std::string name;
+              int step = solution_step(array, name);
+              if( _time_step >= 0 && step > _time_step ) continue;
+              if( data_select.find(name) == data_select.end() || data_select[name].first < step )
+                data_select[name] = std::make_pair(step, data);
             }
             genius_assert(!cg_gopath(fn, ".."));
+
+            if( data_select.find("electrode_potential") != data_select.end() )
+              electrode_potential[bd_id] = data_select["electrode_potential"].second;
+            if( data_select.find("electrode_vapp") != data_select.end() )
+              electrode_vapp[bd_id] = data_select["electrode_vapp"].second;
+            if( data_select.find("electrode_iapp") != data_select.end() )
+              electrode_iapp[bd_id] = data_select["electrode_iapp"].second;
           }
         }
       }
@@ -520,8 +536,27 @@ void CGNSIO::read (const std::string& filename)
 
       //how many fieldsol node?
       genius_assert(!cg_nsols(fn, B, z_id, &SOL));
+
+      // a time series file keeps solution of step k in "Solution_k".
+      // for each solution, select the latest step not after the required one
+      std::map<std::string, std::pair<int, int> > sol_select;
       for(int sol_id=1; sol_id<=SOL; sol_id++)
       {
+        char           solutionname[32];
+        GridLocation_t locationtype;
+        genius_assert(!cg_sol_info(fn,B,z_id,sol_id,solutionname, &locationtype));
+
+        std::string sol;
+        int step = solution_step(solutionname, sol);
+        if( _time_step >= 0 && step > _time_step ) continue;
+        if( sol_select.find(sol) == sol_select.end() || sol_select[sol].first < step )
+          sol_select[sol] = std::make_pair(step, sol_id);
+      }
+
+      std::map<std::string, std::pair<int, int> >::const_iterator sol_select_it = sol_select.begin();
+      for(; sol_select_it != sol_select.end(); ++sol_select_it)
+      {
+        const int sol_id = sol_select_it->second.second;
         genius_assert(!cg_nfields(fn, B, z_id, sol_id, &F));
         char           solutionname[32];
         GridLocation_t locationtype;
@@ -534,7 +569,7 @@ void CGNSIO::read (const std::string& filename)
           cg_field_info(fn, B, z_id, sol_id, f_id, &datatype, fieldname);
           genius_assert(datatype==RealDouble);
 
-          std::pair<std::string, std::string> key(solutionname,fieldname);
+          std::pair<std::string, std::string> key(sol_select_it->first,fieldname);
           sol_map[key].resize(isize[0]);
           genius_assert(!cg_field_read(fn, B, z_id, sol_id, fieldname, datatype, &imin, &isize[0], &((sol_map[key])[0])));
         }
@@ -615,52 +650,8 @@ void CGNSIO::read (const std::string& filename)
     }
   }
 
-  //distribute (solution's) global id to all the processor
-  if(Genius::processor_id() != 0)
-    region_global_id.resize(system.n_regions());
-  for(unsigned int r=0; r<system.n_regions(); r++)
-    Parallel::broadcast(region_global_id[r] , 0);
-
-
-  //distribute (solution's) global id to node id information to all the processor
-  if(Genius::processor_id() != 0)
-    region_global_id_to_node_id.resize(system.n_regions());
-  for(unsigned int r=0; r<system.n_regions(); r++)
-    Parallel::broadcast(region_global_id_to_node_id[r] , 0);
-
-  // distribute solution data to all the processor
-  if(Genius::processor_id() != 0)
-    region_solutions.resize(system.n_regions());
-
-  for(unsigned int r=0; r<region_solutions.size(); r++)
-  {
-    unsigned int n_solutions = region_solutions[r].size();
-    Parallel::broadcast(n_solutions , 0);
-
-    std::string sol_name;
-    std::string field_name;
-    std::vector<double> sol_array;
-
-    std::map<std::pair<std::string,std::string>, std::vector<double> >::iterator it = region_solutions[r].begin();
-
-    for(unsigned int n=0; n<n_solutions; n++)
-    {
-      if(Genius::processor_id() == 0)
-      {
-        sol_name  = (*it).first.first;
-        field_name  = (*it).first.second;
-        sol_array = (*it).second;
-        ++it;
-      }
-
-      Parallel::broadcast(sol_name   , 0);
-      Parallel::broadcast(field_name , 0);
-      Parallel::broadcast(sol_array  , 0);
-
-      if(Genius::processor_id() != 0)
-        (region_solutions[r])[std::pair<std::string,std::string>(sol_name,field_name)] = sol_array;
-    }
-  }
+  // distribute solution data to the processors which hold the nodes
+  _distribute_solution();
 
   Parallel::broadcast(region_solution_units   , 0);
 
@@ -947,16 +938,306 @@ void CGNSIO::read (const std::string& filename)
 
 
 
+/**
+ * all the data processor 0 needs to create a cgns file. after the collective
+ * gathering in CGNSIO::write, the job only contains plain arrays, so it can be
+ * written to disk by the AsyncWriter I/O thread.
+ */
+class CGNSIO::WriteJob : public AsyncWriter::Job
+{
+public:
+
+  struct BoundarySnapshot
+  {
+    std::string         name;
+    std::vector<int>    points;
+    std::string         label;
+    std::string         settings;
+    std::vector<int>    elems;
+    std::vector<int>    sides;
+    bool                electrode;
+    double              potential;
+    double              vapp;
+    double              iapp;
+  };
+
+  struct FieldSnapshot
+  {
+    std::string         sol;
+    std::string         variable;
+    std::string         unit;
+    std::vector<double> value;
+  };
+
+  struct ZoneSnapshot
+  {
+    std::string         name;
+    std::string         material;
+    int                 size[3];
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    std::vector<int>    global_node_id;
+    std::vector<int>    elem_package;
+    std::vector<int>    elem_id;
+    std::vector<int>    elem_attribute;
+    std::vector<BoundarySnapshot> boundaries;
+    std::vector<FieldSnapshot>    fields;
+  };
+
+  WriteJob(const std::string & filename) : append(false), time_accurate(false), _filename(filename) {}
+
+  virtual void run();
+
+  virtual size_t memory_size() const;
+
+  virtual std::string file_name() const
+  { return _filename; }
+
+  std::string                 base_name;
+  std::vector<ZoneSnapshot>   zones;
+  std::vector< std::pair<std::string, std::string> > extra_boundary_info;
+
+  /**
+   * time value of each step of a time series file, empty for single snapshot
+   */
+  std::vector<double>         time_values;
+
+  /**
+   * only append solution fields and electrode data of current step to an existing time series file
+   */
+  bool                        append;
+
+  /**
+   * the series is a transient run, otherwise the step values are swept bias
+   */
+  bool                        time_accurate;
+
+private:
+  std::string _filename;
+};
+
+
+
+size_t CGNSIO::WriteJob::memory_size() const
+{
+  size_t size = 0;
+  for(unsigned int z=0; z<zones.size(); ++z)
+  {
+    const ZoneSnapshot & zone = zones[z];
+    size += sizeof(double)*(zone.x.size() + zone.y.size() + zone.z.size());
+    size += sizeof(int)*(zone.global_node_id.size() + zone.elem_package.size() + zone.elem_id.size() + zone.elem_attribute.size());
+    for(unsigned int b=0; b<zone.boundaries.size(); ++b)
+      size += sizeof(int)*(zone.boundaries[b].points.size() + zone.boundaries[b].elems.size() + zone.boundaries[b].sides.size());
+    for(unsigned int f=0; f<zone.fields.size(); ++f)
+      size += sizeof(double)*zone.fields[f].value.size();
+  }
+  return size;
+}
+
+
+
+void CGNSIO::WriteJob::run()
+{
+  int fn, B, Z, C, S, BC, SOL, F;
+
+  if( append )
+  {
+    // time series file, mesh and static data already there
+    genius_assert(!cg_open(_filename.c_str(), MODE_MODIFY, &fn));
+    B = 1;
+  }
+  else
+  {
+    // remove old file if exist
+    remove(_filename.c_str());
+
+    // open CGNS file for write
+    genius_assert(!cg_open(_filename.c_str(), MODE_WRITE, &fn));
+
+    // create base of three dimensional mesh
+    genius_assert(!cg_base_write(fn, base_name.c_str(), 3, 3, &B));
+  }
+
+  for(unsigned int z=0; z<zones.size() && !append; ++z)
+  {
+    ZoneSnapshot & zone = zones[z];
+
+    // write region name
+    genius_assert(!cg_zone_write(fn, B, zone.name.c_str(), zone.size, Unstructured, &Z));
+
+    // goto the current region
+    genius_assert(!cg_goto(fn,B,"Zone_t",Z,"end"));
+
+    // write down material
+    genius_assert(!cg_descriptor_write("Material", zone.material.c_str() ));
+
+    // write down coordinates
+    cg_coord_write(fn, B, Z, RealDouble, "CoordinateX", &zone.x[0], &C);
+    cg_coord_write(fn, B, Z, RealDouble, "CoordinateY", &zone.y[0], &C);
+    cg_coord_write(fn, B, Z, RealDouble, "CoordinateZ", &zone.z[0], &C);
+
+    // write the global index of region node into cgns file
+    genius_assert(!cg_goto(fn, B, "Zone_t", Z , "end"));
+    genius_assert(!cg_user_data_write ("Global_Node_Index"));
+    genius_assert(!cg_goto(fn, B, "Zone_t", Z, "UserDefinedData_t", 1, "end"));
+    genius_assert(!cg_array_write("index", Integer, 1, &zone.size[0], &zone.global_node_id[0]));
+
+    // element connectivity
+    genius_assert(!cg_section_write(fn, B ,Z, "GridElements", MIXED, 1, zone.elem_id.size(), 0, &zone.elem_package[0], &S));
+#ifdef ENABLE_AMR
+    // write element amr attribute
+    int  elem_id_size = static_cast<int>(zone.elem_id.size());
+    int  elem_attribute_size = static_cast<int>(zone.elem_attribute.size());
+    genius_assert(!cg_goto(fn, B, "Zone_t", Z , "end"));
+    genius_assert(!cg_user_data_write ("Element_Attribute"));
+    genius_assert(!cg_goto(fn, B, "Zone_t", Z, "UserDefinedData_t", 2, "end"));
+    genius_assert(!cg_array_write("elem_id_array", Integer, 1, &elem_id_size, &zone.elem_id[0]));
+    genius_assert(!cg_array_write("elem_attribute_array", Integer, 1, &elem_attribute_size, &zone.elem_attribute[0]));
+#endif
+
+    // boundary condition
+    for(unsigned int b=0; b<zone.boundaries.size(); ++b)
+    {
+      BoundarySnapshot & bd = zone.boundaries[b];
+
+      // boundary as point list
+      cg_boco_write(fn, B, Z, bd.name.c_str(), BCTypeUserDefined, PointList, bd.points.size(), &bd.points[0], &BC);
+
+      // actual bc label is here
+      assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "end"));
+      assert(!cg_descriptor_write("bc_label", bd.label.c_str()));
+
+      // write boundary condition
+      assert(!cg_descriptor_write("bc_settings", bd.settings.c_str()));
+
+      // extra information as element-side list
+      int n_side =  bd.sides.size();
+      assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "end"));
+      assert(!cg_user_data_write ("element_side_information"));
+      assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "UserDefinedData_t", 1, "end"));
+      assert(!cg_array_write("element_list", Integer, 1, &n_side, &bd.elems[0]));
+      assert(!cg_array_write("side_list", Integer, 1, &n_side, &bd.sides[0]));
+
+      // write electrode potential
+      if( bd.electrode )
+      {
+        int    DimensionVector = 1;
+        assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "end"));
+        assert(!cg_user_data_write ("extra_data_for_electrode"));
+        assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "UserDefinedData_t", 2, "end"));
+        assert(!cg_array_write("electrode_potential", RealDouble, 1, &DimensionVector, &bd.potential));
+        assert(!cg_array_write("electrode_vapp", RealDouble, 1, &DimensionVector, &bd.vapp));
+        assert(!cg_array_write("electrode_iapp", RealDouble, 1, &DimensionVector, &bd.iapp));
+      }
+    }
+  }
+
+  // electrode data of current step, boundaries are written in the same order as the first step
+  for(unsigned int z=0; z<zones.size() && append; ++z)
+  {
+    const int step = time_values.size()-1;
+    const std::string potential = CGNSIO::solution_name("electrode_potential", step);
+    const std::string vapp      = CGNSIO::solution_name("electrode_vapp", step);
+    const std::string iapp      = CGNSIO::solution_name("electrode_iapp", step);
+
+    ZoneSnapshot & zone = zones[z];
+    Z = z+1;
+    for(unsigned int b=0; b<zone.boundaries.size(); ++b)
+    {
+      BoundarySnapshot & bd = zone.boundaries[b];
+      if( !bd.electrode ) continue;
+
+      int    DimensionVector = 1;
+      BC = b+1;
+      genius_assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "UserDefinedData_t", 2, "end"));
+      genius_assert(!cg_array_write(potential.c_str(), RealDouble, 1, &DimensionVector, &bd.potential));
+      genius_assert(!cg_array_write(vapp.c_str(), RealDouble, 1, &DimensionVector, &bd.vapp));
+      genius_assert(!cg_array_write(iapp.c_str(), RealDouble, 1, &DimensionVector, &bd.iapp));
+    }
+  }
+
+  // solution data, fields of the same solution node are adjacent
+  for(unsigned int z=0; z<zones.size(); ++z)
+  {
+    ZoneSnapshot & zone = zones[z];
+    Z = z+1;
+
+    for(unsigned int f=0; f<zone.fields.size(); ++f)
+    {
+      FieldSnapshot & field = zone.fields[f];
+      if( f==0 || field.sol != zone.fields[f-1].sol )
+        genius_assert(!cg_sol_write  (fn, B, Z, field.sol.c_str(), Vertex, &SOL));
+
+      std::string path = std::string("/") + base_name + "/" + zone.name + "/" + field.sol;
+      std::string variable_unit = field.variable + ".unit";
+      genius_assert(!cg_field_write(fn, B, Z, SOL, RealDouble, field.variable.c_str(), &field.value[0], &F));
+      genius_assert(!cg_gopath(fn, path.c_str()));
+      genius_assert(!cg_descriptor_write(variable_unit.c_str(), field.unit.c_str()));
+    }
+  }
+
+  // write global boundary conditions, including interconnect and charge boundary
+  if( !append )
+  {
+    genius_assert(!cg_goto(fn,B,"end"));
+    assert(!cg_user_data_write ("ExtraBoundaryInfo"));
+    assert(!cg_goto(fn, B, "UserDefinedData_t", 1, "end"));
+    for(unsigned int n=0; n<extra_boundary_info.size(); ++n)
+      genius_assert(!cg_descriptor_write(extra_boundary_info[n].first.c_str(), extra_boundary_info[n].second.c_str() ));
+  }
+
+  // iterative data of time series, rewritten with all the steps
+  if( !time_values.empty() )
+  {
+    int n_steps = time_values.size();
+    if( time_accurate )
+      genius_assert(!cg_simulation_type_write(fn, B, TimeAccurate));
+    genius_assert(!cg_biter_write(fn, B, "TimeIterValues", n_steps));
+    genius_assert(!cg_goto(fn, B, "BaseIterativeData_t", 1, "end"));
+    genius_assert(!cg_array_write("TimeValues", RealDouble, 1, &n_steps, &time_values[0]));
+
+    for(unsigned int z=0; z<zones.size(); ++z)
+    {
+      Z = z+1;
+      // FlowSolutionPointers is a 32 x n_steps char array
+      std::vector<char> pointers(32*n_steps, ' ');
+      for(int step=0; step<n_steps; ++step)
+      {
+        std::string name = zones[z].fields.empty() ? std::string("Null") : CGNSIO::solution_name("Solution", step);
+        std::copy(name.begin(), name.end(), pointers.begin()+32*step);
+      }
+      int dims[2] = {32, n_steps};
+      genius_assert(!cg_ziter_write(fn, B, Z, "ZoneIterativeData"));
+      genius_assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneIterativeData_t", 1, "end"));
+      genius_assert(!cg_array_write("FlowSolutionPointers", Character, 2, dims, &pointers[0]));
+    }
+  }
+
+  // close CGNS file
+  cg_close(fn);
+}
+
+
+
 void CGNSIO::write (const std::string& filename)
 {
   const SimulationSystem & system = FieldOutput<SimulationSystem>::system();
   const BoundaryConditionCollector * bcs = system.get_bcs();
   const MeshBase & mesh = system.mesh();
 
+  // step of time series, only solution fields and electrode data are written after the first step
+  const int  step   = _time_values.empty() ? 0 : _time_values.size()-1;
+  const bool append = step > 0;
+
+  // only processor 0 holds the job
+  WriteJob * job = NULL;
   if( Genius::processor_id() == 0)
   {
-    // remove old file if exist
-    remove(filename.c_str());
+    job = new WriteJob(filename);
+    job->time_values = _time_values;
+    job->append = append;
+    job->time_accurate = SolverSpecify::Type==SolverSpecify::TRANSIENT;
   }
 
   // classify node to region
@@ -1015,20 +1296,14 @@ void CGNSIO::write (const std::string& filename)
     }
   }
 
-  std::string base_name;
-
-  // ok, create cgns here
   if( Genius::processor_id() == 0)
   {
-    // open CGNS file for write
-    genius_assert(!cg_open(filename.c_str(), MODE_WRITE, &fn));
-
     // create base of three dimensional mesh, here mesh takes its magic number as postfix
     std::stringstream   ss;
     ss << "GENIUS_Mesh_" << system.mesh().magic_num();
-    ss >> base_name;
+    ss >> job->base_name;
 
-    genius_assert(!cg_base_write(fn, base_name.c_str(), 3, 3, &B));
+    job->zones.resize(system.n_regions());
   }
 
   // create cgns zone
@@ -1036,73 +1311,42 @@ void CGNSIO::write (const std::string& filename)
   {
     const SimulationRegion * region = system.region(r);
 
-    int size[3];
-    // region node number
-    size[0] = region_node_array[r].size();
-
-    //region cell number
-    size[1] = region_elem_array[r].size();
-
-    //boundary cell number
-    size[2] = 0;
-
-    std::string zone_name = region->name();
+    // map node id to local node index in this region, alloc max_node_id with invalid_uint
+    // it is a bit overkill in memory. however, i think vector is faster than map<id, local_id>
+    std::vector<unsigned int> node_id_to_region_node_id;
 
     if( Genius::processor_id() == 0)
     {
-      // write region name
-      genius_assert(!cg_zone_write(fn, B, zone_name.c_str(), size, Unstructured, &Z));
+      WriteJob::ZoneSnapshot & zone = job->zones[r];
 
-      // goto the current region
-      genius_assert(!cg_goto(fn,B,"Zone_t",Z,"end"));
+      zone.name = region->name();
+      zone.material = region->material();
 
-      // write down material
-      genius_assert(!cg_descriptor_write("Material", region->material().c_str() ));
-    }
+      // region node number
+      zone.size[0] = region_node_array[r].size();
+      //region cell number
+      zone.size[1] = region_elem_array[r].size();
+      //boundary cell number
+      zone.size[2] = 0;
 
-
-    // map node id to local node index in this region, alloc max_node_id with invalid_uint
-    // it is a bit overkill in memory. however, i think vector is faster than map<id, local_id>
-    std::vector<unsigned int> node_id_to_region_node_id(mesh.max_node_id (), invalid_uint);
-
-    if( Genius::processor_id() == 0)
-    {
-      std::vector<double> x;
-      std::vector<double> y;
-      std::vector<double> z;
-      x.reserve(size[0]);
-      y.reserve(size[0]);
-      z.reserve(size[0]);
-
-      // addtional information about global id of region node
-      std::vector<int> global_node_id;
-      global_node_id.reserve(size[0]);
+      node_id_to_region_node_id.resize(mesh.max_node_id (), invalid_uint);
 
       // set coordinates of each node in this zone
       unsigned int local_id = 1;
       for(unsigned int n=0; n<region_node_array[r].size(); ++n, ++local_id)
       {
-        //convert the unit to cm
         const Node * node = region_node_array[r][n];
-        x.push_back( (*node)(0)/cm );
-        y.push_back( (*node)(1)/cm );
-        z.push_back( (*node)(2)/cm );
-        // save global index of the region node
-        global_node_id.push_back(node->id());
         // save local node index, the we can find local node index by node id
         node_id_to_region_node_id[node->id()] = local_id;
+        // geometry is already in the time series file
+        if( append ) continue;
+        //convert the unit to cm
+        zone.x.push_back( (*node)(0)/cm );
+        zone.y.push_back( (*node)(1)/cm );
+        zone.z.push_back( (*node)(2)/cm );
+        // save global index of the region node
+        zone.global_node_id.push_back(node->id());
       }
-
-      // write down coordinates
-      cg_coord_write(fn, B, Z, RealDouble, "CoordinateX", &x[0], &C);
-      cg_coord_write(fn, B, Z, RealDouble, "CoordinateY", &y[0], &C);
-      cg_coord_write(fn, B, Z, RealDouble, "CoordinateZ", &z[0], &C);
-
-      // write the global index of region node into cgns file
-      genius_assert(!cg_goto(fn, B, "Zone_t", Z , "end"));
-      genius_assert(!cg_user_data_write ("Global_Node_Index"));
-      genius_assert(!cg_goto(fn, B, "Zone_t", Z, "UserDefinedData_t", 1, "end"));
-      genius_assert(!cg_array_write("index", Integer, 1, &size[0], &global_node_id[0]));
     }
 
 
@@ -1111,15 +1355,15 @@ void CGNSIO::write (const std::string& filename)
     // map elem->id() to the cell's index for cgns writing in this region
     std::map<unsigned int, int> elem_id_to_region_cell_index ;
 
-    if( Genius::processor_id() == 0)
+    if( Genius::processor_id() == 0 && !append )
     {
+      WriteJob::ZoneSnapshot & zone = job->zones[r];
       const std::vector<const Elem *> & region_elem = region_elem_array[r];
 
-      std::vector<int> elem_package;           // for element connectivity
-      std::vector<int> elem_attribute;         // for element attribute
-      std::vector<unsigned int> elem_id;
+      std::vector<int> & elem_package = zone.elem_package;     // for element connectivity
+      std::vector<int> & elem_attribute = zone.elem_attribute; // for element attribute
+      std::vector<int> & elem_id = zone.elem_id;
       elem_package.reserve(10*region_elem.size());// a bit overkill
-      elem_attribute.reserve(6*region_elem.size());
       elem_id.reserve(region_elem.size());
 
       for(unsigned int n=0; n < region_elem.size(); ++n)
@@ -1200,33 +1444,19 @@ void CGNSIO::write (const std::string& filename)
 
       }
 
-
       for(unsigned int n=0; n<elem_id.size(); n++)
         elem_id_to_region_cell_index[elem_id[n]] = n+1;
-
-      genius_assert(!cg_section_write(fn, B ,Z, "GridElements", MIXED, 1, elem_id.size(), 0, &elem_package[0], &S));
-#ifdef ENABLE_AMR
-      // write element amr attribute
-      int  elem_id_size = static_cast<int>(elem_id.size());
-      int  elem_attribute_size = static_cast<int>(elem_attribute.size());
-      genius_assert(!cg_goto(fn, B, "Zone_t", Z , "end"));
-      genius_assert(!cg_user_data_write ("Element_Attribute"));
-      genius_assert(!cg_goto(fn, B, "Zone_t", Z, "UserDefinedData_t", 2, "end"));
-      genius_assert(!cg_array_write("elem_id_array", Integer, 1, &elem_id_size, &elem_id[0]));
-      genius_assert(!cg_array_write("elem_attribute_array", Integer, 1, &elem_attribute_size, &elem_attribute[0]));
-#endif
-
     }
 
 
-    // write boundary condition into cgns file
+    // collect boundary condition, only electrode data is needed for later steps of time series
     if( Genius::processor_id() == 0 )
     {
+      WriteJob::ZoneSnapshot & zone = job->zones[r];
       const std::vector<unsigned int> & region_boundary = region_boundary_array[r];
 
       // the element-face boundary information
       std::map<short int, std::pair<std::vector<int>, std::vector<int> > > bd_info;
-      //std::map<short int, std::set< const Node * > > bd_node_info;
       {
         for(unsigned int n=0; n<region_boundary.size(); n++)
         {
@@ -1234,7 +1464,7 @@ void CGNSIO::write (const std::string& filename)
           const Elem * elem = mesh.elem(boundary_el[index]);
           genius_assert( elem->subdomain_id() == r);
 
-          bd_info[boundary_il[index]].first.push_back( elem_id_to_region_cell_index[boundary_el[index]] );
+          bd_info[boundary_il[index]].first.push_back( append ? 0 : elem_id_to_region_cell_index[boundary_el[index]] );
           bd_info[boundary_il[index]].second.push_back( boundary_sl[index] );
         }
       }
@@ -1244,61 +1474,42 @@ void CGNSIO::write (const std::string& filename)
       for( ; bd_info_it != bd_info.end(); ++bd_info_it)
       {
         short int bd_id = bd_info_it->first;
-        const std::vector<int> & elems =  bd_info_it->second.first;
-        const std::vector<int> & sides =  bd_info_it->second.second;
-
-        if( elems.empty() ) continue;
+        if( bd_info_it->second.first.empty() ) continue;
 
         const BoundaryCondition * bc = bcs->get_bc_by_bd_id(bd_id);
 
+        zone.boundaries.push_back(WriteJob::BoundarySnapshot());
+        WriteJob::BoundarySnapshot & bd = zone.boundaries.back();
+
+        // electrode potential
+        bd.electrode = bc->is_electrode();
+        if( bd.electrode )
+        {
+          bd.potential = bc->ext_circuit()->potential()/V;
+          bd.vapp = bc->ext_circuit()->Vapp()/V;
+          bd.iapp = bc->ext_circuit()->Iapp()/A;
+        }
+
+        // boundary geometry is already in the time series file
+        if( append ) continue;
+
         // collect boundary nodes
-        std::vector<int> bd_point;
         {
           const std::set<const Node *> & bd_nodes = boundary_side_nodes_id_map.find(bd_id)->second;
           for(std::set<const Node *>::const_iterator it=bd_nodes.begin(); it!=bd_nodes.end(); ++it)
               if( node_id_to_region_node_id[(*it)->id()] != invalid_uint )
-                bd_point.push_back(node_id_to_region_node_id[(*it)->id()]);
+                bd.points.push_back(node_id_to_region_node_id[(*it)->id()]);
         }
 
-        // now write down boundary information
-
-        // write a dummy bc label
+        // a dummy bc label
         char bc_label[32];
         sprintf( bc_label, "boundary_%d", bd_id );
+        bd.name = bc_label;
 
-        // boundary as point list
-        cg_boco_write(fn, B, Z, bc_label, BCTypeUserDefined, PointList, bd_point.size(), &bd_point[0], &BC);
-
-        // actual bc label is here
-        assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "end"));
-        assert(!cg_descriptor_write("bc_label", bc->label().c_str()));
-
-        // write boundary condition
-        assert(!cg_descriptor_write("bc_settings", bc->boundary_condition_in_string().c_str()));
-
-        // extra information as element-side list
-        int n_side =  sides.size();
-        assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "end"));
-        assert(!cg_user_data_write ("element_side_information"));
-        assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "UserDefinedData_t", 1, "end"));
-        assert(!cg_array_write("element_list", Integer, 1, &n_side, &elems[0]));
-        assert(!cg_array_write("side_list", Integer, 1, &n_side, &sides[0]));
-
-        // write electrode potential
-        if( bc->is_electrode() )
-        {
-          double potential = bc->ext_circuit()->potential()/V;
-          double vapp = bc->ext_circuit()->Vapp()/V;
-          double iapp = bc->ext_circuit()->Iapp()/A;
-          int    DimensionVector = 1;
-          assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "end"));
-          assert(!cg_user_data_write ("extra_data_for_electrode"));
-          assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "UserDefinedData_t", 2, "end"));
-          assert(!cg_array_write("electrode_potential", RealDouble, 1, &DimensionVector, &potential));
-          assert(!cg_array_write("electrode_vapp", RealDouble, 1, &DimensionVector, &vapp));
-          assert(!cg_array_write("electrode_iapp", RealDouble, 1, &DimensionVector, &iapp));
-        }
-
+        bd.label    = bc->label();
+        bd.settings = bc->boundary_condition_in_string();
+        bd.elems    = bd_info_it->second.first;
+        bd.sides    = bd_info_it->second.second;
       }
     }
 
@@ -1306,7 +1517,11 @@ void CGNSIO::write (const std::string& filename)
     // write zone 1-to-1 connect information
     // does this really needed?
 
-    // write solution data to cgns file
+    // solution data of this region
+    std::multimap< std::string, std::pair<SimulationVariable, std::vector<double> > >  region_data;
+    typedef std::multimap< std::string, std::pair<SimulationVariable, std::vector<double> > > region_data_map;
+    region_data_map::iterator region_data_it;
+
     switch ( region->type() )
     {
         case SemiconductorRegion :
@@ -1314,12 +1529,6 @@ void CGNSIO::write (const std::string& filename)
           bool sigle   = Material::IsSingleCompSemiconductor(region->material());
           bool complex = Material::IsComplexCompSemiconductor(region->material());
 
-          std::vector<unsigned int> region_node_id;
-
-          std::multimap< std::string, std::pair<SimulationVariable, std::vector<double> > >  region_data;
-          typedef std::multimap< std::string, std::pair<SimulationVariable, std::vector<double> > > region_data_map;
-          region_data_map::iterator region_data_it;
-
           region_data.insert( std::make_pair("Doping", std::make_pair(region->get_variable("na", POINT_CENTER), std::vector<double>())) );
           region_data.insert( std::make_pair("Doping", std::make_pair(region->get_variable("nd", POINT_CENTER), std::vector<double>())) );
 
@@ -1338,198 +1547,25 @@ void CGNSIO::write (const std::string& filename)
             region_data.insert( std::make_pair("Mole", std::make_pair(region->get_variable("mole_x", POINT_CENTER), std::vector<double>())) );
             region_data.insert( std::make_pair("Mole", std::make_pair(region->get_variable("mole_y", POINT_CENTER), std::vector<double>())) );
           }
-
-          std::vector<SimulationVariable> custom_variable;
-          region->get_user_defined_variable(POINT_CENTER, SCALAR, custom_variable);
-          for(unsigned int n=0; n<custom_variable.size(); ++n)
-            region_data.insert( std::make_pair("Custom", std::make_pair(custom_variable[n], std::vector<double>())) );
-
-
-          SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
-          SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
-          for(; node_it!=node_it_end; ++node_it)
-          {
-            const FVM_Node * fvm_node = (*node_it);
-            const FVM_NodeData * node_data = fvm_node->node_data();
-            genius_assert(node_data);
-
-            region_node_id.push_back(fvm_node->root_node()->id());
-
-            for( region_data_it = region_data.begin(); region_data_it != region_data.end(); ++region_data_it)
-            {
-              const SimulationVariable & variable = region_data_it->second.first;
-              region_data_it->second.second.push_back( node_data->data<double>( variable.variable_index ) / variable.variable_unit );
-            }
-          }
-
-          // synchronization data with other processor
-          Parallel::gather(0, region_node_id);
-
-          for( region_data_it = region_data.begin(); region_data_it != region_data.end(); ++region_data_it)
-            Parallel::gather(0, region_data_it->second.second);
-
-          if( Genius::processor_id() == 0)
-          {
-            std::vector<unsigned int> region_node_local_id;
-            for(unsigned int n=0; n<region_node_id.size(); ++n)
-              region_node_local_id.push_back( node_id_to_region_node_id[region_node_id[n]]-1 );
-
-            for( region_data_it = region_data.begin(); region_data_it != region_data.end(); )
-            {
-              const std::string & sol =  region_data_it->first;
-              genius_assert(!cg_sol_write  (fn, B, Z, sol.c_str(), Vertex, &SOL));
-              std::string path = std::string("/") + base_name + "/" + zone_name + "/" + sol;
-              std::pair <region_data_map::iterator, region_data_map::iterator>  bounds = region_data.equal_range(sol);
-              while (bounds.first != bounds.second)
-              {
-                const std::string & variable =  bounds.first->second.first.variable_name;
-                std::string variable_unit = variable + ".unit";
-                std::string variable_unit_string = bounds.first->second.first.variable_unit_string;
-                genius_assert(!cg_field_write(fn, B, Z, SOL, RealDouble, variable.c_str(),  &(_sort_it(bounds.first->second.second, region_node_local_id)[0]),   &F));
-                genius_assert(!cg_gopath(fn, path.c_str()));
-                genius_assert(!cg_descriptor_write(variable_unit.c_str(), variable_unit_string.c_str()));
-                ++bounds.first;
-              }
-              region_data_it = bounds.second;
-            }
-          }
-
           break;
         }
 
-
         case InsulatorRegion     :
         case ElectrodeRegion     :
         {
-          std::vector<unsigned int> region_node_id;
-
-          std::multimap< std::string, std::pair<SimulationVariable, std::vector<double> > >  region_data;
-          typedef std::multimap< std::string, std::pair<SimulationVariable, std::vector<double> > > region_data_map;
-          region_data_map::iterator region_data_it;
-
           region_data.insert( std::make_pair("Solution", std::make_pair(region->get_variable("potential", POINT_CENTER), std::vector<double>())) );
           region_data.insert( std::make_pair("Solution", std::make_pair(region->get_variable("temperature", POINT_CENTER), std::vector<double>())) );
-
-
-          std::vector<SimulationVariable> custom_variable;
-          region->get_user_defined_variable(POINT_CENTER, SCALAR, custom_variable);
-          for(unsigned int n=0; n<custom_variable.size(); ++n)
-            region_data.insert( std::make_pair("Custom", std::make_pair(custom_variable[n], std::vector<double>())) );
-
-          SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
-          SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
-          for(; node_it!=node_it_end; ++node_it)
-          {
-            const FVM_Node * fvm_node = (*node_it);
-            const FVM_NodeData * node_data = fvm_node->node_data();
-
-            region_node_id.push_back(fvm_node->root_node()->id());
-
-            for( region_data_it = region_data.begin(); region_data_it != region_data.end(); ++region_data_it)
-            {
-              const SimulationVariable & variable = region_data_it->second.first;
-              region_data_it->second.second.push_back( node_data->data<double>( variable.variable_index ) / variable.variable_unit );
-            }
-          }
-
-          // synchronization data with other processor
-          Parallel::gather(0, region_node_id);
-          for( region_data_it = region_data.begin(); region_data_it != region_data.end(); ++region_data_it)
-            Parallel::gather(0, region_data_it->second.second);
-
-          if( Genius::processor_id() == 0)
-          {
-            std::vector<unsigned int> region_node_local_id;
-            for(unsigned int n=0; n<region_node_id.size(); ++n)
-              region_node_local_id.push_back( node_id_to_region_node_id[region_node_id[n]]-1 );
-
-            for( region_data_it = region_data.begin(); region_data_it != region_data.end(); )
-            {
-              const std::string & sol =  region_data_it->first;
-              genius_assert(!cg_sol_write  (fn, B, Z, sol.c_str(), Vertex, &SOL));
-              std::string path = std::string("/") + base_name + "/" + zone_name + "/" + sol;
-              std::pair <region_data_map::iterator, region_data_map::iterator>  bounds = region_data.equal_range(sol);
-              while (bounds.first != bounds.second)
-              {
-                const std::string & variable =  bounds.first->second.first.variable_name;
-                std::string variable_unit = variable + ".unit";
-                std::string variable_unit_string = bounds.first->second.first.variable_unit_string;
-                genius_assert(!cg_field_write(fn, B, Z, SOL, RealDouble, variable.c_str(),  &(_sort_it(bounds.first->second.second, region_node_local_id)[0]),   &F));
-                genius_assert(!cg_gopath(fn, path.c_str()));
-                genius_assert(!cg_descriptor_write(variable_unit.c_str(), variable_unit_string.c_str()));
-                ++bounds.first;
-              }
-              region_data_it = bounds.second;
-            }
-          }
           break;
         }
+
         case MetalRegion         :
         {
-          std::vector<unsigned int> region_node_id;
-
-          std::multimap< std::string, std::pair<SimulationVariable, std::vector<double> > >  region_data;
-          typedef std::multimap< std::string, std::pair<SimulationVariable, std::vector<double> > > region_data_map;
-          region_data_map::iterator region_data_it;
-
           region_data.insert( std::make_pair("Solution", std::make_pair(region->get_variable("potential", POINT_CENTER), std::vector<double>())) );
           region_data.insert( std::make_pair("Solution", std::make_pair(region->get_variable("electron", POINT_CENTER), std::vector<double>())) );
           region_data.insert( std::make_pair("Solution", std::make_pair(region->get_variable("temperature", POINT_CENTER), std::vector<double>())) );
-
-
-          std::vector<SimulationVariable> custom_variable;
-          region->get_user_defined_variable(POINT_CENTER, SCALAR, custom_variable);
-          for(unsigned int n=0; n<custom_variable.size(); ++n)
-            region_data.insert( std::make_pair("Custom", std::make_pair(custom_variable[n], std::vector<double>())) );
-
-          SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
-          SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
-          for(; node_it!=node_it_end; ++node_it)
-          {
-            const FVM_Node * fvm_node = (*node_it);
-            const FVM_NodeData * node_data = fvm_node->node_data();
-
-            region_node_id.push_back(fvm_node->root_node()->id());
-
-            for( region_data_it = region_data.begin(); region_data_it != region_data.end(); ++region_data_it)
-            {
-              const SimulationVariable & variable = region_data_it->second.first;
-              region_data_it->second.second.push_back( node_data->data<double>( variable.variable_index ) / variable.variable_unit );
-            }
-          }
-
-          // synchronization data with other processor
-          Parallel::gather(0, region_node_id);
-          for( region_data_it = region_data.begin(); region_data_it != region_data.end(); ++region_data_it)
-            Parallel::gather(0, region_data_it->second.second);
-
-          if( Genius::processor_id() == 0)
-          {
-            std::vector<unsigned int> region_node_local_id;
-            for(unsigned int n=0; n<region_node_id.size(); ++n)
-              region_node_local_id.push_back( node_id_to_region_node_id[region_node_id[n]]-1 );
-
-            for( region_data_it = region_data.begin(); region_data_it != region_data.end(); )
-            {
-              const std::string & sol =  region_data_it->first;
-              genius_assert(!cg_sol_write  (fn, B, Z, sol.c_str(), Vertex, &SOL));
-              std::string path = std::string("/") + base_name + "/" + zone_name + "/" + sol;
-              std::pair <region_data_map::iterator, region_data_map::iterator>  bounds = region_data.equal_range(sol);
-              while (bounds.first != bounds.second)
-              {
-                const std::string & variable =  bounds.first->second.first.variable_name;
-                std::string variable_unit = variable + ".unit";
-                std::string variable_unit_string = bounds.first->second.first.variable_unit_string;
-                genius_assert(!cg_field_write(fn, B, Z, SOL, RealDouble, variable.c_str(),  &(_sort_it(bounds.first->second.second, region_node_local_id)[0]),   &F));
-                genius_assert(!cg_gopath(fn, path.c_str()));
-                genius_assert(!cg_descriptor_write(variable_unit.c_str(), variable_unit_string.c_str()));
-                ++bounds.first;
-              }
-              region_data_it = bounds.second;
-            }
-          }
           break;
         }
+
         // no solution data in vacuum region?
         case VacuumRegion     :
         break;
@@ -1542,35 +1578,215 @@ void CGNSIO::write (const std::string& filename)
           MESSAGE<<"ERROR: Unsupported region type found during CGNS export."<<std::endl; RECORD();
           genius_error();
         }
+    }
 
+    // doping and mole fraction do not change with time
+    if( append )
+    {
+      region_data.erase("Doping");
+      region_data.erase("Mole");
+    }
+
+    if( region_data.empty() ) continue;
+
+    std::vector<SimulationVariable> custom_variable;
+    region->get_user_defined_variable(POINT_CENTER, SCALAR, custom_variable);
+    for(unsigned int n=0; n<custom_variable.size(); ++n)
+      region_data.insert( std::make_pair("Custom", std::make_pair(custom_variable[n], std::vector<double>())) );
+
+    std::vector<unsigned int> region_node_id;
+
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * fvm_node = (*node_it);
+      const FVM_NodeData * node_data = fvm_node->node_data();
+      genius_assert(node_data);
+
+      region_node_id.push_back(fvm_node->root_node()->id());
+
+      for( region_data_it = region_data.begin(); region_data_it != region_data.end(); ++region_data_it)
+      {
+        const SimulationVariable & variable = region_data_it->second.first;
+        region_data_it->second.second.push_back( node_data->data<double>( variable.variable_index ) / variable.variable_unit );
+      }
+    }
+
+    // synchronization data with other processor
+    Parallel::gather(0, region_node_id);
+    for( region_data_it = region_data.begin(); region_data_it != region_data.end(); ++region_data_it)
+      Parallel::gather(0, region_data_it->second.second);
+
+    // the multimap keeps variables of the same solution node adjacent
+    if( Genius::processor_id() == 0)
+    {
+      WriteJob::ZoneSnapshot & zone = job->zones[r];
+
+      std::vector<unsigned int> region_node_local_id;
+      for(unsigned int n=0; n<region_node_id.size(); ++n)
+        region_node_local_id.push_back( node_id_to_region_node_id[region_node_id[n]]-1 );
+
+      for( region_data_it = region_data.begin(); region_data_it != region_data.end(); ++region_data_it)
+      {
+        zone.fields.push_back(WriteJob::FieldSnapshot());
+        WriteJob::FieldSnapshot & field = zone.fields.back();
+        field.sol      = solution_name(region_data_it->first, step);
+        field.variable = region_data_it->second.first.variable_name;
+        field.unit     = region_data_it->second.first.variable_unit_string;
+        field.value.swap( _sort_it(region_data_it->second.second, region_node_local_id) );
+      }
     }
 
   }
 
 
-  // write global boundary conditions, including interconnect and charge boundary
-  if( Genius::processor_id() == 0)
+  // global boundary conditions, including interconnect and charge boundary
+  if( Genius::processor_id() == 0 && !append )
   {
-    genius_assert(!cg_goto(fn,B,"end"));
-    assert(!cg_user_data_write ("ExtraBoundaryInfo"));
-    assert(!cg_goto(fn, B, "UserDefinedData_t", 1, "end"));
-    const BoundaryConditionCollector * bcs = system.get_bcs();
     for(unsigned int n=0; n<bcs->n_bcs(); ++n)
     {
       const BoundaryCondition * bc = bcs->get_bc(n);
 
       // interconnect bc
       if( bc->bc_type() == InterConnect || bc->bc_type() == ChargeIntegral)
+        job->extra_boundary_info.push_back( std::make_pair(bc->label(), bc->boundary_condition_in_string()) );
+    }
+  }
+
+  // everything is on processor 0 now, write cgns file
+  if( Genius::processor_id() == 0)
+  {
+    if(_background)
+      AsyncWriter::instance().submit(job);
+    else
+    {
+      // cgns library is not thread safe, wait for the background writes
+      AsyncWriter::instance().flush();
+      job->run();
+      delete job;
+    }
+  }
+
+}
+
+
+void CGNSIO::_distribute_solution()
+{
+  SimulationSystem & system = FieldInput<SimulationSystem>::system();
+
+  if(Genius::processor_id() != 0)
+  {
+    region_global_id.resize(system.n_regions());
+    region_global_id_to_node_id.resize(system.n_regions());
+    region_solutions.resize(system.n_regions());
+  }
+
+  for(unsigned int r=0; r<system.n_regions(); r++)
+  {
+    const SimulationRegion * region = system.region(r);
+
+    // the nodes of this region held by this processor
+    std::vector<unsigned int> node_ids;
+    SimulationRegion::const_local_node_iterator node_it = region->on_local_nodes_begin();
+    SimulationRegion::const_local_node_iterator node_it_end = region->on_local_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+      node_ids.push_back((*node_it)->root_node()->id());
+
+    std::vector<unsigned int> n_node_ids;
+    Parallel::gather(0, static_cast<unsigned int>(node_ids.size()), n_node_ids);
+    Parallel::gather(0, node_ids);
+
+    // processor 0 finds the position of requested nodes in the solution arrays
+    std::vector< std::vector<unsigned int> > positions;
+    std::vector< std::vector<unsigned int> > served_node_ids;
+    if(Genius::processor_id() == 0)
+    {
+      std::map<unsigned int, unsigned int> node_id_to_position;
+      for(unsigned int n=0; n<region_global_id[r].size(); n++)
+        node_id_to_position[region_global_id_to_node_id[r].find(region_global_id[r][n])->second] = n;
+
+      positions.resize(Genius::n_processors());
+      served_node_ids.resize(Genius::n_processors());
+      unsigned int offset = 0;
+      for(unsigned int p=0; p<Genius::n_processors(); p++)
       {
-        genius_assert(!cg_descriptor_write(bc->label().c_str(), bc->boundary_condition_in_string().c_str() ));
+        for(unsigned int i=offset; i<offset+n_node_ids[p]; i++)
+        {
+          std::map<unsigned int, unsigned int>::const_iterator pos_it = node_id_to_position.find(node_ids[i]);
+          if( pos_it == node_id_to_position.end() ) continue;
+          positions[p].push_back(pos_it->second);
+          served_node_ids[p].push_back(node_ids[i]);
+        }
+        offset += n_node_ids[p];
       }
     }
+
+    std::vector<unsigned int> local_node_ids;
+    Parallel::scatter(0, served_node_ids, local_node_ids);
+
+    unsigned int n_solutions = region_solutions[r].size();
+    Parallel::broadcast(n_solutions , 0);
+
+    // each processor only receives the values of its own nodes
+    std::map<std::pair<std::string,std::string>, std::vector<double> > local_solution;
+    std::map<std::pair<std::string,std::string>, std::vector<double> >::const_iterator it = region_solutions[r].begin();
+    for(unsigned int n=0; n<n_solutions; n++)
+    {
+      std::string sol_name;
+      std::string field_name;
+      std::vector< std::vector<double> > slices;
+      if(Genius::processor_id() == 0)
+      {
+        sol_name   = (*it).first.first;
+        field_name = (*it).first.second;
+        slices.resize(Genius::n_processors());
+        for(unsigned int p=0; p<Genius::n_processors(); p++)
+        {
+          slices[p].reserve(positions[p].size());
+          for(unsigned int k=0; k<positions[p].size(); k++)
+            slices[p].push_back( (*it).second[positions[p][k]] );
+        }
+        ++it;
+      }
+
+      Parallel::broadcast(sol_name   , 0);
+      Parallel::broadcast(field_name , 0);
+      Parallel::scatter(0, slices, local_solution[std::make_pair(sol_name, field_name)]);
+    }
+
+    // from now on, the solution arrays are indexed by local position
+    region_solutions[r].swap(local_solution);
+    region_global_id[r].resize(local_node_ids.size());
+    region_global_id_to_node_id[r].clear();
+    for(unsigned int k=0; k<local_node_ids.size(); k++)
+    {
+      region_global_id[r][k] = k;
+      region_global_id_to_node_id[r][k] = local_node_ids[k];
+    }
   }
+}
 
-  // close CGNS file
-  if( Genius::processor_id() == 0)
-    cg_close(fn);
 
+std::string CGNSIO::solution_name(const std::string & sol, int step)
+{
+  if( step == 0 ) return sol;
+
+  std::stringstream ss;
+  ss << sol << '_' << step;
+  return ss.str();
+}
+
+
+int CGNSIO::solution_step(const std::string & name, std::string & sol)
+{
+  sol = name;
+  std::string::size_type pos = name.rfind('_');
+  if( pos == std::string::npos || pos+1 == name.size() ) return 0;
+  if( name.find_first_not_of("0123456789", pos+1) != std::string::npos ) return 0;
+
+  sol = name.substr(0, pos);
+  return atoi(name.substr(pos+1).c_str());
 }
 
 
@@ -21,6 +21,8 @@
 
 //  $Id: control.cc,v 1.54 2008/07/09 12:56:23 gdiso Exp $
 
+#include <sstream>
+
 #include "genius_common.h"
 
 #ifdef WINDOWS
@@ -93,6 +95,8 @@
  #include "probe_hook.h"
  #include "vtk_hook.h"
 #include "cgns_hook.h"
+ #include "gsol_hook.h"
+ #include "ivstream_hook.h"
 #endif
 
 #ifdef ENABLE_VISIT
@@ -105,6 +109,7 @@
 #endif
 
 #include "parallel.h"
+#include "structure_cache.h"
 #include "MXMLUtil.h"
 
 using PhysicalUnit::A;
@@ -397,6 +402,11 @@ int SolverControl::set_method ( const Parser::Card & c )
   SolverSpecify::ksp_atol                  = c.get_real("ksp.atol", 1e-15);
   SolverSpecify::ksp_atol_fnorm            = c.get_real("ksp.atol.fnorm", 1e-7);
   SolverSpecify::ksp_singular              = c.get_bool("ksp.singular", false);
+  SolverSpecify::ksp_ew                    = c.get_bool("ksp.ew", false);
+  SolverSpecify::ksp_ew_rtol0              = c.get_real("ksp.ew.rtol0", 0.3);
+  SolverSpecify::ksp_ew_rtol_max           = c.get_real("ksp.ew.rtolmax", 0.9);
+  SolverSpecify::ksp_ew_gamma              = c.get_real("ksp.ew.gamma", 0.9);
+  SolverSpecify::ksp_ew_alpha              = c.get_real("ksp.ew.alpha", 2.0);
 
   //set convergence test
   SolverSpecify::MaxIteration              = c.get_int("maxiteration", 30);
@@ -1070,6 +1080,10 @@ int SolverControl::do_solve( const Parser::Card & c )
         hook = new CGNSHook(*solver, "cgns_hook", (void *)(&(it->second.second)));
       if((*it).second.first=="vtk")
         hook = new VTKHook(*solver, "vtk_hook", (void *)(&(it->second.second)));
+      if((*it).second.first=="gsol")
+        hook = new GSOLHook(*solver, "gsol_hook", (void *)(&(it->second.second)));
+      if((*it).second.first=="ivstream")
+        hook = new IVStreamHook(*solver, "ivstream_hook", (void *)(&(it->second.second)));
       if((*it).second.first=="cv")
         hook = new CVHook (*solver, "cv_hook",  (void *)(&(it->second.second)));
       if((*it).second.first=="probe")
@@ -1251,6 +1265,20 @@ int SolverControl::do_export( const Parser::Card & c )
     system().export_cgns(cgns_filename);
   }
 
+  // if export to native binary solution file is required
+  if(c.is_parameter_exist("gsolfile"))
+  {
+    std::string gsol_filename = c.get_string("gsolfile", "");
+    system().export_gsol(gsol_filename, c.get_real("gsol.precision", 0.0), c.get_bool("gsol.compress", true), SolverSpecify::clock);
+  }
+
+  // if checkpoint of full solver state is required
+  if(c.is_parameter_exist("checkpoint"))
+  {
+    std::string checkpoint_filename = c.get_string("checkpoint", "");
+    system().export_checkpoint(checkpoint_filename);
+  }
+
   // if export to CGNS format is required
   if(c.is_parameter_exist("isefile"))
   {
@@ -1317,6 +1345,13 @@ int SolverControl::do_export( const Parser::Card & c )
 
 int SolverControl::do_import( const Parser::Card & c )
 {
+  // the parsed structure of tif/tif3d/silvaco/df-ise file is cached next to the source
+  bool use_cache = c.get_bool("cache", true);
+  // the regions are initialized by the environment temperature, which is part of the cache key
+  std::stringstream cache_temperature;
+  cache_temperature << ':' << system().T_external();
+  const std::string cache_suffix = cache_temperature.str();
+
   if(c.is_parameter_exist("cgnsfile"))
   {
     std::string cgns_filename = c.get_string("cgnsfile", "");
@@ -1329,7 +1364,7 @@ int SolverControl::do_import( const Parser::Card & c )
       MESSAGE<<"ERROR at " <<c.get_fileline()<< " IMPORT: CGNSFile " << cgns_filename << " doesn't exist." << std::endl; RECORD();
       genius_error();
     }
-    system().import_cgns(cgns_filename);
+    system().import_cgns(cgns_filename, c.get_int("step", -1));
   }
 
   if(c.is_parameter_exist("vtkfile"))
@@ -1347,6 +1382,36 @@ int SolverControl::do_import( const Parser::Card & c )
     system().import_vtk(vtk_filename);
   }
 
+  if(c.is_parameter_exist("gsolfile"))
+  {
+    std::string gsol_filename = c.get_string("gsolfile", "");
+#ifdef WINDOWS
+    if ( _access( (char *)gsol_filename.c_str(),  04 ) == -1 )
+#else
+    if (  access( (char *)gsol_filename.c_str(),  R_OK ) == -1 )
+#endif
+    {
+      MESSAGE<<"ERROR at " <<c.get_fileline()<< " IMPORT: GSOLFile " << gsol_filename << " doesn't exist." << std::endl; RECORD();
+      genius_error();
+    }
+    system().import_gsol(gsol_filename);
+  }
+
+  if(c.is_parameter_exist("restart"))
+  {
+    std::string checkpoint_filename = c.get_string("restart", "");
+#ifdef WINDOWS
+    if ( _access( (char *)checkpoint_filename.c_str(),  04 ) == -1 )
+#else
+    if (  access( (char *)checkpoint_filename.c_str(),  R_OK ) == -1 )
+#endif
+    {
+      MESSAGE<<"ERROR at " <<c.get_fileline()<< " IMPORT: checkpoint " << checkpoint_filename << " doesn't exist." << std::endl; RECORD();
+      genius_error();
+    }
+    system().import_checkpoint(checkpoint_filename);
+  }
+
   if(c.is_parameter_exist("silvacofile"))
   {
     std::string silvaco_filename = c.get_string("silvacofile", "");
@@ -1359,7 +1424,13 @@ int SolverControl::do_import( const Parser::Card & c )
       MESSAGE<<"ERROR at " <<c.get_fileline()<< " IMPORT: Silvaco File " << silvaco_filename << " doesn't exist." << std::endl; RECORD();
       genius_error();
     }
-    system().import_silvaco(silvaco_filename);
+    std::vector<std::string> sources(1, silvaco_filename);
+    std::string cache_file = use_cache ? structure_cache_file(sources, "silvaco" + cache_suffix) : std::string();
+    if( cache_file.empty() || !system().import_structure_cache(cache_file) )
+    {
+      system().import_silvaco(silvaco_filename);
+      if( !cache_file.empty() ) system().export_structure_cache(cache_file);
+    }
   }
 
 
@@ -1375,7 +1446,13 @@ int SolverControl::do_import( const Parser::Card & c )
       MESSAGE<<"ERROR at " <<c.get_fileline()<< " IMPORT: TIFFile " << tif_filename << " doesn't exist." << std::endl; RECORD();
       genius_error();
     }
-    system().import_tif(tif_filename);
+    std::vector<std::string> sources(1, tif_filename);
+    std::string cache_file = use_cache ? structure_cache_file(sources, "tif" + cache_suffix) : std::string();
+    if( cache_file.empty() || !system().import_structure_cache(cache_file) )
+    {
+      system().import_tif(tif_filename);
+      if( !cache_file.empty() ) system().export_structure_cache(cache_file);
+    }
   }
 
   if(c.is_parameter_exist("tif3dfile"))
@@ -1390,14 +1467,28 @@ int SolverControl::do_import( const Parser::Card & c )
       MESSAGE<<"ERROR at " <<c.get_fileline()<< " IMPORT: TIF3DFile " << tif3d_filename << " doesn't exist." << std::endl; RECORD();
       genius_error();
     }
-    system().import_tif3d(tif3d_filename);
+    std::vector<std::string> sources(1, tif3d_filename);
+    std::string cache_file = use_cache ? structure_cache_file(sources, "tif3d" + cache_suffix) : std::string();
+    if( cache_file.empty() || !system().import_structure_cache(cache_file) )
+    {
+      system().import_tif3d(tif3d_filename);
+      if( !cache_file.empty() ) system().export_structure_cache(cache_file);
+    }
   }
 
 
   if(c.is_parameter_exist("isefile"))
   {
     std::string ise_filename = c.get_string("isefile", "");
-    system().import_ise(ise_filename);
+    std::vector<std::string> sources;
+    sources.push_back(ise_filename + ".grd");
+    sources.push_back(ise_filename + ".dat");
+    std::string cache_file = use_cache ? structure_cache_file(sources, "dfise" + cache_suffix) : std::string();
+    if( cache_file.empty() || !system().import_structure_cache(cache_file) )
+    {
+      system().import_ise(ise_filename);
+      if( !cache_file.empty() ) system().export_structure_cache(cache_file);
+    }
   }
 
   return 0;
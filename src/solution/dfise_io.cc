@@ -46,6 +46,40 @@ using PhysicalUnit::V;
 using PhysicalUnit::K;
 using PhysicalUnit::eV;
 
+
+/**
+ * the datasets used to set doping, other datasets in the file are not loaded.
+ * active concentration is preferred to the chemical one of each species
+ */
+static const char * dfise_doping_datasets[] =
+{
+  "DopingConcentration",
+  "TotalConcentration",
+  "PhosphorusActiveConcentration",
+  "PhosphorusConcentration",
+  "ArsenicActiveConcentration",
+  "ArsenicConcentration",
+  "AntimonyActiveConcentration",
+  "AntimonyConcentration",
+  "BoronActiveConcentration",
+  "BoronConcentration"
+};
+
+static const unsigned int n_dfise_doping_datasets = sizeof(dfise_doping_datasets)/sizeof(dfise_doping_datasets[0]);
+
+/**
+ * name patterns given to the parser, species names are fuzzy matched
+ */
+static const char * dfise_dataset_patterns[] =
+{
+  "DopingConcentration",
+  "TotalConcentration",
+  "Phosphorus",
+  "Arsenic",
+  "Antimony",
+  "Boron"
+};
+
 /**
  * This method implements reading a mesh from a specified file
  * in DF-ISE format.
@@ -63,6 +97,9 @@ void DFISEIO::read (const std::string& filename)
 
   if( Genius::processor_id() == 0)
   {
+    // only load the datasets we need
+    std::vector<std::string> patterns(dfise_dataset_patterns, dfise_dataset_patterns + sizeof(dfise_dataset_patterns)/sizeof(dfise_dataset_patterns[0]));
+    ise_reader->set_dataset_filter(patterns);
     ise_reader->parse_dfise(filename);
 
     const DFISE::INFO & grid_info = ise_reader->get_grid_info();
@@ -126,33 +163,7 @@ void DFISEIO::read (const std::string& filename)
   system.sync_print_info();
 
 
-  /*
-   * after that, set doping infomation, this should be done for all the processors
-   */
-  unsigned int n_datasets = ise_reader->n_datasets();
-  Parallel::broadcast(n_datasets);
-
-  //for each dataset
-  for(unsigned int n=0; n<n_datasets; ++n)
-  {
-    DFISE::DATASET * dataset = NULL;
-    if(Genius::processor_id() == 0)
-      dataset = ise_reader->get_dataset(n);
-    else
-      dataset = new DFISE::DATASET;
-
-    // broadcast critical data in this dataset
-    Parallel::broadcast(dataset->name);
-    Parallel::broadcast(dataset->Regions);
-    Parallel::broadcast(dataset->Scalar_Values);
-    Parallel::broadcast(dataset->node_to_value_index_map);
-
-    if(Genius::processor_id() != 0)
-      ise_reader->add_dataset(dataset);
-  }
-
-
-  // set node id to dfise node index map, this should be same for all the processors
+  // set node id to dfise node index map, only processor 0 holds the datasets
   if( Genius::processor_id() == 0)
   {
     std::map<Node *, unsigned int>::iterator it = _node_to_dfise_node_index_map.begin();
@@ -160,8 +171,10 @@ void DFISEIO::read (const std::string& filename)
       _node_id_to_dfise_node_index_map[(*it).first->id()] = (*it).second;
   }
 
-  // broadcast _node_id_to_dfise_node_index_map to all the processors
-  Parallel::broadcast(_node_id_to_dfise_node_index_map);
+  /*
+   * after that, send doping infomation to the processors which own the nodes
+   */
+  _distribute_doping();
 
   // setup each region
   _set_region();
@@ -547,12 +560,83 @@ void DFISEIO::_set_boundary(const DFISE::INFO & grid_info)
 }
 
 
+void DFISEIO::_distribute_doping()
+{
+  SimulationSystem & system = FieldInput<SimulationSystem>::system();
+
+  const unsigned int n_flags = n_dfise_doping_datasets + 1;
+
+  // which dataset is valid in each region, the last flag for any species dataset
+  _doping_flags.assign(system.n_regions()*n_flags, 0);
+  if( Genius::processor_id() == 0)
+  {
+    for(unsigned int r=0; r<system.n_regions(); r++)
+    {
+      for(unsigned int q=0; q<n_dfise_doping_datasets; ++q)
+        _doping_flags[r*n_flags + q] = ise_reader->is_value_exist(dfise_doping_datasets[q], r);
+
+      _doping_flags[r*n_flags + n_dfise_doping_datasets] = ( ise_reader->is_value_exist_fuzzy("Boron", r) ||
+                                                             ise_reader->is_value_exist_fuzzy("Phosphorus", r) ||
+                                                             ise_reader->is_value_exist_fuzzy("Arsenic", r) ||
+                                                             ise_reader->is_value_exist_fuzzy("Antimony", r) );
+    }
+  }
+  Parallel::broadcast(_doping_flags);
+
+  // request the values of local nodes in semiconductor regions, as (region, node id) pair
+  std::vector<unsigned int> requests;
+  for(unsigned int r=0; r<system.n_regions(); r++)
+  {
+    const SimulationRegion * region = system.region(r);
+    if( region->type() != SemiconductorRegion ) continue;
+
+    SimulationRegion::const_local_node_iterator node_it = region->on_local_nodes_begin();
+    SimulationRegion::const_local_node_iterator node_it_end = region->on_local_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      requests.push_back(r);
+      requests.push_back((*node_it)->root_node()->id());
+    }
+  }
+
+  std::vector<unsigned int> n_requests;
+  Parallel::gather(0, static_cast<unsigned int>(requests.size()), n_requests);
+  Parallel::gather(0, requests);
+
+  // processor 0 evaluates the values for each processor
+  std::vector< std::vector<double> > values;
+  if( Genius::processor_id() == 0)
+  {
+    values.resize(Genius::n_processors());
+
+    unsigned int offset = 0;
+    for(unsigned int p=0; p<Genius::n_processors(); ++p)
+    {
+      values[p].reserve(n_requests[p]/2*n_dfise_doping_datasets);
+      for(unsigned int i=offset; i<offset+n_requests[p]; i+=2)
+      {
+        unsigned int r = requests[i];
+        unsigned int dfise_node_index = _node_id_to_dfise_node_index_map[requests[i+1]];
+        for(unsigned int q=0; q<n_dfise_doping_datasets; ++q)
+          values[p].push_back( _doping_flags[r*n_flags + q] ? ise_reader->get_scaler_value(dfise_doping_datasets[q], r, dfise_node_index) : 0.0 );
+      }
+      offset += n_requests[p];
+    }
+  }
+
+  Parallel::scatter(0, values, _local_doping);
+}
+
+
 void DFISEIO::_set_region()
 {
   SimulationSystem & system = FieldInput<SimulationSystem>::system();
 
   const double doping_scale = pow(cm, -3);
 
+  // position in _local_doping
+  unsigned int doping_offset = 0;
+
   // ok, we had got enough informations for set up each simulation region
   for(unsigned int r=0; r<system.n_regions(); r++)
   {
@@ -562,13 +646,11 @@ void DFISEIO::_set_region()
     {
         case SemiconductorRegion :
         {
-          bool has_net_doping_concentration = ise_reader->is_value_exist("DopingConcentration", r);
-          bool has_total_doping_concentration = ise_reader->is_value_exist("TotalConcentration", r);
+          const int * flags = &_doping_flags[r*(n_dfise_doping_datasets+1)];
+          bool has_net_doping_concentration = flags[0];
+          bool has_total_doping_concentration = flags[1];
+          bool species_doping_concentration = flags[n_dfise_doping_datasets];
 
-          bool species_doping_concentration = ( ise_reader->is_value_exist_fuzzy("Boron", r) ||
-                                                ise_reader->is_value_exist_fuzzy("Phosphorus", r) ||
-                                                ise_reader->is_value_exist_fuzzy("Arsenic", r) ||
-                                                ise_reader->is_value_exist_fuzzy("Antimony", r) );
           unsigned int Boron_index=invalid_uint, Phosphorus_index=invalid_uint, Arsenic_index=invalid_uint, Antimony_index=invalid_uint;
           // add variables to this region
           if( species_doping_concentration )
@@ -586,34 +668,19 @@ void DFISEIO::_set_region()
             FVM_Node * fvm_node = (*node_it);
 
             FVM_NodeData * node_data = fvm_node->node_data();  genius_assert(node_data);
-            unsigned int dfise_node_index = _node_id_to_dfise_node_index_map[fvm_node->root_node()->id()];
-
-            double NetConcentration = ise_reader->get_scaler_value("DopingConcentration", r, dfise_node_index)* doping_scale;
-            double TotalConcentration = ise_reader->get_scaler_value("TotalConcentration", r, dfise_node_index)* doping_scale;
-
-            double Phosphorus=0.0;
-            if( ise_reader->is_value_exist("PhosphorusActiveConcentration", r) )
-              Phosphorus = ise_reader->get_scaler_value("PhosphorusActiveConcentration", r, dfise_node_index)* doping_scale;
-            else if( ise_reader->is_value_exist("PhosphorusConcentration", r) )
-              Phosphorus = ise_reader->get_scaler_value("PhosphorusConcentration", r, dfise_node_index)* doping_scale;
-
-            double Arsenic=0.0;
-            if( ise_reader->is_value_exist("ArsenicActiveConcentration", r) )
-              Arsenic = ise_reader->get_scaler_value("ArsenicActiveConcentration", r, dfise_node_index)* doping_scale;
-            else if( ise_reader->is_value_exist("ArsenicConcentration", r) )
-              Arsenic = ise_reader->get_scaler_value("ArsenicConcentration", r, dfise_node_index)* doping_scale;
-
-            double Antimony=0.0;
-            if( ise_reader->is_value_exist("AntimonyActiveConcentration", r) )
-              Antimony = ise_reader->get_scaler_value("AntimonyActiveConcentration", r, dfise_node_index)* doping_scale;
-            else if( ise_reader->is_value_exist("AntimonyConcentration", r) )
-              Antimony = ise_reader->get_scaler_value("AntimonyConcentration", r, dfise_node_index)* doping_scale;
-
-            double Boron=0.0;
-            if( ise_reader->is_value_exist("BoronActiveConcentration", r) )
-              Boron = ise_reader->get_scaler_value("BoronActiveConcentration", r, dfise_node_index)* doping_scale;
-            else if( ise_reader->is_value_exist("BoronConcentration", r) )
-              Boron = ise_reader->get_scaler_value("BoronConcentration", r, dfise_node_index)* doping_scale;
+
+            // values received from processor 0, in the order of dfise_doping_datasets
+            genius_assert(doping_offset + n_dfise_doping_datasets <= _local_doping.size());
+            const double * v = &_local_doping[doping_offset];
+            doping_offset += n_dfise_doping_datasets;
+
+            double NetConcentration = v[0]*doping_scale;
+            double TotalConcentration = v[1]*doping_scale;
+
+            double Phosphorus = (flags[2] ? v[2] : v[3])*doping_scale;
+            double Arsenic    = (flags[4] ? v[4] : v[5])*doping_scale;
+            double Antimony   = (flags[6] ? v[6] : v[7])*doping_scale;
+            double Boron      = (flags[8] ? v[8] : v[9])*doping_scale;
 
 
             // Have species doping concentration and don't have DopingConcentration
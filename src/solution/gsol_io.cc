@@ -0,0 +1,712 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+// C++ includes
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// Local includes
+#include "gsol_io.h"
+#include "simulation_system.h"
+#include "simulation_region.h"
+#include "fvm_node_info.h"
+#include "parallel.h"
+#include "async_writer.h"
+#include "boundary_condition_collector.h"
+#include "spice_ckt.h"
+#include "solver_specify.h"
+#include "perf_log.h"
+
+
+namespace
+{
+  typedef unsigned long long gsol_size_t;
+
+  const char         gsol_magic[4]    = {'G', 'S', 'O', 'L'};
+  const unsigned int gsol_version     = 2;
+  const unsigned int gsol_byte_order  = 0x01020304;
+
+  // mantissa bits of IEEE double
+  const unsigned int gsol_lossless_bits = 52;
+
+  template <typename T>
+  inline void gsol_put(std::ostream & out, const T & value)
+  { out.write(reinterpret_cast<const char *>(&value), sizeof(T)); }
+
+  inline void gsol_put_string(std::ostream & out, const std::string & str)
+  {
+    gsol_put(out, static_cast<unsigned int>(str.size()));
+    out.write(str.c_str(), str.size());
+  }
+
+  template <typename T>
+  inline void gsol_get(std::istream & in, T & value)
+  { in.read(reinterpret_cast<char *>(&value), sizeof(T)); }
+
+  inline void gsol_get_string(std::istream & in, std::string & str)
+  {
+    unsigned int size;
+    gsol_get(in, size);
+    str.resize(size);
+    if(size) in.read(&str[0], size);
+  }
+
+  /**
+   * round off the low mantissa bits of doubles, only keep_bits are kept.
+   * relative error is bounded by 2^-(keep_bits+1). inf/nan are not touched
+   */
+  void gsol_round_mantissa(double * values, size_t n, unsigned int keep_bits)
+  {
+    if( keep_bits >= gsol_lossless_bits ) return;
+
+    const gsol_size_t drop     = gsol_lossless_bits - keep_bits;
+    const gsol_size_t half     = static_cast<gsol_size_t>(1) << (drop - 1);
+    const gsol_size_t mask     = ~((static_cast<gsol_size_t>(1) << drop) - 1);
+    const gsol_size_t exponent = static_cast<gsol_size_t>(0x7ff) << gsol_lossless_bits;
+
+    for(size_t i=0; i<n; ++i)
+    {
+      gsol_size_t bits;
+      std::memcpy(&bits, values+i, sizeof(double));
+      if( (bits & exponent) == exponent ) continue;
+
+      gsol_size_t rounded = (bits + half) & mask;
+      // rounding must not overflow to inf
+      if( (rounded & exponent) == exponent ) rounded = bits & mask;
+      std::memcpy(values+i, &rounded, sizeof(double));
+    }
+  }
+
+  /**
+   * mantissa bits required for given relative error bound
+   */
+  unsigned int gsol_keep_bits(double precision)
+  {
+    if( precision <= 0.0 ) return gsol_lossless_bits;
+    int bits = static_cast<int>(std::ceil(-std::log(precision)/std::log(2.0))) - 1;
+    if( bits < 1 ) bits = 1;
+    if( bits > static_cast<int>(gsol_lossless_bits) ) bits = gsol_lossless_bits;
+    return bits;
+  }
+}
+
+
+
+/**
+ * a column of a region piece. the data is referenced directly from the region
+ * DataStorage when possible. vector/tensor blocks are not plain Real arrays,
+ * they are gathered chunk by chunk at writing.
+ */
+struct GSOLColumn
+{
+  std::string  name;
+  std::string  unit;
+  unsigned int data_type;
+  unsigned int n_components;
+  unsigned int value_size;
+  unsigned int keep_bits;
+
+  /**
+   * continuous data, n_rows*n_components values of value_size
+   */
+  const char * data;
+
+  /**
+   * own copy of data when required
+   */
+  std::vector<char> copy;
+
+  /**
+   * storage of vector/tensor variable when data is NULL
+   */
+  const DataStorage * storage;
+  unsigned int variable_index;
+};
+
+
+struct GSOLRegion
+{
+  std::string  name;
+  unsigned int n_rows;
+  std::vector<GSOLColumn> columns;
+};
+
+
+
+/**
+ * serialize the pieces of regions. it can be run at once or by the AsyncWriter
+ * I/O thread, in the later case all the columns hold their own copy
+ */
+class GSOLIO::WriteJob : public AsyncWriter::Job
+{
+public:
+  WriteJob(const std::string &name, unsigned int n_pieces, unsigned int piece, double time,
+           unsigned int chunk_rows, bool compress)
+  : _name(name), _n_pieces(n_pieces), _piece(piece), _time(time), _chunk_rows(chunk_rows), _compress(compress)
+  {}
+
+  std::vector<GSOLRegion> & regions()
+  { return _regions; }
+
+  std::map<std::string, std::vector<double> > & states()
+  { return _states; }
+
+  /**
+   * copy referenced data into columns, must be called before submit to AsyncWriter
+   */
+  void make_own_copy()
+  {
+    for(unsigned int r=0; r<_regions.size(); ++r)
+      for(unsigned int c=0; c<_regions[r].columns.size(); ++c)
+      {
+        GSOLColumn & column = _regions[r].columns[c];
+        if(!column.copy.empty() || _regions[r].n_rows == 0) continue;
+
+        const size_t row_size = column.n_components*column.value_size;
+        column.copy.resize(_regions[r].n_rows*row_size);
+        for(unsigned int row=0; row<_regions[r].n_rows; row+=_chunk_rows)
+        {
+          unsigned int n = std::min(_chunk_rows, _regions[r].n_rows - row);
+          const char * src = _chunk_data(column, row, n, &column.copy[row*row_size]);
+          if(src != &column.copy[row*row_size])
+            std::memcpy(&column.copy[row*row_size], src, n*row_size);
+        }
+        column.data = &column.copy[0];
+        column.storage = NULL;
+      }
+  }
+
+  virtual void run()
+  {
+    std::ofstream out(_name.c_str(), std::ios::binary | std::ios::trunc);
+    if(!out.good())
+    {
+      std::cerr<<"ERROR: can not open GSOL file "<<_name<<" for writing."<<std::endl;
+      return;
+    }
+
+    out.write(gsol_magic, 4);
+    gsol_put(out, gsol_version);
+    gsol_put(out, gsol_byte_order);
+    gsol_put(out, _n_pieces);
+    gsol_put(out, _piece);
+    gsol_put(out, _time);
+    gsol_put(out, static_cast<unsigned int>(_regions.size()));
+
+    std::vector<char> chunk;
+    std::vector<char> packed;
+
+    for(unsigned int r=0; r<_regions.size(); ++r)
+    {
+      const GSOLRegion & region = _regions[r];
+      gsol_put_string(out, region.name);
+      gsol_put(out, region.n_rows);
+      // the first column is node id
+      gsol_put(out, static_cast<unsigned int>(region.columns.size()-1));
+
+      for(unsigned int c=0; c<region.columns.size(); ++c)
+      {
+        const GSOLColumn & column = region.columns[c];
+        const unsigned int n_chunks = (region.n_rows + _chunk_rows - 1)/_chunk_rows;
+
+        gsol_put_string(out, column.name);
+        gsol_put_string(out, column.unit);
+        gsol_put(out, column.data_type);
+        gsol_put(out, column.n_components);
+        gsol_put(out, column.value_size);
+        gsol_put(out, column.keep_bits);
+        gsol_put(out, _chunk_rows);
+        gsol_put(out, n_chunks);
+
+        const size_t row_size = column.n_components*column.value_size;
+        for(unsigned int row=0; row<region.n_rows; row+=_chunk_rows)
+        {
+          const unsigned int n = std::min(_chunk_rows, region.n_rows - row);
+          const gsol_size_t raw_size = n*row_size;
+
+          if(chunk.size() < raw_size) chunk.resize(raw_size);
+          const char * raw = _chunk_data(column, row, n, &chunk[0]);
+
+          // lossy columns are modified in the chunk buffer, never in the solution
+          if( column.keep_bits < gsol_lossless_bits )
+          {
+            if(raw != &chunk[0]) std::memcpy(&chunk[0], raw, raw_size);
+            gsol_round_mantissa(reinterpret_cast<double *>(&chunk[0]), n*column.n_components, column.keep_bits);
+            raw = &chunk[0];
+          }
+
+          gsol_size_t stored_size = raw_size;
+#ifdef HAVE_ZLIB
+          if(_compress)
+          {
+            uLongf dest_size = compressBound(raw_size);
+            if(packed.size() < dest_size) packed.resize(dest_size);
+            if( compress2(reinterpret_cast<Bytef *>(&packed[0]), &dest_size,
+                          reinterpret_cast<const Bytef *>(raw), raw_size, Z_DEFAULT_COMPRESSION) == Z_OK &&
+                dest_size < raw_size )
+            {
+              stored_size = dest_size;
+              raw = &packed[0];
+            }
+          }
+#endif
+          gsol_put(out, raw_size);
+          gsol_put(out, stored_size);
+          out.write(raw, stored_size);
+        }
+      }
+    }
+
+    gsol_put(out, static_cast<unsigned int>(_states.size()));
+    std::map<std::string, std::vector<double> >::const_iterator state_it = _states.begin();
+    for(; state_it != _states.end(); ++state_it)
+    {
+      gsol_put_string(out, state_it->first);
+      gsol_put(out, static_cast<unsigned int>(state_it->second.size()));
+      if(!state_it->second.empty())
+        out.write(reinterpret_cast<const char *>(&state_it->second[0]), state_it->second.size()*sizeof(double));
+    }
+
+    if(!out.good())
+      std::cerr<<"ERROR: write GSOL file "<<_name<<" failed."<<std::endl;
+  }
+
+  virtual size_t memory_size() const
+  {
+    size_t size = 0;
+    for(unsigned int r=0; r<_regions.size(); ++r)
+      for(unsigned int c=0; c<_regions[r].columns.size(); ++c)
+        size += _regions[r].columns[c].copy.size();
+    return size;
+  }
+
+  virtual std::string file_name() const
+  { return _name; }
+
+private:
+
+  /**
+   * @return pointer to n rows of column begin at row. buf (of n rows) is used when
+   * the column is not continuous in memory
+   */
+  const char * _chunk_data(const GSOLColumn & column, unsigned int row, unsigned int n, char * buf) const
+  {
+    const size_t row_size = column.n_components*column.value_size;
+    if(column.data) return column.data + row*row_size;
+
+    Real * values = reinterpret_cast<Real *>(buf);
+    for(unsigned int i=0; i<n; ++i)
+      column.storage->get_components(static_cast<DataType>(column.data_type), column.variable_index, row+i, values + i*column.n_components);
+    return buf;
+  }
+
+  std::string  _name;
+  unsigned int _n_pieces;
+  unsigned int _piece;
+  double       _time;
+  unsigned int _chunk_rows;
+  bool         _compress;
+
+  std::vector<GSOLRegion> _regions;
+
+  std::map<std::string, std::vector<double> > _states;
+};
+
+
+
+std::string GSOLIO::piece_name(const std::string & name, unsigned int p)
+{
+  if(p == 0) return name;
+  std::stringstream ss;
+  ss << name << '.' << p;
+  return ss.str();
+}
+
+
+
+void GSOLIO::write (const std::string& filename)
+{
+  START_LOG("write()", "GSOLIO");
+
+  const SimulationSystem & system = FieldOutput<SimulationSystem>::system();
+  // checkpoint is always lossless
+  const unsigned int keep_bits = _checkpoint ? gsol_lossless_bits : gsol_keep_bits(_precision);
+
+  WriteJob * job = new WriteJob(piece_name(filename, Genius::processor_id()), Genius::n_processors(),
+                                Genius::processor_id(), _time, std::max(_chunk_rows, 1u), _compress);
+
+  for(unsigned int r=0; r<system.n_regions(); r++)
+  {
+    const SimulationRegion * region = system.region(r);
+    const DataStorage & storage = region->node_data_storage();
+
+    job->regions().push_back(GSOLRegion());
+    GSOLRegion & piece = job->regions().back();
+    piece.name   = region->name();
+    piece.n_rows = storage.size();
+
+    // node id column, ghost nodes are written by their owner except for checkpoint
+    {
+      GSOLColumn column;
+      column.name         = "node_id";
+      column.data_type    = INVALID_DATATYPE;
+      column.n_components = 1;
+      column.value_size   = sizeof(unsigned int);
+      column.keep_bits    = gsol_lossless_bits;
+      column.storage      = NULL;
+      column.variable_index = invalid_uint;
+
+      std::vector<unsigned int> ids(piece.n_rows, invalid_uint);
+      SimulationRegion::const_local_node_iterator node_it = region->on_local_nodes_begin();
+      SimulationRegion::const_local_node_iterator node_it_end = region->on_local_nodes_end();
+      for(; node_it!=node_it_end; ++node_it)
+      {
+        const FVM_Node * fvm_node = *node_it;
+        if( !_checkpoint && !fvm_node->on_processor() ) continue;
+        ids[fvm_node->node_data()->offset()] = fvm_node->root_node()->id();
+      }
+
+      if(piece.n_rows)
+        column.copy.assign(reinterpret_cast<const char *>(&ids[0]), reinterpret_cast<const char *>(&ids[0]) + piece.n_rows*sizeof(unsigned int));
+      column.data = column.copy.empty() ? NULL : &column.copy[0];
+      piece.columns.push_back(column);
+    }
+
+    const std::map<std::string, SimulationVariable> & variables = region->region_point_variables();
+    std::map<std::string, SimulationVariable>::const_iterator var_it = variables.begin();
+    for(; var_it != variables.end(); ++var_it)
+    {
+      const SimulationVariable & variable = var_it->second;
+      if( !variable.variable_valid || !storage.allocated(variable.variable_data_type, variable.variable_index) ) continue;
+
+      GSOLColumn column;
+      column.name         = variable.variable_name;
+      column.unit         = variable.variable_unit_string;
+      column.data_type    = variable.variable_data_type;
+      column.n_components = DataStorage::n_components(variable.variable_data_type);
+      column.value_size   = sizeof(Real);
+      column.keep_bits    = keep_bits;
+      column.data         = reinterpret_cast<const char *>(storage.raw_block(variable.variable_data_type, variable.variable_index));
+      column.storage      = column.data ? NULL : &storage;
+      column.variable_index = variable.variable_index;
+      piece.columns.push_back(column);
+    }
+  }
+
+  if(_checkpoint)
+    _pack_states(job->states());
+
+  if(_background)
+  {
+    job->make_own_copy();
+    AsyncWriter::instance().submit(job);
+  }
+  else
+  {
+    job->run();
+    delete job;
+  }
+
+  STOP_LOG("write()", "GSOLIO");
+}
+
+
+
+void GSOLIO::read (const std::string& filename)
+{
+  START_LOG("read()", "GSOLIO");
+
+  SimulationSystem & system = FieldInput<SimulationSystem>::system();
+
+  std::map<std::string, std::vector<double> > states;
+
+  if(_checkpoint)
+  {
+    // each processor restores its own piece
+    unsigned int n_pieces = 0;
+    _read_piece(piece_name(filename, Genius::processor_id()), n_pieces, states);
+    _unpack_states(states);
+
+    // the system is not rebuilt, node data (include the last step solutions)
+    // is restored as it was when checkpoint was written
+    STOP_LOG("read()", "GSOLIO");
+    return;
+  }
+
+  unsigned int n_pieces = 1;
+  for(unsigned int p=0; p<n_pieces; ++p)
+    _read_piece(piece_name(filename, p), n_pieces, states);
+
+  for(unsigned int r=0; r<system.n_regions(); r++)
+    system.region(r)->reinit_after_import();
+
+  system.init_region_post_process();
+
+  STOP_LOG("read()", "GSOLIO");
+}
+
+
+
+void GSOLIO::_read_piece(const std::string & name, unsigned int & n_pieces, std::map<std::string, std::vector<double> > & states)
+{
+  SimulationSystem & system = FieldInput<SimulationSystem>::system();
+
+  std::ifstream in(name.c_str(), std::ios::binary);
+  if(!in.good())
+  {
+    MESSAGE<<"ERROR: GSOL file " << name << " can not be opened." << std::endl; RECORD();
+    genius_error();
+  }
+
+  char magic[4];
+  unsigned int version, byte_order, piece, n_regions;
+  double time;
+  in.read(magic, 4);
+  gsol_get(in, version);
+  gsol_get(in, byte_order);
+  if( !in.good() || std::memcmp(magic, gsol_magic, 4) || version < 1 || version > gsol_version || byte_order != gsol_byte_order )
+  {
+    MESSAGE<<"ERROR: " << name << " is not a GSOL file of this version or byte order." << std::endl; RECORD();
+    genius_error();
+  }
+  gsol_get(in, n_pieces);
+  gsol_get(in, piece);
+  gsol_get(in, time);
+  gsol_get(in, n_regions);
+
+  if( _checkpoint && n_pieces != Genius::n_processors() )
+  {
+    MESSAGE<<"ERROR: checkpoint " << name << " is written by " << n_pieces << " processors, it can only be restored with the same processor number." << std::endl; RECORD();
+    genius_error();
+  }
+
+  std::vector<char> packed;
+  for(unsigned int r=0; r<n_regions; ++r)
+  {
+    std::string region_name;
+    unsigned int n_rows, n_columns;
+    gsol_get_string(in, region_name);
+    gsol_get(in, n_rows);
+    gsol_get(in, n_columns);
+
+    SimulationRegion * region = system.region(region_name);
+
+    // checkpoint rows are the node data offsets of the same partition
+    std::vector<unsigned int> local_ids;
+    if( _checkpoint && region )
+    {
+      local_ids.resize(region->node_data_storage().size(), invalid_uint);
+      SimulationRegion::const_local_node_iterator node_it = region->on_local_nodes_begin();
+      SimulationRegion::const_local_node_iterator node_it_end = region->on_local_nodes_end();
+      for(; node_it!=node_it_end; ++node_it)
+        local_ids[(*node_it)->node_data()->offset()] = (*node_it)->root_node()->id();
+    }
+
+    std::vector<unsigned int> ids;
+    for(unsigned int c=0; c<n_columns+1; ++c)
+    {
+      std::string column_name, column_unit;
+      unsigned int data_type, n_components, value_size, keep_bits, chunk_rows, n_chunks;
+      gsol_get_string(in, column_name);
+      gsol_get_string(in, column_unit);
+      gsol_get(in, data_type);
+      gsol_get(in, n_components);
+      gsol_get(in, value_size);
+      gsol_get(in, keep_bits);
+      gsol_get(in, chunk_rows);
+      gsol_get(in, n_chunks);
+
+      std::vector<char> values(static_cast<size_t>(n_rows)*n_components*value_size);
+      gsol_size_t pos = 0;
+      for(unsigned int k=0; k<n_chunks; ++k)
+      {
+        gsol_size_t raw_size, stored_size;
+        gsol_get(in, raw_size);
+        gsol_get(in, stored_size);
+        genius_assert(pos + raw_size <= values.size());
+
+        if(raw_size == 0) continue;
+
+        if(stored_size == raw_size)
+          in.read(&values[pos], raw_size);
+        else
+        {
+#ifdef HAVE_ZLIB
+          packed.resize(stored_size);
+          in.read(&packed[0], stored_size);
+          uLongf dest_size = raw_size;
+          if( uncompress(reinterpret_cast<Bytef *>(&values[pos]), &dest_size,
+                         reinterpret_cast<const Bytef *>(&packed[0]), stored_size) != Z_OK || dest_size != raw_size )
+          {
+            MESSAGE<<"ERROR: GSOL file " << name << " is corrupted." << std::endl; RECORD();
+            genius_error();
+          }
+#else
+          MESSAGE<<"ERROR: GSOL file " << name << " is compressed, but Genius is not compiled with zlib." << std::endl; RECORD();
+          genius_error();
+#endif
+        }
+        pos += raw_size;
+      }
+
+      if(!in.good())
+      {
+        MESSAGE<<"ERROR: GSOL file " << name << " is truncated." << std::endl; RECORD();
+        genius_error();
+      }
+
+      if(c == 0)
+      {
+        ids.resize(n_rows);
+        if(n_rows) std::memcpy(&ids[0], &values[0], n_rows*sizeof(unsigned int));
+        if( _checkpoint && region && ids != local_ids )
+        {
+          MESSAGE<<"ERROR: checkpoint " << name << " does not match the partition of region " << region_name << "." << std::endl; RECORD();
+          genius_error();
+        }
+        continue;
+      }
+
+      if(!region || !n_rows) continue;
+
+      // allocate the variable when required
+      DataType type = static_cast<DataType>(data_type);
+      if( region->has_variable(column_name, POINT_CENTER) )
+      {
+        if( region->get_variable(column_name, POINT_CENTER).variable_data_type != type ) continue;
+        region->add_variable(column_name, POINT_CENTER);
+      }
+      else
+        region->add_variable( SimulationVariable(column_name, type, POINT_CENTER, column_unit, invalid_uint, true, true) );
+
+      const unsigned int v = region->get_variable(column_name, POINT_CENTER).variable_index;
+      DataStorage & storage = region->node_data_storage();
+      const Real * data = reinterpret_cast<const Real *>(&values[0]);
+
+      if(_checkpoint)
+      {
+        for(unsigned int row=0; row<n_rows; ++row)
+          storage.set_components(type, v, row, data + row*n_components);
+        continue;
+      }
+
+      for(unsigned int row=0; row<n_rows; ++row)
+      {
+        if( ids[row] == invalid_uint ) continue;
+        FVM_Node * fvm_node = region->region_fvm_node(ids[row]);
+        if( !fvm_node || !fvm_node->root_node()->on_local() ) continue;
+        storage.set_components(type, v, fvm_node->node_data()->offset(), data + row*n_components);
+      }
+    }
+  }
+
+  if(version < 2) return;
+
+  unsigned int n_states;
+  gsol_get(in, n_states);
+  for(unsigned int n=0; n<n_states; ++n)
+  {
+    std::string state_name;
+    unsigned int size;
+    gsol_get_string(in, state_name);
+    gsol_get(in, size);
+    std::vector<double> & state = states[state_name];
+    state.resize(size);
+    if(size) in.read(reinterpret_cast<char *>(&state[0]), size*sizeof(double));
+  }
+}
+
+
+
+void GSOLIO::_pack_states(std::map<std::string, std::vector<double> > & states) const
+{
+  const SimulationSystem & system = FieldOutput<SimulationSystem>::system();
+
+  std::vector<double> & solver = states["solver"];
+  solver.push_back(SolverSpecify::clock);
+  solver.push_back(SolverSpecify::dt);
+  solver.push_back(SolverSpecify::dt_last);
+  solver.push_back(SolverSpecify::dt_last_last);
+  solver.push_back(SolverSpecify::T_Cycles);
+  solver.push_back(SolverSpecify::BDF2_LowerOrder ? 1.0 : 0.0);
+  solver.push_back(SolverSpecify::TimeStepDone ? 1.0 : 0.0);
+
+  const BoundaryConditionCollector * bcs = system.get_bcs();
+  for(unsigned int n=0; n<bcs->n_bcs(); ++n)
+  {
+    const BoundaryCondition * bc = bcs->get_bc(n);
+    if( !bc->is_electrode() || !bc->ext_circuit() ) continue;
+    bc->ext_circuit()->pack_state(states["electrode:" + bc->label()]);
+  }
+
+  const SPICE_CKT * spice_ckt = system.get_circuit();
+  if( spice_ckt && Genius::is_last_processor() )
+    spice_ckt->pack_state(states["spice"]);
+}
+
+
+
+void GSOLIO::_unpack_states(const std::map<std::string, std::vector<double> > & states)
+{
+  SimulationSystem & system = FieldInput<SimulationSystem>::system();
+
+  std::map<std::string, std::vector<double> >::const_iterator it = states.find("solver");
+  if( it != states.end() && it->second.size() >= 6 )
+  {
+    const std::vector<double> & solver = it->second;
+    SolverSpecify::clock           = solver[0];
+    SolverSpecify::dt              = solver[1];
+    SolverSpecify::dt_last         = solver[2];
+    SolverSpecify::dt_last_last    = solver[3];
+    SolverSpecify::T_Cycles        = static_cast<int>(solver[4]);
+    SolverSpecify::BDF2_LowerOrder = solver[5] != 0.0;
+    // checkpoints without this entry are written by GSOL hook after an accepted step
+    SolverSpecify::TimeStepDone    = solver.size() > 6 ? solver[6] != 0.0 : true;
+    // the next transient solve continues from here
+    SolverSpecify::Resume          = true;
+  }
+
+  BoundaryConditionCollector * bcs = system.get_bcs();
+  for(unsigned int n=0; n<bcs->n_bcs(); ++n)
+  {
+    BoundaryCondition * bc = bcs->get_bc(n);
+    if( !bc->is_electrode() || !bc->ext_circuit() ) continue;
+    it = states.find("electrode:" + bc->label());
+    if( it != states.end() )
+      bc->ext_circuit()->unpack_state(it->second);
+  }
+
+  // collective, the state only exists in the piece of last processor
+  SPICE_CKT * spice_ckt = system.get_circuit();
+  if( spice_ckt )
+  {
+    it = states.find("spice");
+    spice_ckt->unpack_state( it != states.end() ? it->second : std::vector<double>() );
+  }
+}
+
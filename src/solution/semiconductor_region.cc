@@ -200,6 +200,9 @@ void SemiconductorSimulationRegion::set_region_variables()
 
 void SemiconductorSimulationRegion::init(PetscScalar T_external)
 {
+  // doping is ready, the doping dependent terms of PMI can be computed now
+  prepare_pmi_coefficients();
+
   //init FVM_NodeData
   local_node_iterator node_it = on_local_nodes_begin();
   local_node_iterator node_it_end = on_local_nodes_end();
@@ -286,6 +289,9 @@ void SemiconductorSimulationRegion::init(PetscScalar T_external)
 
 void SemiconductorSimulationRegion::reinit_after_import()
 {
+  // doping may be changed by data file
+  prepare_pmi_coefficients();
+
   //init FVM_NodeData
   local_node_iterator node_it = on_local_nodes_begin();
   local_node_iterator node_it_end = on_local_nodes_end();
@@ -336,6 +342,9 @@ void SemiconductorSimulationRegion::set_pmi(const std::string &type, const std::
     get_material_base()->init_node(type, (*it)->root_node(), node_data);
   }
 
+  // the coefficients depend on calibrated parameters
+  prepare_pmi_coefficients();
+
   // update buffered value as if changed by PMI
   local_node_iterator node_it = on_local_nodes_begin();
   local_node_iterator node_it_end = on_local_nodes_end();
@@ -372,6 +381,51 @@ void SemiconductorSimulationRegion::set_pmi(const std::string &type, const std::
 }
 
 
+void SemiconductorSimulationRegion::prepare_pmi_coefficients()
+{
+  PMI_Server * pmis[] = { mt->basic, mt->band, mt->mob, mt->gen, mt->thermal, mt->optical, mt->trap };
+  const char * pmi_names[] = { "basic", "band", "mob", "gen", "thermal", "optical", "trap" };
+  const unsigned int n_pmis = sizeof(pmis)/sizeof(pmis[0]);
+
+  // allocate the coefficients as "pmi.<type>.<name>"
+  std::vector< std::vector<unsigned int> > index(n_pmis);
+  for(unsigned int m=0; m<n_pmis; ++m)
+  {
+    const std::vector<std::string> & names = pmis[m]->node_coefficient_names();
+    for(unsigned int i=0; i<names.size(); ++i)
+    {
+      std::string name = std::string("pmi.") + pmi_names[m] + "." + names[i];
+      index[m].push_back( add_variable( SimulationVariable(name, SCALAR, POINT_CENTER, "", invalid_uint, true, false) ) );
+    }
+  }
+
+  // compute them node by node
+  std::vector<PetscScalar> coefficients;
+  local_node_iterator node_it = on_local_nodes_begin();
+  local_node_iterator node_it_end = on_local_nodes_end();
+  for(; node_it!=node_it_end; ++node_it)
+  {
+    FVM_Node * fvm_node = *node_it;
+    FVM_NodeData * node_data = fvm_node->node_data();
+
+    mt->mapping(fvm_node->root_node(), node_data, 0.0);
+    for(unsigned int m=0; m<n_pmis; ++m)
+    {
+      if( index[m].empty() ) continue;
+      coefficients.assign(index[m].size(), 0.0);
+      pmis[m]->prepare_node(coefficients);
+      for(unsigned int i=0; i<index[m].size(); ++i)
+        node_data->data<Real>(index[m][i]) = coefficients[i];
+    }
+  }
+
+  // the PMIs read them from now on
+  for(unsigned int m=0; m<n_pmis; ++m)
+    for(unsigned int i=0; i<index[m].size(); ++i)
+      pmis[m]->set_node_coefficient_index(i, index[m][i], &_node_data_storage);
+}
+
+
 void SemiconductorSimulationRegion::find_elem_on_insulator_interface()
 {
   const_element_iterator it = elements_begin();
@@ -22,10 +22,19 @@
 //  $Id: simulation_system.cc,v 1.53 2008/07/09 09:10:08 gdiso Exp $
 
 #include <sstream>
+#include <fstream>
+#include <cstdio>
 #include <numeric>
 #include <queue>
 #include <algorithm>
 
+#include "config.h"
+#ifdef WINDOWS
+  #include <process.h> // for getpid
+#else
+  #include <unistd.h>
+#endif
+
 #include "parser.h"
 #include "unstructured_mesh.h"
 #include "simulation_system.h"
@@ -44,6 +53,8 @@
 
 #include "vtk_io.h"
 #include "cgns_io.h"
+#include "gsol_io.h"
+#include "solver_specify.h"
 #include "stanford_io.h"
 #include "tif_io.h"
 #include "tif3d_io.h"
@@ -51,11 +62,13 @@
 #include "dfise_io.h"
 #include "spice_ckt.h"
 #include "location_io.h"
+#include "function_table.h"
 
 #include "interpolation_2d_csa.h"
 
 #include "perf_log.h"
 #include "sync_file.h"
+#include "async_writer.h"
 
 
 #if defined(HAVE_TR1_UNORDERED_MAP)
@@ -126,6 +139,9 @@ SimulationSystem::SimulationSystem(MeshBase & mesh, Parser::InputParser & _decks
       _resistive_metal_mode = c.get_bool("resistivemetal", false);
       _block_partition = c.get_bool("blockpartition", true);
 
+      // relative error bound of tabulated material functions
+      FunctionTable::default_tolerance() = std::max(c.get_real("table.tol", 1e-9), 0.0);
+
       double res = c.get_real("leakage.res", 1e12)*PhysicalUnit::V/PhysicalUnit::A;
       double cap = c.get_real("leakage.cap", 1e-18)*PhysicalUnit::C/PhysicalUnit::V;
       MetalSimulationRegion::set_aux_parasitic_parameter(std::max(res, 1e-3*PhysicalUnit::V/PhysicalUnit::A), cap);
@@ -1109,6 +1125,10 @@ void SimulationSystem::do_interpolation(const InterpolationBase * interpolator ,
   {
     SimulationRegion * region = this->region(n);
 
+    // collect the nodes and interpolate them in one batch
+    std::vector<FVM_NodeData *> node_data_list;
+    std::vector<Point> points;
+
     SimulationRegion::local_node_iterator node_it = region->on_local_nodes_begin();
     SimulationRegion::local_node_iterator node_it_end = region->on_local_nodes_end();
     for(; node_it!=node_it_end; ++node_it)
@@ -1118,10 +1138,15 @@ void SimulationSystem::do_interpolation(const InterpolationBase * interpolator ,
       FVM_NodeData * node_data = fvm_node->node_data();
       if(node_data->is_variable_valid(variable))
       {
-        double value = interpolator->get_interpolated_value(*(fvm_node->root_node()), group_code);
-        node_data->set_variable_real(variable, value);
+        node_data_list.push_back(node_data);
+        points.push_back(*(fvm_node->root_node()));
       }
     }
+
+    std::vector<double> values;
+    interpolator->get_interpolated_values(points, group_code, values);
+    for(unsigned int i=0; i<node_data_list.size(); ++i)
+      node_data_list[i]->set_variable_real(variable, values[i]);
   }
 }
 
@@ -1255,14 +1280,15 @@ void SimulationSystem::sync_print_info () const
 
 
 
-void SimulationSystem::export_vtk(const std::string& filename, bool ascii) const
+void SimulationSystem::export_vtk(const std::string& filename, bool ascii, bool background) const
 {
   if(!ascii)
   {
 #ifdef HAVE_VTK
     std::string file_name = filename;
-    // preprocess vtk file extension to make sure it has a ".vtu" format
-    if (file_name.rfind(".vtu") > file_name.size())
+    // preprocess vtk file extension to make sure it has a ".vtu" format,
+    // ".pvtu" is kept for parallel output which writes one piece per processor
+    if (file_name.rfind(".vtu") > file_name.size() && file_name.rfind(".pvtu") > file_name.size())
     {
       // file name has a vtk extension, change it to vtu
       if (file_name.rfind(".vtk") < file_name.size())
@@ -1279,8 +1305,10 @@ void SimulationSystem::export_vtk(const std::string& filename, bool ascii) const
       }
     }
 
-    MESSAGE<<"Write System to XML VTK file "<< file_name << "...\n" << std::endl; RECORD();
-    VTKIO(*this).write (file_name);
+    MESSAGE<<"Write System to XML VTK file "<< file_name << (background ? " in background" : "") << "...\n" << std::endl; RECORD();
+    VTKIO vtk_io(*this);
+    vtk_io.set_background(background);
+    vtk_io.write (file_name);
 #else
     MESSAGE<<"Genius is not compiled with XML VTK support, skip VTK export... "<< std::endl; RECORD();
 #endif
@@ -1325,11 +1353,49 @@ void SimulationSystem::export_node_location(const std::string& filename, const P
 }
 
 
-void SimulationSystem::export_cgns(const std::string& filename) const
+void SimulationSystem::export_cgns(const std::string& filename, bool background) const
+{
+  MESSAGE<<"Write System to CGNS file "<< filename << (background ? " in background" : "") << "...\n" << std::endl; RECORD();
+
+  CGNSIO cgns_io(*this);
+  cgns_io.set_background(background);
+  cgns_io.write (filename);
+}
+
+
+void SimulationSystem::export_cgns_series(const std::string& filename, const std::vector<double> & time_values, bool background) const
+{
+  MESSAGE<<"Write System to CGNS file "<< filename << " as step " << time_values.size()-1 << (background ? " in background" : "") << "...\n" << std::endl; RECORD();
+
+  CGNSIO cgns_io(*this);
+  cgns_io.set_background(background);
+  cgns_io.set_time_series(time_values);
+  cgns_io.write (filename);
+}
+
+
+void SimulationSystem::export_gsol(const std::string& filename, double precision, bool compress, double time, bool background) const
+{
+  MESSAGE<<"Write System to GSOL file "<< filename << (background ? " in background" : "") << "...\n" << std::endl; RECORD();
+
+  GSOLIO gsol_io(*this);
+  gsol_io.set_background(background);
+  gsol_io.set_precision(precision);
+  gsol_io.set_compress(compress);
+  gsol_io.set_time(time);
+  gsol_io.write (filename);
+}
+
+
+void SimulationSystem::export_checkpoint(const std::string& filename, bool background) const
 {
-  MESSAGE<<"Write System to CGNS file "<< filename << "...\n" << std::endl; RECORD();
+  MESSAGE<<"Write checkpoint "<< filename << (background ? " in background" : "") << "...\n" << std::endl; RECORD();
 
-  CGNSIO(*this).write (filename);
+  GSOLIO gsol_io(*this);
+  gsol_io.set_background(background);
+  gsol_io.set_checkpoint(true);
+  gsol_io.set_time(SolverSpecify::clock);
+  gsol_io.write (filename);
 }
 
 
@@ -1368,18 +1434,25 @@ void SimulationSystem::export_gdml_body(const std::string& filename) const
   GDMLIO(*this, false).write (filename);
 }
 
-void SimulationSystem::import_cgns(const std::string& filename)
+void SimulationSystem::import_cgns(const std::string& filename, int step)
 {
 
   MESSAGE<<"Import System from CGNS file "<< filename << "...\n" << std::endl; RECORD();
 
-  CGNSIO(*this).read (filename);
+  // the file may still be written in background
+  AsyncWriter::instance().flush();
+
+  CGNSIO cgns_io(*this);
+  cgns_io.set_time_step(step);
+  cgns_io.read (filename);
 }
 
 void SimulationSystem::import_vtk(const std::string& filename)
 {
 #ifdef HAVE_VTK
   MESSAGE<<"Import System from VTK file "<< filename << "...\n" << std::endl; RECORD();
+  // the file may still be written in background
+  AsyncWriter::instance().flush();
   VTKIO(*this).read (filename);
 #else
   MESSAGE<<"Genius is not compiled with XML VTK support, skip VTK import... "<< std::endl; RECORD();
@@ -1387,6 +1460,30 @@ void SimulationSystem::import_vtk(const std::string& filename)
 }
 
 
+void SimulationSystem::import_gsol(const std::string& filename)
+{
+  MESSAGE<<"Import solution from GSOL file "<< filename << "...\n" << std::endl; RECORD();
+
+  // the file may still be written in background
+  AsyncWriter::instance().flush();
+
+  GSOLIO(*this).read (filename);
+}
+
+
+void SimulationSystem::import_checkpoint(const std::string& filename)
+{
+  MESSAGE<<"Restart from checkpoint "<< filename << "...\n" << std::endl; RECORD();
+
+  // the file may still be written in background
+  AsyncWriter::instance().flush();
+
+  GSOLIO gsol_io(*this);
+  gsol_io.set_checkpoint(true);
+  gsol_io.read (filename);
+}
+
+
 void SimulationSystem::import_silvaco(const std::string& filename)
 {
   MESSAGE<<"Import System from Silvaco file "<< filename << "...\n" << std::endl; RECORD();
@@ -1421,3 +1518,64 @@ void SimulationSystem::import_ise(const std::string& filename)
   MESSAGE<< std::endl; RECORD();
 }
 
+
+bool SimulationSystem::import_structure_cache(const std::string& cache_file)
+{
+  int exist = 0;
+  if( Genius::processor_id() == 0 )
+  {
+    std::ifstream in(cache_file.c_str());
+    exist = in.good();
+  }
+  Parallel::broadcast(exist);
+
+  if( !exist ) return false;
+
+  MESSAGE<<"Import System from structure cache "<< cache_file << "...\n" << std::endl; RECORD();
+
+  CGNSIO(*this).read (cache_file);
+
+  return true;
+}
+
+
+void SimulationSystem::export_structure_cache(const std::string& cache_file) const
+{
+  std::stringstream ss;
+  ss << cache_file << ".tmp" << getpid();
+  std::string tmp_file = ss.str();
+
+  // the source directory may be read only
+  int writable = 0;
+  if( Genius::processor_id() == 0 )
+  {
+    std::ofstream out(tmp_file.c_str());
+    writable = out.good();
+  }
+  Parallel::broadcast(writable);
+
+  if( !writable )
+  {
+    MESSAGE<<"Warning: can not write structure cache "<< cache_file << ", skipped.\n" << std::endl; RECORD();
+    return;
+  }
+
+  MESSAGE<<"Write structure cache "<< cache_file << "...\n" << std::endl; RECORD();
+
+  CGNSIO(*this).write (tmp_file);
+
+  int renamed = 0;
+  if( Genius::processor_id() == 0 )
+  {
+    renamed = (std::rename(tmp_file.c_str(), cache_file.c_str()) == 0);
+    if( !renamed )
+      std::remove(tmp_file.c_str());
+  }
+  Parallel::broadcast(renamed);
+
+  if( !renamed )
+  {
+    MESSAGE<<"Warning: can not rename "<< tmp_file << " to structure cache "<< cache_file << ", skipped.\n" << std::endl; RECORD();
+  }
+}
+
@@ -40,6 +40,7 @@
 #include "spice_ckt.h"
 #include "material.h"
 #include "solver_specify.h"
+#include "async_writer.h"
 
 #ifdef HAVE_VTK
 
@@ -91,9 +92,60 @@ public:
 private:
   std::string _header;
 };
+
+
+/**
+ * write an assembled vtkUnstructuredGrid to file in the I/O thread.
+ * the job owns the grid.
+ */
+class VTKIO::WriteJob : public AsyncWriter::Job
+{
+public:
+  WriteJob(vtkUnstructuredGrid* grid, const std::string &header, const std::string &name)
+  :_grid(grid), _header(header), _name(name)
+  {}
+
+  virtual ~WriteJob()
+  { _grid->Delete(); }
+
+  virtual void run()
+  {
+    XMLUnstructuredGridWriter* writer = XMLUnstructuredGridWriter::New();
+    writer->SetInput(_grid);
+    writer->setExtraHeader(_header);
+    writer->SetFileName(_name.c_str());
+    writer->Write();
+    writer->Delete();
+  }
+
+  virtual size_t memory_size() const
+  { return static_cast<size_t>(_grid->GetActualMemorySize())*1024; }
+
+  virtual std::string file_name() const
+  { return _name; }
+
+private:
+  vtkUnstructuredGrid* _grid;
+  std::string _header;
+  std::string _name;
+};
 #endif
 
 // private functions
+template <typename T>
+void VTKIO::_gather(std::vector<T> & data) const
+{
+  if(!_parallel)
+    Parallel::gather(0, data);
+}
+
+
+bool VTKIO::_is_writer() const
+{
+  return _parallel || Genius::processor_id() == 0;
+}
+
+
 #ifdef HAVE_VTK
 
 void VTKIO::nodes_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
@@ -128,6 +180,256 @@ void VTKIO::nodes_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
 }
 
 
+/**
+ * map genius element type to vtk cell type, -1 for unsupported types.
+ * PRISM18 has no vtk counterpart, it is written as VTK_EMPTY_CELL
+ */
+static vtkIdType vtk_cell_type(ElemType type)
+{
+  switch(type)
+  {
+      case EDGE2:
+      case EDGE2_FVM:
+      return VTK_LINE;
+      case EDGE3:
+      return VTK_QUADRATIC_EDGE;
+      case TRI3:
+      case TRI3_FVM:
+      case TRI3_CY_FVM:
+      return VTK_TRIANGLE;
+      case TRI6:
+      return VTK_QUADRATIC_TRIANGLE;
+      case QUAD4:
+      case QUAD4_FVM:
+      case QUAD4_CY_FVM:
+      return VTK_QUAD;
+      case QUAD8:
+      return VTK_QUADRATIC_QUAD;
+      case TET4:
+      case TET4_FVM:
+      return VTK_TETRA;
+      case TET10:
+      return VTK_QUADRATIC_TETRA;
+      case HEX8:
+      case HEX8_FVM:
+      return VTK_HEXAHEDRON;
+      case HEX20:
+      return VTK_QUADRATIC_HEXAHEDRON;
+      case PRISM6:
+      case PRISM6_FVM:
+      return VTK_WEDGE;
+      case PRISM15:
+      return VTK_HIGHER_ORDER_WEDGE;
+      case PRISM18:
+      return VTK_EMPTY_CELL;
+      case PYRAMID5:
+      case PYRAMID5_FVM:
+      return VTK_PYRAMID;
+#if VTK_MAJOR_VERSION > 5 || (VTK_MAJOR_VERSION == 5 && VTK_MINOR_VERSION > 0)
+      case QUAD9:
+      return VTK_BIQUADRATIC_QUAD;
+#endif
+      default:
+      return -1;
+  }
+}
+
+
+void VTKIO::piece_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
+{
+  // local piece of this processor: on processor elements and their boundary sides.
+  // nodes are numbered by increasing id, cells by element id, then boundary sides by (elem, side)
+  _piece_nodes.clear();
+  _piece_cells.clear();
+  _piece_boundary_cells.clear();
+
+  std::vector<const Elem *> elems;
+  {
+    std::map<unsigned int, const Elem *> elem_map;
+    MeshBase::const_element_iterator       it  = mesh.active_this_pid_elements_begin();
+    const MeshBase::const_element_iterator end = mesh.active_this_pid_elements_end();
+    for ( ; it != end; ++it)
+    {
+      elem_map.insert( std::make_pair((*it)->id(), *it) );
+      for(unsigned int n=0; n<(*it)->n_nodes(); ++n)
+        _piece_nodes.insert( std::make_pair((*it)->get_node(n)->id(), 0) );
+    }
+    std::map<unsigned int, const Elem *>::const_iterator elem_it = elem_map.begin();
+    for(unsigned int i=0; elem_it != elem_map.end(); ++elem_it, ++i)
+    {
+      elems.push_back(elem_it->second);
+      _piece_cells.insert( std::make_pair(elem_it->first, i) );
+    }
+  }
+
+  typedef std::pair<unsigned int, unsigned short int> boundary_elem_key;
+  std::map<boundary_elem_key, unsigned int> boundary_face_order;
+  for(unsigned int n=0; n<_il.size(); ++n)
+    boundary_face_order.insert( std::make_pair(std::make_pair(_el[n], _sl[n]), n) );
+  {
+    std::map<boundary_elem_key, unsigned int>::const_iterator it = boundary_face_order.begin();
+    for(unsigned int i=elems.size(); it != boundary_face_order.end(); ++it, ++i)
+      _piece_boundary_cells.insert( std::make_pair(it->first, i) );
+  }
+
+  // points
+  {
+    vtkPoints* points = vtkPoints::New();
+    std::map<unsigned int, unsigned int>::iterator it = _piece_nodes.begin();
+    for(unsigned int n=0; it != _piece_nodes.end(); ++it, ++n)
+    {
+      const Node * node = mesh.node_ptr(it->first);
+      float tuple[3];
+      {
+        tuple[0] =  (*node)(0)/um; //scale to um
+        tuple[1] =  (*node)(1)/um; //scale to um
+        tuple[2] =  (*node)(2)/um; //scale to um
+      }
+      points->InsertPoint(n, tuple);
+      it->second = n;
+    }
+    grid->SetPoints(points);
+    points->Delete();
+  }
+
+  // cells and cell based region/boundary/partition info
+  const unsigned int n_cells = elems.size() + boundary_face_order.size();
+  grid->Allocate(n_cells);
+
+  vtkIntArray *region_info    = vtkIntArray::New();
+  vtkIntArray *boundary_info  = vtkIntArray::New();
+  vtkIntArray *partition_info  = vtkIntArray::New();
+
+  region_info->SetName("region");
+  region_info->SetNumberOfValues(n_cells);
+
+  boundary_info->SetName("boundary");
+  boundary_info->SetNumberOfValues(n_cells);
+
+  partition_info->SetName("partition");
+  partition_info->SetNumberOfValues(n_cells);
+
+  unsigned int loc = 0;
+  for(unsigned int n=0; n<elems.size(); ++n, ++loc)
+  {
+    const Elem * elem = elems[n];
+    vtkIdType celltype = vtk_cell_type(elem->type());
+    if( celltype < 0 )
+    {
+      std::cerr<<"element type "<<elem->type()<<" not implemented"<<std::endl;
+      genius_error();
+    }
+
+    std::vector<unsigned int> conn;
+    elem->connectivity(0,VTK,conn);
+
+    vtkIdList *pts = vtkIdList::New();
+    pts->SetNumberOfIds(conn.size());
+    for(unsigned int i=0;i<conn.size();++i)
+      pts->SetId(i, _piece_nodes.find(conn[i])->second);
+    grid->InsertNextCell(celltype, pts);
+    pts->Delete();
+
+    region_info->SetValue(loc, elem->subdomain_id());
+    boundary_info->SetValue(loc, 0);
+    partition_info->SetValue(loc, elem->processor_id());
+  }
+
+  std::map<boundary_elem_key, unsigned int>::const_iterator boundary_face_it = boundary_face_order.begin();
+  for(; boundary_face_it != boundary_face_order.end(); ++boundary_face_it, ++loc)
+  {
+    const unsigned int n = boundary_face_it->second;
+    const Elem * elem = mesh.elem(_el[n]);
+    AutoPtr<Elem> boundary_elem =  elem->build_side(_sl[n]);
+    vtkIdType celltype = vtk_cell_type(boundary_elem->type());
+    if( celltype < 0 )
+    {
+      std::cerr<<"element type "<<boundary_elem->type()<<" not implemented"<<std::endl;
+      genius_error();
+    }
+
+    std::vector<unsigned int> conn;
+    boundary_elem->connectivity(0,VTK,conn);
+
+    vtkIdList *pts = vtkIdList::New();
+    pts->SetNumberOfIds(conn.size());
+    for(unsigned int i=0;i<conn.size();++i)
+      pts->SetId(i, _piece_nodes.find(conn[i])->second);
+    grid->InsertNextCell(celltype, pts);
+    pts->Delete();
+
+    region_info->SetValue(loc, elem->subdomain_id());
+    boundary_info->SetValue(loc, _il[n]);
+    partition_info->SetValue(loc, elem->processor_id());
+  }
+
+  grid->GetCellData()->AddArray(region_info);
+  grid->GetCellData()->AddArray(boundary_info);
+  grid->GetCellData()->AddArray(partition_info);
+
+  region_info->Delete();
+  boundary_info->Delete();
+  partition_info->Delete();
+}
+
+
+std::string VTKIO::export_pvtu_index(const std::string & name, vtkUnstructuredGrid* grid)
+{
+  std::stringstream os;
+
+  os << "<?xml version=\"1.0\"?>" << std::endl;
+  // region and boundary information only written once, into the index file
+  os << this->export_extra_info();
+  os << "<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">" << std::endl;
+  os << "  <PUnstructuredGrid GhostLevel=\"0\">" << std::endl;
+
+  os << "    <PPointData>" << std::endl;
+  for(int i=0; i<grid->GetPointData()->GetNumberOfArrays(); ++i)
+  {
+    vtkDataArray * array = grid->GetPointData()->GetArray(i);
+    os << "      <PDataArray type=\"Float32\" Name=\"" << array->GetName() << "\" NumberOfComponents=\""
+       << array->GetNumberOfComponents() << "\"/>" << std::endl;
+  }
+  os << "    </PPointData>" << std::endl;
+
+  os << "    <PCellData>" << std::endl;
+  for(int i=0; i<grid->GetCellData()->GetNumberOfArrays(); ++i)
+  {
+    vtkDataArray * array = grid->GetCellData()->GetArray(i);
+    os << "      <PDataArray type=\"" << (array->GetDataType() == VTK_INT ? "Int32" : "Float32")
+       << "\" Name=\"" << array->GetName() << "\" NumberOfComponents=\""
+       << array->GetNumberOfComponents() << "\"/>" << std::endl;
+  }
+  os << "    </PCellData>" << std::endl;
+
+  os << "    <PPoints>" << std::endl;
+  os << "      <PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>" << std::endl;
+  os << "    </PPoints>" << std::endl;
+
+  for(unsigned int p=0; p<Genius::n_processors(); ++p)
+  {
+    std::string piece = piece_name(name, p);
+    // piece file is referenced relative to the index file
+    if( piece.rfind('/') < piece.size() )
+      piece = piece.substr(piece.rfind('/')+1);
+    os << "    <Piece Source=\"" << piece << "\"/>" << std::endl;
+  }
+
+  os << "  </PUnstructuredGrid>" << std::endl;
+  os << "</VTKFile>" << std::endl;
+
+  return os.str();
+}
+
+
+std::string VTKIO::piece_name(const std::string & name, unsigned int p)
+{
+  std::stringstream ss;
+  ss << name.substr(0, name.rfind(".pvtu")) << '_' << p << ".vtu";
+  return ss.str();
+}
+
+
 void VTKIO::cells_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
 {
 
@@ -140,79 +442,13 @@ void VTKIO::cells_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
     for ( ; it != end; ++it)
     {
       const Elem *elem  = (*it);
-      vtkIdType celltype = VTK_EMPTY_CELL; // initialize to something to avoid compiler warning
-
-      switch(elem->type())
+      vtkIdType celltype = vtk_cell_type(elem->type());
+      if( celltype < 0 )
       {
-          case EDGE2:
-          case EDGE2_FVM:
-          celltype = VTK_LINE;
-          break;
-          case EDGE3:
-          celltype = VTK_QUADRATIC_EDGE;
-          break;// 1
-          case TRI3:
-          case TRI3_FVM:
-          case TRI3_CY_FVM:
-          celltype = VTK_TRIANGLE;
-          break;// 3
-          case TRI6:
-          celltype = VTK_QUADRATIC_TRIANGLE;
-          break;// 4
-          case QUAD4:
-          case QUAD4_FVM:
-          case QUAD4_CY_FVM:
-          celltype = VTK_QUAD;
-          break;// 5
-          case QUAD8:
-          celltype = VTK_QUADRATIC_QUAD;
-          break;// 6
-          case TET4:
-          case TET4_FVM:
-          celltype = VTK_TETRA;
-          break;// 8
-          case TET10:
-          celltype = VTK_QUADRATIC_TETRA;
-          break;// 9
-          case HEX8:
-          case HEX8_FVM:
-          celltype = VTK_HEXAHEDRON;
-          break;// 10
-          case HEX20:
-          celltype = VTK_QUADRATIC_HEXAHEDRON;
-          break;// 12
-          case PRISM6:
-          case PRISM6_FVM:
-          celltype = VTK_WEDGE;
-          break;// 13
-          case PRISM15:
-          celltype = VTK_HIGHER_ORDER_WEDGE;
-          break;// 14
-          case PRISM18:
-          break;// 15
-          case PYRAMID5:
-          case PYRAMID5_FVM:
-          celltype = VTK_PYRAMID;
-          break;// 16
-#if VTK_MAJOR_VERSION > 5 || (VTK_MAJOR_VERSION == 5 && VTK_MINOR_VERSION > 0)
-          case QUAD9:
-          celltype = VTK_BIQUADRATIC_QUAD;
-          break;
-#else
-          case QUAD9:
-#endif
-          case EDGE4:
-          case HEX27:
-          case NODEELEM:
-          case INVALID_ELEM:
-          default:
-          {
-            std::cerr<<"element type "<<elem->type()<<" not implemented"<<std::endl;
-            genius_error();
-          }
+        std::cerr<<"element type "<<elem->type()<<" not implemented"<<std::endl;
+        genius_error();
       }
 
-
       // get the connectivity for this element
       std::vector<unsigned int> conn;
       elem->connectivity(0,VTK,conn);
@@ -639,11 +875,14 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
     std::vector<float> Vpx, Vpy, Vpz;
     std::vector<float> Ex,  Ey,  Ez;
 
-    // search all the node belongs to current processor
+    // search all the node belongs to current processor.
+    // when each processor writes its own piece, the ghost nodes of the piece are needed as well
     for( unsigned int r=0; r<system.n_regions(); r++)
     {
-      SimulationRegion::const_processor_node_iterator on_processor_nodes_it = system.region(r)->on_processor_nodes_begin();
-      SimulationRegion::const_processor_node_iterator on_processor_nodes_it_end = system.region(r)->on_processor_nodes_end();
+      SimulationRegion::const_local_node_iterator on_processor_nodes_it =
+        _parallel ? system.region(r)->on_local_nodes_begin() : system.region(r)->on_processor_nodes_begin();
+      SimulationRegion::const_local_node_iterator on_processor_nodes_it_end =
+        _parallel ? system.region(r)->on_local_nodes_end() : system.region(r)->on_processor_nodes_end();
       for(; on_processor_nodes_it!=on_processor_nodes_it_end; ++on_processor_nodes_it)
       {
         const FVM_Node * fvm_node = *on_processor_nodes_it;
@@ -651,6 +890,8 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
         const SimulationRegion * region = system.region(r);
         const unsigned int id = fvm_node->root_node()->id();
 
+        if( _parallel && _piece_nodes.find(id) == _piece_nodes.end() ) continue;
+
         // if the fvm_node lies on the interface of two material regions,
         // we shall use the node data in the more important region.
         // it just for visualization reason
@@ -669,7 +910,7 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
         }
 
         assert ( node_data != NULL );
-        order.push_back(id);
+        order.push_back(_parallel ? _piece_nodes.find(id)->second : id);
 
         {
           if(semiconductor_material)
@@ -757,9 +998,11 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
       }
     }
 
-    Parallel::gather(0, order);
-    if (Genius::processor_id() == 0)
+    _gather(order);
+    if (Genius::processor_id() == 0 && !_parallel)
       genius_assert( order.size() == mesh.n_nodes() );
+    if (_parallel)
+      genius_assert( order.size() == _piece_nodes.size() );
 
     write_node_scaler_solution(order, psi, "potential", grid);
     write_node_scaler_solution(order, Ec,  "Ec",  grid);
@@ -844,7 +1087,7 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
         if( elem->processor_id() != Genius::processor_id() ) continue;
         const FVM_CellData * elem_data = region->get_region_elem_data(n);
         elem_to_elem_data_map.insert( std::make_pair(elem, elem_data) );
-        order.push_back(elem->id());
+        order.push_back(_parallel ? _piece_cells.find(elem->id())->second : elem->id());
         /*
         if( region->type()==SemiconductorRegion)
         {
@@ -874,8 +1117,8 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
     {
       std::vector<unsigned int> boundary_elem_ids(_el);
       std::vector<unsigned short int> boundary_elem_sides(_sl);
-      Parallel::gather(0, boundary_elem_ids);
-      Parallel::gather(0, boundary_elem_sides);
+      _gather(boundary_elem_ids);
+      _gather(boundary_elem_sides);
 
       typedef std::pair<unsigned int, unsigned short int> boundary_elem_key;
       std::map<boundary_elem_key, unsigned int> boundary_face_order;
@@ -899,7 +1142,10 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
         const FVM_CellData * elem_data = elem_to_elem_data_map.find(elem)->second;
 
         boundary_elem_key key = std::make_pair(_el[n], _sl[n]);
-        order.push_back(id_offset + boundary_face_order.find(key)->second);
+        if(_parallel)
+          order.push_back(_piece_boundary_cells.find(key)->second);
+        else
+          order.push_back(id_offset + boundary_face_order.find(key)->second);
 
         //std::cout<<id_offset + boundary_face_order.find(key)->second<<std::endl;
         //mos_channel_flag.push_back(0.5);
@@ -933,7 +1179,7 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
       }
     }
 
-    Parallel::gather(0, order);
+    _gather(order);
     //write_cell_scaler_solution(order, mos_channel_flag,  "mos channel", grid);
     write_cell_vector_solution(order, Ex,  Ey,  Ez,  "electrical_field", grid);
     write_cell_vector_solution(order, Jnx, Jny, Jnz, "electron_current", grid);
@@ -946,9 +1192,9 @@ void VTKIO::write_node_scaler_solution(const std::vector<unsigned int> & order,
                                        const std::string & sol_name, vtkUnstructuredGrid* grid)
 {
   // this should run on parallel for all the processor
-  Parallel::gather(0, sol);
+  _gather(sol);
 
-  if (Genius::processor_id() == 0)
+  if (_is_writer())
   {
     genius_assert(order.size() == sol.size());
     //create vtk data array
@@ -981,9 +1227,9 @@ void VTKIO::write_node_complex_solution(const std::vector<unsigned int> & order,
                                         const std::string & sol_name, vtkUnstructuredGrid* grid)
 {
   // this should run on parallel for all the processor
-  Parallel::gather(0, sol);
+  _gather(sol);
 
-  if ( Genius::processor_id() == 0)
+  if ( _is_writer())
   {
     genius_assert(order.size() == sol.size());
 
@@ -1033,11 +1279,11 @@ void VTKIO::write_node_vector_solution(const std::vector<unsigned int> & order,
                                        const std::string & sol_name, vtkUnstructuredGrid* grid)
 {
   // this should run on parallel for all the processor
-  Parallel::gather(0, sol_x);
-  Parallel::gather(0, sol_y);
-  Parallel::gather(0, sol_z);
+  _gather(sol_x);
+  _gather(sol_y);
+  _gather(sol_z);
 
-  if ( Genius::processor_id() == 0)
+  if ( _is_writer())
   {
     //create vtk data array
     vtkFloatArray *vtk_sol_array = vtkFloatArray::New();
@@ -1078,9 +1324,9 @@ void VTKIO::write_cell_scaler_solution(const std::vector<unsigned int> & order,
                                        const std::string & sol_name, vtkUnstructuredGrid* grid)
 {
   // this should run on parallel for all the processor
-  Parallel::gather(0, sol);
+  _gather(sol);
 
-  if (Genius::processor_id() == 0)
+  if (_is_writer())
   {
     //create vtk data array
     vtkFloatArray *vtk_sol_array = vtkFloatArray::New();
@@ -1115,11 +1361,11 @@ void VTKIO::write_cell_vector_solution(const std::vector<unsigned int> & order,
                                        const std::string & sol_name, vtkUnstructuredGrid* grid)
 {
   // this should run on parallel for all the processor
-  Parallel::gather(0, sol_x);
-  Parallel::gather(0, sol_y);
-  Parallel::gather(0, sol_z);
+  _gather(sol_x);
+  _gather(sol_y);
+  _gather(sol_z);
 
-  if ( Genius::processor_id() == 0)
+  if ( _is_writer())
   {
     //create vtk data array
     vtkFloatArray *vtk_sol_array = vtkFloatArray::New();
@@ -1854,8 +2100,46 @@ void VTKIO::write (const std::string& name)
   const MeshBase& mesh = FieldOutput<SimulationSystem>::system().mesh();
   mesh.boundary_info->build_on_processor_side_list (_el, _sl, _il);
 
+  // parallel vtk file, each processor writes its own piece, processor 0 writes the index
+  if(name.rfind(".pvtu") < name.size())
+  {
+#ifdef HAVE_VTK
+    _parallel = true;
+    _vtk_grid = vtkUnstructuredGrid::New();
+
+    piece_to_vtk(mesh, _vtk_grid);
+    solution_to_vtk(mesh, _vtk_grid);
+
+    if(Genius::processor_id() == 0)
+    {
+      std::ofstream out(name.c_str(), std::ofstream::trunc);
+      out << export_pvtu_index(name, _vtk_grid);
+      out.close();
+    }
+
+    const std::string piece = piece_name(name, Genius::processor_id());
+    if(_background)
+    {
+      AsyncWriter::instance().submit(new WriteJob(_vtk_grid, "", piece));
+      _vtk_grid = NULL;
+    }
+    else
+    {
+      XMLUnstructuredGridWriter* writer = XMLUnstructuredGridWriter::New();
+      writer->SetInput(_vtk_grid);
+      writer->SetFileName(piece.c_str());
+      writer->Write();
+      writer->Delete();
+      _vtk_grid->Delete();
+      _vtk_grid = NULL;
+    }
+
+    _parallel = false;
+#endif
+  }
+
   // vtk file extension have a ".vtu" format?
-  if(name.rfind(".vtu") < name.size())
+  else if(name.rfind(".vtu") < name.size())
   {
 #ifdef HAVE_VTK
     // use vtk library routine to export mesh and solution as base64 binary file
@@ -1870,17 +2154,26 @@ void VTKIO::write (const std::string& name)
     // only processor 0 write VTK file
     if(Genius::processor_id() == 0)
     {
-      XMLUnstructuredGridWriter* writer = XMLUnstructuredGridWriter::New();
-      writer->SetInput(_vtk_grid);
-      writer->setExtraHeader(this->export_extra_info());
-
-      writer->SetFileName(name.c_str());
-      writer->Write();
-      writer->Delete();
+      // all the data are on processor 0 now, the I/O thread takes the grid
+      if(_background)
+      {
+        AsyncWriter::instance().submit(new WriteJob(_vtk_grid, this->export_extra_info(), name));
+        _vtk_grid = NULL;
+      }
+      else
+      {
+        XMLUnstructuredGridWriter* writer = XMLUnstructuredGridWriter::New();
+        writer->SetInput(_vtk_grid);
+        writer->setExtraHeader(this->export_extra_info());
 
+        writer->SetFileName(name.c_str());
+        writer->Write();
+        writer->Delete();
+      }
     }
     //clean up
-    _vtk_grid->Delete();
+    if(_vtk_grid) _vtk_grid->Delete();
+    _vtk_grid = NULL;
 #endif
 
   }
@@ -155,8 +155,15 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
   std::vector<PetscScalar> Jn_edge_buffer;
   std::vector<PetscScalar> Jp_edge_buffer;
   {
-    Jn_edge_buffer.reserve(n_edge());
-    Jp_edge_buffer.reserve(n_edge());
+    // edge arrays for the batched S-G kernel
+    std::vector<PetscScalar> dEc_edge, dEv_edge, n1_edge, n2_edge, p1_edge, p2_edge, length_edge;
+    dEc_edge.reserve(n_edge());
+    dEv_edge.reserve(n_edge());
+    n1_edge.reserve(n_edge());
+    n2_edge.reserve(n_edge());
+    p1_edge.reserve(n_edge());
+    p2_edge.reserve(n_edge());
+    length_edge.reserve(n_edge());
 
     // search all the edges of this region
     const_edge_iterator it = edges_begin();
@@ -218,9 +225,14 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
       }
       const PetscScalar eps2 =  n2_data->eps();
 
-      // S-G current along the edge
-      Jn_edge_buffer.push_back( In_dd(Vt,(Ec2-Ec1)/e,n1,n2,length) );
-      Jp_edge_buffer.push_back( Ip_dd(Vt,(Ev2-Ev1)/e,p1,p2,length) );
+      // S-G current along the edge, evaluated later in batch
+      dEc_edge.push_back((Ec2-Ec1)/e);
+      dEv_edge.push_back((Ev2-Ev1)/e);
+      n1_edge.push_back(n1);
+      n2_edge.push_back(n2);
+      p1_edge.push_back(p1);
+      p2_edge.push_back(p2);
+      length_edge.push_back(length);
 
 
       // poisson's equation
@@ -243,6 +255,14 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
         flux.push_back(-f);
       }
     }
+
+    Jn_edge_buffer.resize(length_edge.size());
+    Jp_edge_buffer.resize(length_edge.size());
+    if( !length_edge.empty() )
+    {
+      In_dd_batch(length_edge.size(), Vt, &dEc_edge[0], &n1_edge[0], &n2_edge[0], &length_edge[0], &Jn_edge_buffer[0]);
+      Ip_dd_batch(length_edge.size(), Vt, &dEv_edge[0], &p1_edge[0], &p2_edge[0], &length_edge[0], &Jp_edge_buffer[0]);
+    }
   }
 
   // then, search all the element in this region and process "cell" related terms
@@ -784,8 +804,19 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
   std::vector<AutoDScalar> Jn_edge_buffer;
   std::vector<AutoDScalar> Jp_edge_buffer;
   {
-    Jn_edge_buffer.reserve(n_edge());
-    Jp_edge_buffer.reserve(n_edge());
+    // edge arrays for the batched S-G kernel, the driving potential difference
+    // keeps its derivatives w.r.t. the 6 variables of the edge
+    std::vector<AutoDScalar> dEc_edge, dEv_edge;
+    std::vector<PetscScalar> dEc_value, dEv_value, n1_edge, n2_edge, p1_edge, p2_edge, length_edge;
+    dEc_edge.reserve(n_edge());
+    dEv_edge.reserve(n_edge());
+    dEc_value.reserve(n_edge());
+    dEv_value.reserve(n_edge());
+    n1_edge.reserve(n_edge());
+    n2_edge.reserve(n_edge());
+    p1_edge.reserve(n_edge());
+    p2_edge.reserve(n_edge());
+    length_edge.reserve(n_edge());
 
     //the indepedent variable number, 2 nodes * 3 variables per edge
     adtl::AutoDScalar::numdir = 6;
@@ -854,9 +885,16 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       }
       const PetscScalar eps2 =  n2_data->eps();
 
-      // S-G current along the edge
-      Jn_edge_buffer.push_back( In_dd(Vt,(Ec2-Ec1)/e,n1,n2,length) );
-      Jp_edge_buffer.push_back( Ip_dd(Vt,(Ev2-Ev1)/e,p1,p2,length) );
+      // S-G current along the edge, evaluated later in batch
+      dEc_edge.push_back((Ec2-Ec1)/e);
+      dEv_edge.push_back((Ev2-Ev1)/e);
+      dEc_value.push_back(dEc_edge.back().getValue());
+      dEv_value.push_back(dEv_edge.back().getValue());
+      n1_edge.push_back(n1.getValue());
+      n2_edge.push_back(n2.getValue());
+      p1_edge.push_back(p1.getValue());
+      p2_edge.push_back(p2.getValue());
+      length_edge.push_back(length);
 
       // poisson's equation
 
@@ -881,6 +919,35 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       }
 
     }
+
+    const unsigned int n_edges = length_edge.size();
+    std::vector<PetscScalar> Jn(n_edges), dJn_dV(n_edges), dJn_dn1(n_edges), dJn_dn2(n_edges);
+    std::vector<PetscScalar> Jp(n_edges), dJp_dV(n_edges), dJp_dp1(n_edges), dJp_dp2(n_edges);
+    if( n_edges )
+    {
+      In_dd_batch(n_edges, Vt, &dEc_value[0], &n1_edge[0], &n2_edge[0], &length_edge[0], &Jn[0], &dJn_dV[0], &dJn_dn1[0], &dJn_dn2[0]);
+      Ip_dd_batch(n_edges, Vt, &dEv_value[0], &p1_edge[0], &p2_edge[0], &length_edge[0], &Jp[0], &dJp_dV[0], &dJp_dp1[0], &dJp_dp2[0]);
+    }
+
+    // chain rule, directions are V1 n1 p1 V2 n2 p2
+    Jn_edge_buffer.resize(n_edges);
+    Jp_edge_buffer.resize(n_edges);
+    for(unsigned int i=0; i<n_edges; ++i)
+    {
+      PetscScalar Jn_ad[6], Jp_ad[6];
+      for(unsigned int d=0; d<6; ++d)
+      {
+        Jn_ad[d] = dJn_dV[i]*dEc_edge[i].getADValue(d);
+        Jp_ad[d] = dJp_dV[i]*dEv_edge[i].getADValue(d);
+      }
+      Jn_ad[1] += dJn_dn1[i];
+      Jn_ad[4] += dJn_dn2[i];
+      Jp_ad[2] += dJp_dp1[i];
+      Jp_ad[5] += dJp_dp2[i];
+
+      Jn_edge_buffer[i] = AutoDScalar(Jn[i], Jn_ad, 6);
+      Jp_edge_buffer[i] = AutoDScalar(Jp[i], Jp_ad, 6);
+    }
   }
 
   // search all the element in this region.
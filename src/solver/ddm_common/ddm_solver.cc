@@ -24,6 +24,7 @@
 #include <stack>
 
 #include "solver_specify.h"
+#include "petsc_type.h"
 #include "physical_unit.h"
 #include "electrical_source.h"
 #include "resistance_region.h"
@@ -54,6 +55,10 @@ DDMSolverBase::DDMSolverBase(SimulationSystem & system): FVM_NonlinearSolver(sys
   function_norm             = 0.0;
   functions_norm.resize(7, 0.0);
   nonlinear_iteration       = 0;
+
+  ksp_forcing               = SolverSpecify::ksp_rtol;
+  scaled_function_norm_prev = 0.0;
+  linear_iteration_prev     = 0;
 }
 
 int DDMSolverBase::create_solver()
@@ -1167,21 +1172,71 @@ int DDMSolverBase::solve_transient()
   // time dependent
   SolverSpecify::TimeDependent = true;
 
-  // if BDF2 scheme is used, we should set SolverSpecify::BDF2_LowerOrder flag to true
-  if ( SolverSpecify::TS_type==SolverSpecify::BDF2 )
-    SolverSpecify::BDF2_LowerOrder = true;
+  if ( SolverSpecify::Resume )
+  {
+    // continue from the time integration state restored from checkpoint
+    SolverSpecify::Resume = false;
 
-  // transient simulation clock
-  SolverSpecify::clock = SolverSpecify::TStart + SolverSpecify::TStep;
+    // the checkpoint is taken after an accepted step, advance to the next one
+    if ( SolverSpecify::TimeStepDone )
+    {
+      SolverSpecify::T_Cycles++;
+      SolverSpecify::dt_last_last = SolverSpecify::dt_last;
+      SolverSpecify::dt_last = SolverSpecify::dt;
+
+      if ( SolverSpecify::dt < SolverSpecify::TStepMin )
+        SolverSpecify::dt = SolverSpecify::TStepMin;
+      if ( SolverSpecify::dt > SolverSpecify::TStepMax )
+        SolverSpecify::dt = SolverSpecify::TStepMax;
+      SolverSpecify::dt = _system.get_electrical_source()->limit_dt(SolverSpecify::clock, SolverSpecify::dt, SolverSpecify::VStepMax, SolverSpecify::IStepMax);
+      SolverSpecify::dt = _system.get_field_source()->limit_dt(SolverSpecify::clock, SolverSpecify::dt);
+
+      SolverSpecify::clock += SolverSpecify::dt;
+      if ( SolverSpecify::clock > SolverSpecify::TStop && SolverSpecify::clock < ( SolverSpecify::TStop + SolverSpecify::dt - 1e-10*SolverSpecify::dt ) )
+      {
+        SolverSpecify::dt -= SolverSpecify::clock - SolverSpecify::TStop;
+        SolverSpecify::clock = SolverSpecify::TStop;
+      }
 
-  // for the first step, dt equals TStep
-  SolverSpecify::dt = SolverSpecify::TStep;
+      if ( SolverSpecify::TS_type==SolverSpecify::BDF2 )
+        SolverSpecify::BDF2_LowerOrder = this->BDF2_positive_defined();
+      SolverSpecify::TimeStepDone = false;
+    }
 
-  MESSAGE<<"Transient compute from "<<SolverSpecify::TStart
-  <<" ps step "<<SolverSpecify::TStep
-  <<" ps to "  <<SolverSpecify::TStop<<" ps"
-  <<'\n';
-  RECORD();
+    MESSAGE<<"Transient resume from "<<SolverSpecify::clock-SolverSpecify::dt
+    <<" ps step "<<SolverSpecify::dt
+    <<" ps to "  <<SolverSpecify::TStop<<" ps"
+    <<'\n';
+    RECORD();
+  }
+  else
+  {
+    // if BDF2 scheme is used, we should set SolverSpecify::BDF2_LowerOrder flag to true
+    if ( SolverSpecify::TS_type==SolverSpecify::BDF2 )
+      SolverSpecify::BDF2_LowerOrder = true;
+
+    // transient simulation clock
+    SolverSpecify::clock = SolverSpecify::TStart + SolverSpecify::TStep;
+
+    // for the first step, dt equals TStep
+    SolverSpecify::dt = SolverSpecify::TStep;
+
+    MESSAGE<<"Transient compute from "<<SolverSpecify::TStart
+    <<" ps step "<<SolverSpecify::TStep
+    <<" ps to "  <<SolverSpecify::TStop<<" ps"
+    <<'\n';
+    RECORD();
+
+    // time step counter
+    SolverSpecify::T_Cycles=0;
+  }
+
+  // time of the last accepted step, the clock never goes back before it
+  const double t_begin = SolverSpecify::clock - SolverSpecify::dt;
+
+  // steps done by this solve. the solution history (x_n, x_n1, x_n2) used by
+  // LTE estimation and prediction only exists for these steps
+  int n_steps = 0;
 
   // diverged counter
   int diverged_retry=0;
@@ -1189,9 +1244,6 @@ int DDMSolverBase::solve_transient()
   // auto time step counter
   int autostep_retry=0;
 
-  // time step counter
-  SolverSpecify::T_Cycles=0;
-
   double dt_dynamic_factor = 1.0;
 
   // the main loop of transient solver.
@@ -1208,7 +1260,7 @@ int DDMSolverBase::solve_transient()
     //we do solve here!
 
     // call pre_solve_process
-    if ( SolverSpecify::T_Cycles == 0 )
+    if ( n_steps == 0 )
       this->pre_solve_process();
     else
       this->pre_solve_process ( false );
@@ -1253,8 +1305,8 @@ int DDMSolverBase::solve_transient()
       SolverSpecify::dt /= 2.0;
       SolverSpecify::clock -= SolverSpecify::dt;
 
-      if ( SolverSpecify::clock < SolverSpecify::TStart )
-        SolverSpecify::clock = SolverSpecify::TStart;
+      if ( SolverSpecify::clock < t_begin )
+        SolverSpecify::clock = t_begin;
 
       // load previous result into solution vector
       this->diverged_recovery();
@@ -1267,8 +1319,8 @@ int DDMSolverBase::solve_transient()
 
     //do LTE estimation and auto time step control
     if ( SolverSpecify::AutoStep &&
-         ( ( SolverSpecify::TS_type==SolverSpecify::BDF1 && SolverSpecify::T_Cycles>=2 ) ||
-           ( SolverSpecify::TS_type==SolverSpecify::BDF2 && SolverSpecify::T_Cycles>=3 ) ) )
+         ( ( SolverSpecify::TS_type==SolverSpecify::BDF1 && n_steps>=2 ) ||
+           ( SolverSpecify::TS_type==SolverSpecify::BDF2 && n_steps>=3 ) ) )
     {
       PetscReal r = this->LTE_norm() + 1e-10;
 
@@ -1341,14 +1393,17 @@ int DDMSolverBase::solve_transient()
     RECORD();
 
 
-    // call post_solve_process
+    // call post_solve_process, checkpoint may be written here
+    SolverSpecify::TimeStepDone = true;
     this->post_solve_process();
+    SolverSpecify::TimeStepDone = false;
 
     // clear the counter
     diverged_retry = 0;
 
     // time step counter ++
     SolverSpecify::T_Cycles++;
+    n_steps++;
 
     // save time step information
     SolverSpecify::dt_last_last = SolverSpecify::dt_last;
@@ -1401,7 +1456,7 @@ int DDMSolverBase::solve_transient()
       PetscScalar hn1 = SolverSpecify::dt_last;      // time step n-1
       PetscScalar hn2 = SolverSpecify::dt_last_last; // time step n-2
 
-      if ( SolverSpecify::TS_type == SolverSpecify::BDF1 && SolverSpecify::T_Cycles>=2)
+      if ( SolverSpecify::TS_type == SolverSpecify::BDF1 && n_steps>=2)
       {
         VecZeroEntries ( x );
         // use linear interpolation to predict solution x
@@ -1409,7 +1464,7 @@ int DDMSolverBase::solve_transient()
         VecAXPY ( x, -hn/hn1,  x_n1 );
         this->projection_positive_density_check ( x, x_n );
       }
-      if ( SolverSpecify::TS_type == SolverSpecify::BDF2 && SolverSpecify::T_Cycles>=3)
+      if ( SolverSpecify::TS_type == SolverSpecify::BDF2 && n_steps>=3)
       {
         VecZeroEntries ( x );
 
@@ -1564,7 +1619,10 @@ void DDMSolverBase::petsc_snes_convergence_test ( PetscInt its, PetscReal , Pets
     MESSAGE<<"|Eq(Tn)|  ";
     MESSAGE<<"|Eq(Tp)|  ";
     MESSAGE<<"|Eq(BC)|  ";
-    MESSAGE<<"Lg(dx)"<<'\n';
+    MESSAGE<<"Lg(dx)";
+    if( forcing_term_enabled() )
+      MESSAGE<<"   Lits  KSP.rtol";
+    MESSAGE<<'\n';
     MESSAGE<<"--------------------------------------------------------------------------------\n";
     RECORD();
 
@@ -1577,6 +1635,16 @@ void DDMSolverBase::petsc_snes_convergence_test ( PetscInt its, PetscReal , Pets
     functions_norm[6] = electrode_norm;
   }
 
+  // linear iterations spent by the newton step which leads to this iteration
+  PetscInt lits;
+  SNESGetLinearSolveIterations(snes, &lits);
+  if( !its ) linear_iteration_prev = lits;
+  PetscInt step_lits = lits - linear_iteration_prev;
+  linear_iteration_prev = lits;
+
+  // forcing term for next linear solve
+  update_forcing_term(its);
+
   double  toler_relax = SolverSpecify::toler_relax;
   if(its)
     toler_relax = std::max(SolverSpecify::toler_relax, 0.1/(pnorm+1e-8));
@@ -1605,7 +1673,10 @@ void DDMSolverBase::petsc_snes_convergence_test ( PetscInt its, PetscReal , Pets
   MESSAGE<< hole_energy_equation_norm << (hole_energy_equation_conv ? "* " : "  ");
   MESSAGE<< electrode_norm << (electrode_conv ? "* " : "  ");
   MESSAGE<< std::fixed << std::setw(4) << (pnorm==0.0 ? -std::numeric_limits<PetscScalar>::infinity():log10(pnorm))
-    << (pnorm < SolverSpecify::relative_toler ? "*" : " ") << "\n" ;
+    << (pnorm < SolverSpecify::relative_toler ? "*" : " ");
+  if( forcing_term_enabled() )
+    MESSAGE<< std::setw(7) << step_lits << "  " << std::scientific << ksp_forcing;
+  MESSAGE<< "\n" ;
   RECORD();
   MESSAGE.precision ( 6 );
   MESSAGE<< std::scientific;
@@ -1696,6 +1767,74 @@ void DDMSolverBase::petsc_snes_convergence_test ( PetscInt its, PetscReal , Pets
 
 
 
+/*------------------------------------------------------------------
+ * scaled function norm, the max ratio of equation norm to its tolerance
+ */
+PetscReal DDMSolverBase::scaled_function_norm() const
+{
+  PetscReal norm = 0.0;
+  norm = std::max(norm, poisson_norm/SolverSpecify::poisson_abs_toler);
+  norm = std::max(norm, elec_continuity_norm/SolverSpecify::elec_continuity_abs_toler);
+  norm = std::max(norm, hole_continuity_norm/SolverSpecify::hole_continuity_abs_toler);
+  norm = std::max(norm, heat_equation_norm/SolverSpecify::heat_equation_abs_toler);
+  norm = std::max(norm, elec_energy_equation_norm/SolverSpecify::elec_energy_abs_toler);
+  norm = std::max(norm, hole_energy_equation_norm/SolverSpecify::hole_energy_abs_toler);
+  norm = std::max(norm, electrode_norm/SolverSpecify::electrode_abs_toler);
+  return norm;
+}
+
+
+/*------------------------------------------------------------------
+ * forcing term is only meaningful for iterative linear solver
+ */
+bool DDMSolverBase::forcing_term_enabled() const
+{
+  return SolverSpecify::ksp_ew &&
+         SolverSpecify::linear_solver_category(_linear_solver_type) == SolverSpecify::ITERATIVE;
+}
+
+
+/*------------------------------------------------------------------
+ * Eisenstat-Walker forcing term (choice 2), driven by the scaled
+ * equation norms instead of the raw |f|_2, which is dominated by
+ * the equation with largest physical unit
+ */
+void DDMSolverBase::update_forcing_term(PetscInt its)
+{
+  if( !forcing_term_enabled() )
+  {
+    ksp_forcing = SolverSpecify::ksp_rtol;
+    return;
+  }
+
+  PetscReal norm = this->scaled_function_norm();
+
+  if( !its || scaled_function_norm_prev <= 0.0 )
+    ksp_forcing = SolverSpecify::ksp_ew_rtol0;
+  else
+  {
+    const PetscReal gamma = SolverSpecify::ksp_ew_gamma;
+    const PetscReal alpha = SolverSpecify::ksp_ew_alpha;
+
+    PetscReal eta = gamma*std::pow(norm/scaled_function_norm_prev, alpha);
+
+    // safeguard, prevent the forcing term decreasing too fast
+    PetscReal eta_safe = gamma*std::pow(ksp_forcing, alpha);
+    if( eta_safe > 0.1 ) eta = std::max(eta, eta_safe);
+
+    // avoid over solving, the linear residual need not be much smaller than the nonlinear tolerance
+    if( norm > 0.0 ) eta = std::max(eta, 0.5/norm);
+
+    ksp_forcing = eta;
+  }
+
+  ksp_forcing = std::min(ksp_forcing, SolverSpecify::ksp_ew_rtol_max);
+  ksp_forcing = std::max(ksp_forcing, SolverSpecify::ksp_rtol);
+
+  scaled_function_norm_prev = norm;
+}
+
+
 /*------------------------------------------------------------------
  * ksp convergence criteria
  */
@@ -1703,7 +1842,7 @@ void DDMSolverBase::petsc_ksp_convergence_test ( PetscInt its, PetscReal rnorm,
 {
 
   PetscInt kspit = std::max(200, std::min(1000, static_cast<int>(n_global_dofs/10)));
-  PetscScalar rtol = SolverSpecify::ksp_rtol;
+  PetscScalar rtol = forcing_term_enabled() ? ksp_forcing : SolverSpecify::ksp_rtol;
   PetscScalar abstol = std::max ( SolverSpecify::ksp_atol_fnorm*function_norm, SolverSpecify::ksp_atol);
 
   if(its > static_cast<PetscInt>(0.3*kspit))
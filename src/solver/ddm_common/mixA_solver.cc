@@ -1137,6 +1137,15 @@ int MixASolverBase::solve_transient()
   // time dependent
   SolverSpecify::TimeDependent = true;
 
+  // transient integration history of spice is not in checkpoint, always start from TStart
+  if(SolverSpecify::Resume)
+  {
+    MESSAGE<<"Warning: mixed-mode transient can not resume from checkpoint, start from TStart."<<'\n';
+    RECORD();
+    SolverSpecify::Resume = false;
+    SolverSpecify::TimeStepDone = false;
+  }
+
   // if BDF2 scheme is used, we should set SolverSpecify::BDF2_LowerOrder flag to true
   if(SolverSpecify::TS_type==SolverSpecify::BDF2)
     SolverSpecify::BDF2_LowerOrder = true;
@@ -1429,11 +1438,24 @@ void MixASolverBase::petsc_snes_convergence_test(PetscInt its, PetscReal , Petsc
     MESSAGE<<"|Eq(Tn)|  ";
     MESSAGE<<"|Eq(Tp)|  ";
     MESSAGE<<"| SPICE | ";
-    MESSAGE<<"Lg(dx)"<<'\n';
+    MESSAGE<<"Lg(dx)";
+    if( forcing_term_enabled() )
+      MESSAGE<<"   Lits  KSP.rtol";
+    MESSAGE<<'\n';
     MESSAGE<<"--------------------------------------------------------------------------------\n";
     RECORD();
   }
 
+  // linear iterations spent by the newton step which leads to this iteration
+  PetscInt lits;
+  SNESGetLinearSolveIterations(snes, &lits);
+  if( !its ) linear_iteration_prev = lits;
+  PetscInt step_lits = lits - linear_iteration_prev;
+  linear_iteration_prev = lits;
+
+  // forcing term for next linear solve
+  update_forcing_term(its);
+
   double  toler_relax = SolverSpecify::toler_relax;
   if(its)
     toler_relax = std::max(SolverSpecify::toler_relax, 0.1/(pnorm+1e-8));
@@ -1463,7 +1485,10 @@ void MixASolverBase::petsc_snes_convergence_test(PetscInt its, PetscReal , Petsc
   MESSAGE<< hole_energy_equation_norm << (hole_energy_equation_conv ? "* " : "  ");
   MESSAGE<< spice_norm << (spice_conv ? "* " : "  ");
   MESSAGE<< std::fixed << std::setw(4) << (pnorm==0.0 ? -std::numeric_limits<PetscScalar>::infinity():log10(pnorm))
-    << (pnorm < SolverSpecify::relative_toler ? "*" : " ") << "\n" ;
+    << (pnorm < SolverSpecify::relative_toler ? "*" : " ");
+  if( forcing_term_enabled() )
+    MESSAGE<< std::setw(7) << step_lits << "  " << std::scientific << ksp_forcing;
+  MESSAGE<< "\n" ;
   RECORD();
   MESSAGE.precision ( 6 );
   MESSAGE<< std::scientific;
@@ -1554,6 +1579,15 @@ void MixASolverBase::petsc_snes_convergence_test(PetscInt its, PetscReal , Petsc
 }
 
 
+/*------------------------------------------------------------------
+ * scaled function norm, with spice circuit considered
+ */
+PetscReal MixASolverBase::scaled_function_norm() const
+{
+  return std::max(DDMSolverBase::scaled_function_norm(), spice_norm/SolverSpecify::spice_abs_toler);
+}
+
+
 /*------------------------------------------------------------------
  * ksp convergence criteria
  */
@@ -1561,7 +1595,7 @@ void MixASolverBase::petsc_ksp_convergence_test ( PetscInt its, PetscReal rnorm,
 {
   PetscInt kspit = std::max(200, std::min(1000, static_cast<int>(n_global_dofs/10)));
 
-  PetscScalar rtol = SolverSpecify::ksp_rtol;
+  PetscScalar rtol = forcing_term_enabled() ? ksp_forcing : SolverSpecify::ksp_rtol;
   PetscScalar abstol = std::max ( std::min(1e-3,SolverSpecify::ksp_atol_fnorm*function_norm), SolverSpecify::ksp_atol);
   if(its > static_cast<PetscInt>(0.3*kspit))
     abstol *= 1e1;
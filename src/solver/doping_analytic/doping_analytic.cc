@@ -139,23 +139,73 @@ int DopingAnalytic::solve()
       ion_map.insert(std::make_pair(name, std::make_pair(ion_index, ion_type)));
     }
 
+    std::vector<FVM_Node *> fvm_nodes;
     SimulationRegion::local_node_iterator node_it = region->on_local_nodes_begin();
     SimulationRegion::local_node_iterator node_it_end = region->on_local_nodes_end();
     for(; node_it!=node_it_end; ++node_it)
+      fvm_nodes.push_back(*node_it);
+
+    // node coordinates of this region in continuous arrays
+    const unsigned int n_nodes = fvm_nodes.size();
+    std::vector<double> x(n_nodes), y(n_nodes), z(n_nodes);
+    Point box_min( 1e30,  1e30,  1e30);
+    Point box_max(-1e30, -1e30, -1e30);
+    for(unsigned int v=0; v<n_nodes; ++v)
     {
-      FVM_Node * fvm_node = *node_it;
-      FVM_NodeData * node_data = fvm_node->node_data();
+      const Node * node = fvm_nodes[v]->root_node();
+      x[v] = (*node)(0);
+      y[v] = (*node)(1);
+      z[v] = (*node)(2);
+      for(unsigned int d=0; d<3; ++d)
+      {
+        box_min(d) = std::min(box_min(d), (*node)(d));
+        box_max(d) = std::max(box_max(d), (*node)(d));
+      }
+    }
+
+    // both signs are accumulated in one pass of each doping function
+    std::vector<double> Na(n_nodes, 0.0), Nd(n_nodes, 0.0);
+    std::vector<double> values;
+
+    for(size_t i=0; i<_doping_funs.size(); i++)
+    {
+      _do_doping_function(_doping_funs[i], x, y, z, box_min, box_max, values);
+      for(unsigned int v=0; v<n_nodes; ++v)
+      {
+        Na[v] += values[v] < 0.0 ? -values[v] : 0.0;
+        Nd[v] += values[v] > 0.0 ?  values[v] : 0.0;
+      }
+    }
+
+    // doping data interpolated once for all the nodes of this region, shared by Na and Nd
+    for(size_t i=0; i<_doping_data.size(); i++)
+    {
+      _do_doping_interp(i, fvm_nodes, values);
+      for(unsigned int v=0; v<n_nodes; ++v)
+      {
+        Na[v] += values[v] < 0.0 ? -values[v] : 0.0;
+        Nd[v] += values[v] > 0.0 ?  values[v] : 0.0;
+      }
+    }
+
+    for(unsigned int v=0; v<n_nodes; ++v)
+    {
+      FVM_NodeData * node_data = fvm_nodes[v]->node_data();
       genius_assert(node_data!=NULL);
+      node_data->Na() = Na[v];
+      node_data->Nd() = Nd[v];
+    }
 
-      const Node * node = fvm_node->root_node();
-      node_data->Na() = doping_Na( node );
-      node_data->Nd() = doping_Nd( node );
-      // fill custom defined variable
-      for (std::map<std::string,DopingFunction *>::iterator it = _custom_profile_funs.begin();
-           it!=_custom_profile_funs.end(); it++)
+    // fill custom defined variable
+    for (std::map<std::string,DopingFunction *>::iterator it = _custom_profile_funs.begin();
+         it!=_custom_profile_funs.end(); it++)
+    {
+      const std::string & name = it->first;
+      _do_doping_function(it->second, x, y, z, box_min, box_max, values);
+      for(unsigned int v=0; v<n_nodes; ++v)
       {
-        const std::string & name = it->first;
-        double d = it->second->profile((*node)(0),(*node)(1),(*node)(2));
+        FVM_NodeData * node_data = fvm_nodes[v]->node_data();
+        double d = values[v];
         node_data->data<Real>(ion_map[name].first) = d;
         if(ion_map[name].second < 0 ) node_data->Na() += d;
         if(ion_map[name].second > 0 ) node_data->Nd() += d;
@@ -661,94 +711,108 @@ void DopingAnalytic::set_doping_function_analytic2_rec_mask(const Parser::Card &
 }
 
 
-double DopingAnalytic::_do_doping_interp(int i, const Node *node, const std::string &msg)
+void DopingAnalytic::_do_doping_interp(int i, const std::vector<FVM_Node *> &fvm_nodes, std::vector<double> &values)
 {
   int axes = _doping_data[i].first;
   InterpolationBase * interp = _doping_data[i].second;
 
-  Point p;
-  switch(axes)
+  std::vector<Point> points(fvm_nodes.size());
+  for(unsigned int n=0; n<fvm_nodes.size(); ++n)
   {
-    case AXES_X:
-      p[0]=(*node)(0);
-      break;
-    case AXES_Y:
-      p[0]=(*node)(1);
-      break;
-    case AXES_Z:
-      p[0]=(*node)(2);
-      break;
-    case AXES_XY:
-      p[0]=(*node)(0);
-      p[1]=(*node)(1);
-      break;
-    case AXES_XZ:
-      p[0]=(*node)(0);
-      p[1]=(*node)(2);
-      break;
-    case AXES_YZ:
-      p[0]=(*node)(1);
-      p[1]=(*node)(2);
-      break;
-    case AXES_XYZ:
-      p[0]=(*node)(0);
-      p[1]=(*node)(1);
-      p[2]=(*node)(2);
-      break;
+    const Node * node = fvm_nodes[n]->root_node();
+    Point & p = points[n];
+    switch(axes)
+    {
+      case AXES_X:
+        p[0]=(*node)(0);
+        break;
+      case AXES_Y:
+        p[0]=(*node)(1);
+        break;
+      case AXES_Z:
+        p[0]=(*node)(2);
+        break;
+      case AXES_XY:
+        p[0]=(*node)(0);
+        p[1]=(*node)(1);
+        break;
+      case AXES_XZ:
+        p[0]=(*node)(0);
+        p[1]=(*node)(2);
+        break;
+      case AXES_YZ:
+        p[0]=(*node)(1);
+        p[1]=(*node)(2);
+        break;
+      case AXES_XYZ:
+        p[0]=(*node)(0);
+        p[1]=(*node)(1);
+        p[2]=(*node)(2);
+        break;
+    }
   }
-  double d = interp->get_interpolated_value(p, 0);
+
+  interp->get_interpolated_values(points, 0, values);
+
+  const double unit = 1.0/std::pow(PhysicalUnit::cm,3.0);
+  for(unsigned int n=0; n<values.size(); ++n)
+    values[n] *= unit;
+
 #if defined(HAVE_FENV_H) && defined(DEBUG)
   if(fetestexcept(FE_INVALID|FE_DIVBYZERO|FE_OVERFLOW))
   {
-    MESSAGE<< "Warning: problem in interpolating " << msg << " at ";
-    MESSAGE<< (*node)(0)/um << "\t";
-    MESSAGE<< (*node)(1)/um << "\t";
-    MESSAGE<< (*node)(2)/um << " " << d << " , ignored.\n";
+    MESSAGE<< "Warning: problem in interpolating doping profile, ignored.\n";
     RECORD();
     feclearexcept(FE_ALL_EXCEPT);
   }
 #endif
-  return d;
 }
 
-double DopingAnalytic::doping_Na(const Node * node)
+void DopingAnalytic::_do_doping_function(DopingFunction * df, const std::vector<double> &x, const std::vector<double> &y,
+                                         const std::vector<double> &z, const Point &box_min, const Point &box_max,
+                                         std::vector<double> &values)
 {
-  double dop = 0.0;
+  const unsigned int n_nodes = x.size();
+  values.assign(n_nodes, 0.0);
+  if( !n_nodes ) return;
 
-  //only add negative value
-  for(size_t i=0; i<_doping_funs.size(); i++)
-  {
-    double d = _doping_funs[i]->profile((*node)(0),(*node)(1),(*node)(2));
-    dop += d < 0.0 ? d: 0.0;
-  }
-  double unit = 1.0/std::pow(PhysicalUnit::cm,3.0);
-  for(size_t i=0; i<_doping_data.size(); i++)
+  Point f_min, f_max;
+  if( !df->bounding_box(f_min, f_max) )
   {
-    double d = unit * _do_doping_interp(i, node, "Na");
-    dop += d < 0.0 ? d: 0.0;
+    df->profile_batch(n_nodes, &x[0], &y[0], &z[0], &values[0]);
+    return;
   }
 
-  return std::abs(dop);
-}
-
-
+  // the whole region is out of the doping box
+  for(unsigned int d=0; d<3; ++d)
+    if( f_min(d) > box_max(d) || f_max(d) < box_min(d) ) return;
 
-double DopingAnalytic::doping_Nd(const Node * node)
-{
-  double dop = 0.0;
-
-  //only add positive value
-  for(size_t i=0; i<_doping_funs.size(); i++)
+  // only evaluate the points inside the doping box
+  std::vector<unsigned int> index;
+  std::vector<double> bx, by, bz;
+  for(unsigned int v=0; v<n_nodes; ++v)
   {
-    double d = _doping_funs[i]->profile((*node)(0),(*node)(1),(*node)(2));
-    dop += d > 0.0 ? d: 0.0;
+    if( x[v] < f_min(0) || x[v] > f_max(0) ) continue;
+    if( y[v] < f_min(1) || y[v] > f_max(1) ) continue;
+    if( z[v] < f_min(2) || z[v] > f_max(2) ) continue;
+    index.push_back(v);
+    bx.push_back(x[v]);
+    by.push_back(y[v]);
+    bz.push_back(z[v]);
   }
-  double unit = 1.0/std::pow(PhysicalUnit::cm,3.0);
-  for(size_t i=0; i<_doping_data.size(); i++)
+  if( index.empty() ) return;
+
+  std::vector<double> bvalues(index.size());
+  df->profile_batch(index.size(), &bx[0], &by[0], &bz[0], &bvalues[0]);
+  for(unsigned int n=0; n<index.size(); ++n)
+    values[index[n]] = bvalues[n];
+
+#ifdef DEBUG
+  // batch evaluation should agree with the point one
+  for(unsigned int n=0; n<index.size(); ++n)
   {
-    double d = unit * _do_doping_interp(i, node, "Nd");
-    dop += d > 0.0 ? d: 0.0;
+    const double v = df->profile(bx[n], by[n], bz[n]);
+    genius_assert( std::abs(bvalues[n]-v) <= 1e-12*std::abs(v) );
   }
-
-  return std::abs(dop);
+#endif
 }
@@ -1,6 +1,7 @@
 #include "doping_fun.h"
 
 #include <cmath>
+#include <algorithm>
 //win32 does not have erfc function
 #ifdef WINDOWS
 #include "mathfunc.h"
@@ -20,6 +21,14 @@ double UniformDopingFunction::profile(double x,double y,double z)
 }
 
 
+bool UniformDopingFunction::bounding_box(Point &p_min, Point &p_max) const
+{
+  p_min = Point(_xmin-1e-6, _ymin-1e-6, _zmin-1e-6);
+  p_max = Point(_xmax+1e-6, _ymax+1e-6, _zmax+1e-6);
+  return true;
+}
+
+
 
 //------------------------------------------------------------------
 
@@ -81,6 +90,55 @@ double AnalyticDopingFunction::profile(double x, double y, double z)
 }
 
 
+/**
+ * multiply the distribution factor of one direction to values
+ */
+static void analytic_doping_factor(unsigned int n, const double *c, double cmin, double cmax, double CHAR, bool ERFC, double *values)
+{
+  if ( ERFC )
+  {
+    for(unsigned int i=0; i<n; ++i)
+#ifdef WINDOWS
+      values[i] *= (Erfc((c[i]-cmax)/CHAR)-Erfc((c[i]-cmin)/CHAR))/2.0;
+#else
+      values[i] *= (erfc((c[i]-cmax)/CHAR)-erfc((c[i]-cmin)/CHAR))/2.0;
+#endif
+  }
+  else
+  {
+    // distance to [cmin, cmax], zero inside. factor is exactly 1 inside as profile() does,
+    // which also holds for zero characteristic length
+    const double a = 1.0/(CHAR*CHAR);
+    for(unsigned int i=0; i<n; ++i)
+    {
+      const double t = std::max(cmin-c[i], 0.0) + std::max(c[i]-cmax, 0.0);
+      if( t > 0.0 )
+        values[i] *= exp(-t*t*a);
+    }
+  }
+}
+
+
+void AnalyticDopingFunction::profile_batch(unsigned int n, const double *x, const double *y, const double *z, double *values)
+{
+  for(unsigned int i=0; i<n; ++i)
+    values[i] = _ion*_peak;
+
+  analytic_doping_factor(n, x, _xmin, _xmax, _XCHAR, _XERFC, values);
+  analytic_doping_factor(n, y, _ymin, _ymax, _YCHAR, _YERFC, values);
+  analytic_doping_factor(n, z, _zmin, _zmax, _ZCHAR, _ZERFC, values);
+}
+
+
+bool AnalyticDopingFunction::bounding_box(Point &p_min, Point &p_max) const
+{
+  // both exp(-7^2) and erfc(7) are below 1e-21
+  p_min = Point(_xmin-7*_XCHAR, _ymin-7*_YCHAR, _zmin-7*_ZCHAR);
+  p_max = Point(_xmax+7*_XCHAR, _ymax+7*_YCHAR, _zmax+7*_ZCHAR);
+  return true;
+}
+
+
 //------------------------------------------------------------------
 
 PolyMaskDopingFunction::PolyMaskDopingFunction(double ion, const std::vector<Point> &poly, double theta, double phi,
@@ -266,6 +324,36 @@ double RecMaskDopingFunction::profile(double x, double y, double z)
 }
 
 
+bool RecMaskDopingFunction::bounding_box(Point &p_min, Point &p_max) const
+{
+  // the axis of mask normal
+  unsigned int k;
+  if( _mask.is_xy_plane() )      k = 2;
+  else if( _mask.is_xz_plane() ) k = 1;
+  else if( _mask.is_yz_plane() ) k = 0;
+  else return false;
+
+  if( std::abs(_dir(k)) < 1e-10 ) return false;
+
+  // along mask normal, the doping box
+  p_min(k) = _doping_min(k);
+  p_max(k) = _doping_max(k);
+
+  // the max distance from point to mask plane along doping line
+  const double mask_k = _mask.point()(k);
+  const double s_max = std::max(std::abs(mask_k - _doping_min(k)), std::abs(mask_k - _doping_max(k)))/std::abs(_dir(k));
+
+  // in mask plane, the sampled mask area, shifted along doping line
+  for(unsigned int a=0; a<3; ++a)
+  {
+    if( a == k ) continue;
+    p_min(a) = _mask_min(a) - 5*_char_depth - std::abs(_dir(a))*s_max;
+    p_max(a) = _mask_max(a) + 5*_char_depth + std::abs(_dir(a))*s_max;
+  }
+  return true;
+}
+
+
 double RecMaskDopingFunction::_profile_r(double r) const
 {
   double dr;
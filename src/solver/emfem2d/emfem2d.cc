@@ -61,6 +61,9 @@ int EMFEM2DSolver::create_solver()
   // must set linear matrix/vector here!
   setup_linear_data();
 
+  // the wave length independent part of matrix, reused by all the wave lengths
+  build_fem_integrals();
+
   // rtol   = 1e-10*n_global_dofs  - the relative convergence tolerance (relative decrease in the residual norm)
   // abstol = 1e-20*n_global_dofs  - the absolute convergence tolerance (absolute size of the residual norm)
   KSPSetTolerances(ksp, 1e-10*n_global_dofs, 1e-20*n_global_dofs, PETSC_DEFAULT, n_global_dofs/10);
@@ -193,16 +196,8 @@ void EMFEM2DSolver::solve_TE_scatter_problem(double lambda, double power, double
 }
 
 
-void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phase0)
+void EMFEM2DSolver::build_fem_integrals()
 {
-  //wave vector
-  double k = 2*M_PI/lambda;
-
-  // wave magnitude, compute from power
-  double H = sqrt(power*sqrt(eps0/mu0));
-
-  Complex j(0,1);
-
   const MeshBase& mesh = _system.mesh();
   const unsigned int dim = mesh.mesh_dimension();
   genius_assert(dim==2);
@@ -211,11 +206,10 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
   Order int_order=SECOND;
   FEType fe_type;
 
-  VecZeroEntries(x);
-  VecZeroEntries(b);
-  MatZeroEntries(A);
+  _elem_integrals.clear();
+  _boundary_integrals.clear();
 
-  // process scatter field
+  // scatter field
   {
     AutoPtr<FEBase> fe (FEBase::build(dim, fe_type));
 
@@ -225,9 +219,6 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
     // Tell the finite element object to use our quadrature rule.
     fe->attach_quadrature_rule (&qrule);
 
-    // Here we define some references to cell-specific data that
-    // will be used to assemble the linear system.
-    //
     // The element Jacobian * quadrature weight at each integration point.
     const std::vector<Real>& JxW = fe->get_JxW();
 
@@ -240,21 +231,9 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
     const std::vector<std::vector<Real> >& dphidy       = fe->get_dphidy();
     const std::vector<std::vector<Real> >& dphidz       = fe->get_dphidz();
 
-    // Define data structures to contain the element matrix
-    // and right-hand-side vector contribution.
-    DenseMatrix<Complex> Ke;
-    DenseVector<Complex> Fe;
-
-    // Now we will loop over all the elements in the mesh.
-    // We will compute the element matrix and right-hand-side
-    // contribution.
-    for(unsigned int n=0; n<_system.n_regions(); ++n)
+    for(unsigned int r=0; r<_system.n_regions(); ++r)
     {
-      SimulationRegion * region = _system.region(n);
-
-      Complex r = region->get_optical_refraction(lambda);
-      Complex eps(r.real()*r.real()-r.imag()*r.imag(), -2*r.real()*r.imag()) ;
-      double mu=1.0;
+      SimulationRegion * region = _system.region(r);
 
       //for all the elements in this region
       // note, they are all local element, thus must be processed
@@ -266,14 +245,18 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
         genius_assert(elem->active());
         if(elem->processor_id()!=Genius::processor_id()) continue;
 
-        std::vector<PetscInt> dof_indices;
-        this->build_dof_indices(elem, dof_indices);
+        _elem_integrals.push_back(ElemIntegral());
+        ElemIntegral & integral = _elem_integrals.back();
+        integral.region = r;
+        this->build_dof_indices(elem, integral.dof_indices);
+        for(unsigned int m=0; m<elem->n_nodes(); m++)
+          integral.nodes.push_back(elem->get_node(m));
 
         fe->reinit (elem);
 
-        // one complex variable per noe
-        Ke.resize (elem->n_nodes(), elem->n_nodes());
-        Fe.resize (elem->n_nodes());
+        integral.stiffness.resize (elem->n_nodes(), elem->n_nodes());
+        integral.mass.resize (elem->n_nodes(), elem->n_nodes());
+        integral.load.resize (elem->n_nodes(), 0.0);
 
         for (unsigned int qp=0; qp<qrule.n_points(); qp++)
         {
@@ -281,29 +264,20 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
           {
             for (unsigned int n=0; n<phi.size(); n++)
             {
-              // \nabla \cdot frac{1}{eps} \nabla H^_{sc}
-              Ke(m,n) += - JxW[qp]/eps*(  dphidx[m][qp]*dphidx[n][qp]
-                                          + dphidy[m][qp]*dphidy[n][qp]
-                                          + dphidz[m][qp]*dphidz[n][qp]);
-              // k^2*eps*H^_{sc}
-              Ke(m,n) += JxW[qp]*k*k*mu*phi[m][qp]*phi[n][qp];
+              integral.stiffness(m,n) += JxW[qp]*( dphidx[m][qp]*dphidx[n][qp]
+                                                   + dphidy[m][qp]*dphidy[n][qp]
+                                                   + dphidz[m][qp]*dphidz[n][qp]);
+              integral.mass(m,n) += JxW[qp]*phi[m][qp]*phi[n][qp];
             }
-            // source item
-            const Node * node = elem->get_node(m);
-            double phase = phase0 - k*(node->x()*cos(_incidence_angle)+node->y()*sin(_incidence_angle));
-            Complex H_inc = H*std::exp(j*phase);
-            Complex F_inc = -k*k*(1.0/eps-mu)*H_inc;
-            Fe(m) += JxW[qp]*F_inc*phi[m][qp];
+            integral.load[m] += JxW[qp]*phi[m][qp];
           }
         }
-        PetscUtils::VecAdd(b, Fe, dof_indices);
-        PetscUtils::MatAdd(A, Ke, dof_indices);
       }
     }
   }
 
 
-  // process external absobing boundary
+  // external absobing boundary
   {
     // Declare a special finite element object for boundary integration.
     AutoPtr<FEBase> fe_face (FEBase::build(dim-1, fe_type));
@@ -317,9 +291,6 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
     // quadrature rule.
     fe_face->attach_quadrature_rule (&qface);
 
-    // Here we define some references to cell-specific data that
-    // will be used to assemble the linear system.
-    //
     // The element Jacobian * quadrature weight at each integration point.
     const std::vector<Real>& JxW = fe_face->get_JxW();
 
@@ -330,9 +301,6 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
     // points.
     const std::vector<std::vector<Real> >& dphidxi      = fe_face->get_dphidxi();
 
-    // Define data structures to contain the element matrix
-    DenseMatrix<Complex> Ke;
-
     for(unsigned e=0; e<absorb_edge_chain.size(); ++e)
     {
       const Elem * boundary_elem = absorb_edge_chain[e].first;
@@ -340,250 +308,207 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
 
       if(boundary_elem->processor_id()!=Genius::processor_id()) continue;
 
-      Point norm = boundary_elem->outside_unit_normal(f);
-      Point unit = (boundary_elem->point(1)-boundary_elem->point(0)).unit();
-
       AutoPtr<Elem> boundary_face=boundary_elem->build_side(f);
 
-      std::vector<PetscInt> dof_indices;
-      this->build_dof_indices(boundary_face.get(), dof_indices);
+      _boundary_integrals.push_back(BoundaryIntegral());
+      BoundaryIntegral & integral = _boundary_integrals.back();
+      this->build_dof_indices(boundary_face.get(), integral.dof_indices);
+      integral.curvatures = curvature_at_edge(e, boundary_face.get());
 
       fe_face->reinit (boundary_face.get());
 
-      // one complex variable per node
-      Ke.resize (boundary_face->n_nodes(), boundary_face->n_nodes());
-
-      std::vector<double> curvatures = curvature_at_edge(e, boundary_face.get());
+      integral.mass.resize (boundary_face->n_nodes(), boundary_face->n_nodes());
+      integral.dxi.resize (boundary_face->n_nodes(), boundary_face->n_nodes());
 
       for (unsigned int qp=0; qp<qface.n_points(); qp++)
-      {
         for (unsigned int m=0; m<phi.size(); m++)
-        {
-
           for (unsigned int n=0; n<phi.size(); n++)
           {
-            if(_abc_type == FirstOrder)
-              Ke(m,n) += JxW[qp]*(j*k+0.5*curvatures[n])*phi[m][qp]*phi[n][qp];
-
-            if(_abc_type == SecondOrder)
-            {
-              Complex r1 = j*k + 0.5*curvatures[n] - j*curvatures[n]*curvatures[n]/(8.0*(j*curvatures[n])-k);
-              Complex r2 = -j/(2.0*(j*curvatures[n]-k));
-              Ke(m,n) += JxW[qp]*(r1*phi[m][qp]*phi[n][qp]);
-              Ke(m,n) += (r2*dphidxi[m][qp]*dphidxi[n][qp])/boundary_face->volume();
-            }
+            integral.mass(m,n) += JxW[qp]*phi[m][qp]*phi[n][qp];
+            integral.dxi(m,n)  += dphidxi[m][qp]*dphidxi[n][qp]/boundary_face->volume();
           }
-        }
-      }
-
-      PetscUtils::MatAdd(A, Ke, dof_indices);
     }
   }
+}
 
 
-  // assemble matrix and vec
-  VecAssemblyBegin(b);
-  VecAssemblyEnd(b);
 
-  MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
-  MatAssemblyEnd  (A, MAT_FINAL_ASSEMBLY);
+void EMFEM2DSolver::build_absorbing_boundary_matrix(double k)
+{
+  Complex j(0,1);
 
-  //MatView(A, PETSC_VIEWER_DRAW_WORLD);
-  //getchar();
-  // All done!
-}
+  // Define data structures to contain the element matrix
+  DenseMatrix<Complex> Ke;
 
+  for(unsigned e=0; e<_boundary_integrals.size(); ++e)
+  {
+    const BoundaryIntegral & integral = _boundary_integrals[e];
+    const std::vector<double> & curvatures = integral.curvatures;
+    const unsigned int n_nodes = integral.mass.m();
 
+    // one complex variable per node
+    Ke.resize (n_nodes, n_nodes);
 
+    for (unsigned int m=0; m<n_nodes; m++)
+    {
+      for (unsigned int n=0; n<n_nodes; n++)
+      {
+        // (n*k0+curvature/2)*E^_{sc}
+        if(_abc_type == FirstOrder)
+          Ke(m,n) += (j*k+0.5*curvatures[n])*integral.mass(m,n);
 
-void EMFEM2DSolver::build_TM_matrix_rhs(double lambda, double power, double phase0)
+        if(_abc_type == SecondOrder)
+        {
+          Complex r1 = j*k + 0.5*curvatures[n] - j*curvatures[n]*curvatures[n]/(8.0*(j*curvatures[n])-k);
+          Complex r2 = -j/(2.0*(j*curvatures[n]-k));
+          Ke(m,n) += r1*integral.mass(m,n);
+          Ke(m,n) += r2*integral.dxi(m,n);
+        }
+      }
+    }
+
+    PetscUtils::MatAdd(A, Ke, integral.dof_indices);
+  }
+}
+
+
+
+void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phase0)
 {
   //wave vector
   double k = 2*M_PI/lambda;
 
   // wave magnitude, compute from power
-  double E = sqrt(power*sqrt(mu0/eps0));
+  double H = sqrt(power*sqrt(eps0/mu0));
 
   Complex j(0,1);
 
-  const MeshBase& mesh = _system.mesh();
-  const unsigned int dim = mesh.mesh_dimension();
-  genius_assert(dim==2);
-
-  // the integral order used in gauss intergral. default value= 2*fe_order+1
-  Order int_order=SECOND;
-  FEType fe_type;
-
   VecZeroEntries(x);
   VecZeroEntries(b);
   MatZeroEntries(A);
 
   // process scatter field
   {
-    AutoPtr<FEBase> fe (FEBase::build(dim, fe_type));
-
-    // Gauss quadrature rule for numerical integration.
-    QGauss qrule (dim, int_order);
-
-    // Tell the finite element object to use our quadrature rule.
-    fe->attach_quadrature_rule (&qrule);
-
-    // Here we define some references to cell-specific data that
-    // will be used to assemble the linear system.
-    //
-    // The element Jacobian * quadrature weight at each integration point.
-    const std::vector<Real>& JxW = fe->get_JxW();
-
-    // The element shape functions evaluated at the quadrature points.
-    const std::vector<std::vector<Real> >& phi = fe->get_phi();
-
-    // The element shape function gradients evaluated at the quadrature
-    // points.
-    const std::vector<std::vector<Real> >& dphidx       = fe->get_dphidx();
-    const std::vector<std::vector<Real> >& dphidy       = fe->get_dphidy();
-    const std::vector<std::vector<Real> >& dphidz       = fe->get_dphidz();
+    std::vector<Complex> region_eps;
+    for(unsigned int n=0; n<_system.n_regions(); ++n)
+    {
+      Complex r = _system.region(n)->get_optical_refraction(lambda);
+      region_eps.push_back(Complex(r.real()*r.real()-r.imag()*r.imag(), -2*r.real()*r.imag()));
+    }
+    double mu=1.0;
 
     // Define data structures to contain the element matrix
     // and right-hand-side vector contribution.
     DenseMatrix<Complex> Ke;
     DenseVector<Complex> Fe;
 
-    // Now we will loop over all the elements in the mesh.
-    // We will compute the element matrix and right-hand-side
-    // contribution.
-    for(unsigned int n=0; n<_system.n_regions(); ++n)
+    for(unsigned int e=0; e<_elem_integrals.size(); ++e)
     {
-      SimulationRegion * region = _system.region(n);
+      const ElemIntegral & integral = _elem_integrals[e];
+      const Complex eps = region_eps[integral.region];
+      const unsigned int n_nodes = integral.nodes.size();
 
-      Complex r = region->get_optical_refraction(lambda);
-      Complex eps(r.real()*r.real()-r.imag()*r.imag(), -2*r.real()*r.imag()) ;
-      double mu=1.0;
+      // one complex variable per noe
+      Ke.resize (n_nodes, n_nodes);
+      Fe.resize (n_nodes);
 
-      //for all the elements in this region
-      // note, they are all local element, thus must be processed
-      SimulationRegion::element_iterator it = region->elements_begin();
-      SimulationRegion::element_iterator it_end = region->elements_end();
-      for(; it!=it_end; ++it)
+      for (unsigned int m=0; m<n_nodes; m++)
       {
-        const Elem* elem  = *it;
-        genius_assert(elem->active());
-        if(elem->processor_id()!=Genius::processor_id()) continue;
-
-        std::vector<PetscInt> dof_indices;
-        this->build_dof_indices(elem, dof_indices);
-
-        fe->reinit (elem);
-
-        // one complex variable per noe
-        Ke.resize (elem->n_nodes(), elem->n_nodes());
-        Fe.resize (elem->n_nodes());
-
-        for (unsigned int qp=0; qp<qrule.n_points(); qp++)
+        for (unsigned int n=0; n<n_nodes; n++)
         {
-          for (unsigned int m=0; m<phi.size(); m++)
-          {
-            for (unsigned int n=0; n<phi.size(); n++)
-            {
-              // \nabla^2 E^_{sc}
-              Ke(m,n) += - JxW[qp]/mu*( dphidx[m][qp]*dphidx[n][qp]
-                                        + dphidy[m][qp]*dphidy[n][qp]
-                                        + dphidz[m][qp]*dphidz[n][qp]);
-              // k^2*eps*E^_{sc}
-              Ke(m,n) += JxW[qp]*k*k*eps*phi[m][qp]*phi[n][qp];
-            }
-            // source item, F_inc = \nabla^2 E^_{inc} + k^2*eps*E^_{inc}
-            const Node * node = elem->get_node(m);
-            double phase = phase0 - k*(node->x()*cos(_incidence_angle)+node->y()*sin(_incidence_angle));
-            Complex E_inc = E*std::exp(j*phase);
-            Complex F_inc = -k*k*(1.0/mu-eps)*E_inc;
-            Fe(m) += JxW[qp]*F_inc*phi[m][qp];
-          }
+          // \nabla \cdot frac{1}{eps} \nabla H^_{sc} + k^2*eps*H^_{sc}
+          Ke(m,n) = - integral.stiffness(m,n)/eps + k*k*mu*integral.mass(m,n);
         }
-        PetscUtils::VecAdd(b, Fe, dof_indices);
-        PetscUtils::MatAdd(A, Ke, dof_indices);
+        // source item
+        const Node * node = integral.nodes[m];
+        double phase = phase0 - k*(node->x()*cos(_incidence_angle)+node->y()*sin(_incidence_angle));
+        Complex H_inc = H*std::exp(j*phase);
+        Complex F_inc = -k*k*(1.0/eps-mu)*H_inc;
+        Fe(m) = F_inc*integral.load[m];
       }
+      PetscUtils::VecAdd(b, Fe, integral.dof_indices);
+      PetscUtils::MatAdd(A, Ke, integral.dof_indices);
     }
   }
 
-
   // process external absobing boundary
-  {
-    // Declare a special finite element object for boundary integration.
-    AutoPtr<FEBase> fe_face (FEBase::build(dim-1, fe_type));
+  build_absorbing_boundary_matrix(k);
 
-    // Boundary integration requires one quadraure rule,
-    // with dimensionality one less than the dimensionality
-    // of the element.
-    QGauss qface(dim-1, int_order);
+  // assemble matrix and vec
+  VecAssemblyBegin(b);
+  VecAssemblyEnd(b);
 
-    // Tell the finite element object to use our
-    // quadrature rule.
-    fe_face->attach_quadrature_rule (&qface);
+  MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
+  MatAssemblyEnd  (A, MAT_FINAL_ASSEMBLY);
 
-    // Here we define some references to cell-specific data that
-    // will be used to assemble the linear system.
-    //
-    // The element Jacobian * quadrature weight at each integration point.
-    const std::vector<Real>& JxW = fe_face->get_JxW();
+  //MatView(A, PETSC_VIEWER_DRAW_WORLD);
+  //getchar();
+  // All done!
+}
 
-    // The element shape functions evaluated at the quadrature points.
-    const std::vector<std::vector<Real> >& phi = fe_face->get_phi();
 
-    // The element shape function gradients evaluated at the quadrature
-    // points.
-    const std::vector<std::vector<Real> >& dphidxi      = fe_face->get_dphidxi();
 
-    // Define data structures to contain the element matrix
-    DenseMatrix<Complex> Ke;
 
-    for(unsigned e=0; e<absorb_edge_chain.size(); ++e)
-    {
-      const Elem * boundary_elem = absorb_edge_chain[e].first;
-      unsigned int f = absorb_edge_chain[e].second;
+void EMFEM2DSolver::build_TM_matrix_rhs(double lambda, double power, double phase0)
+{
+  //wave vector
+  double k = 2*M_PI/lambda;
 
-      if(boundary_elem->processor_id()!=Genius::processor_id()) continue;
+  // wave magnitude, compute from power
+  double E = sqrt(power*sqrt(mu0/eps0));
 
-      Point norm = boundary_elem->outside_unit_normal(f);
-      Point unit = (boundary_elem->point(1)-boundary_elem->point(0)).unit();
+  Complex j(0,1);
 
-      AutoPtr<Elem> boundary_face=boundary_elem->build_side(f);
+  VecZeroEntries(x);
+  VecZeroEntries(b);
+  MatZeroEntries(A);
 
-      std::vector<PetscInt> dof_indices;
-      this->build_dof_indices(boundary_face.get(), dof_indices);
+  // process scatter field
+  {
+    std::vector<Complex> region_eps;
+    for(unsigned int n=0; n<_system.n_regions(); ++n)
+    {
+      Complex r = _system.region(n)->get_optical_refraction(lambda);
+      region_eps.push_back(Complex(r.real()*r.real()-r.imag()*r.imag(), -2*r.real()*r.imag()));
+    }
+    double mu=1.0;
 
-      fe_face->reinit (boundary_face.get());
+    // Define data structures to contain the element matrix
+    // and right-hand-side vector contribution.
+    DenseMatrix<Complex> Ke;
+    DenseVector<Complex> Fe;
 
-      // one complex variable per node
-      Ke.resize (boundary_face->n_nodes(), boundary_face->n_nodes());
+    for(unsigned int e=0; e<_elem_integrals.size(); ++e)
+    {
+      const ElemIntegral & integral = _elem_integrals[e];
+      const Complex eps = region_eps[integral.region];
+      const unsigned int n_nodes = integral.nodes.size();
 
-      std::vector<double> curvatures = curvature_at_edge(e, boundary_face.get());
+      // one complex variable per noe
+      Ke.resize (n_nodes, n_nodes);
+      Fe.resize (n_nodes);
 
-      for (unsigned int qp=0; qp<qface.n_points(); qp++)
+      for (unsigned int m=0; m<n_nodes; m++)
       {
-        for (unsigned int m=0; m<phi.size(); m++)
+        for (unsigned int n=0; n<n_nodes; n++)
         {
-
-          for (unsigned int n=0; n<phi.size(); n++)
-          {
-            // (n*k0+curvature/2)*E^_{sc}
-            if(_abc_type == FirstOrder)
-              Ke(m,n) += JxW[qp]*(j*k+0.5*curvatures[n])*phi[m][qp]*phi[n][qp];
-
-            if(_abc_type == SecondOrder)
-            {
-              Complex r1 = j*k + 0.5*curvatures[n] - j*curvatures[n]*curvatures[n]/(8.0*(j*curvatures[n])-k);
-              Complex r2 = -j/(2.0*(j*curvatures[n]-k));
-              Ke(m,n) += JxW[qp]*(r1*phi[m][qp]*phi[n][qp]);
-              Ke(m,n) += (r2*dphidxi[m][qp]*dphidxi[n][qp])/boundary_face->volume();
-            }
-          }
+          // \nabla^2 E^_{sc} + k^2*eps*E^_{sc}
+          Ke(m,n) = - integral.stiffness(m,n)/mu + k*k*eps*integral.mass(m,n);
         }
+        // source item, F_inc = \nabla^2 E^_{inc} + k^2*eps*E^_{inc}
+        const Node * node = integral.nodes[m];
+        double phase = phase0 - k*(node->x()*cos(_incidence_angle)+node->y()*sin(_incidence_angle));
+        Complex E_inc = E*std::exp(j*phase);
+        Complex F_inc = -k*k*(1.0/mu-eps)*E_inc;
+        Fe(m) = F_inc*integral.load[m];
       }
-
-      PetscUtils::MatAdd(A, Ke, dof_indices);
+      PetscUtils::VecAdd(b, Fe, integral.dof_indices);
+      PetscUtils::MatAdd(A, Ke, integral.dof_indices);
     }
   }
 
+  // process external absobing boundary
+  build_absorbing_boundary_matrix(k);
 
   // assemble matrix and vec
   VecAssemblyBegin(b);
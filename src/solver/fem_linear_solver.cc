@@ -579,6 +579,18 @@ void FEM_LinearSolver::set_petsc_preconditioner_type(SolverSpecify::Precondition
       return;
     }
 
+    case SolverSpecify::GAMG_PRECOND:
+    {
+#if PETSC_VERSION_GE(3,3,0)
+      MESSAGE<< "Using GAMG preconditioner..."<<std::endl;
+      RECORD();
+      ierr = PCSetType (pc, (char*) PCGAMG);      genius_assert(!ierr);
+      ierr = PetscOptionsSetValue("-pc_gamg_type","agg"); genius_assert(!ierr);
+      return;
+#endif
+      // fall through to BoomerAMG
+    }
+
     case SolverSpecify::BOOMERAMG_PRECOND:
     {
 #ifdef PETSC_HAVE_LIBHYPRE
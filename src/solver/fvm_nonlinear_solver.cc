@@ -24,6 +24,8 @@
 #include <iomanip>
 
 #include "fvm_nonlinear_solver.h"
+#include "simulation_region.h"
+#include "boundary_condition_collector.h"
 #include "parallel.h"
 
 #ifdef HAVE_SLEPC
@@ -212,12 +214,18 @@ void FVM_NonlinearSolver::setup_nonlinear_data()
   if (Genius::n_processors()>1)
   {
     ierr = MatSetType(J,MATMPIAIJ); genius_assert(!ierr);
+    // AMG coarsen all the variables of a node together
+    if (_preconditioner_type == SolverSpecify::GAMG_PRECOND && amg_uniform_block())
+    { ierr = MatSetBlockSize(J, amg_block_size()); genius_assert(!ierr); }
     // alloc memory for parallel matrix here
     ierr = MatMPIAIJSetPreallocation(J, 0, &n_nz[0], 0, &n_oz[0]); genius_assert(!ierr);
   }
   else
   {
     ierr = MatSetType(J,MATSEQAIJ); genius_assert(!ierr);
+    // AMG coarsen all the variables of a node together
+    if (_preconditioner_type == SolverSpecify::GAMG_PRECOND && amg_uniform_block())
+    { ierr = MatSetBlockSize(J, amg_block_size()); genius_assert(!ierr); }
     // alloc memory for sequence matrix here
     ierr = MatSeqAIJSetPreallocation(J, 0, &n_nz[0]); genius_assert(!ierr);
   }
@@ -992,6 +1000,57 @@ void FVM_NonlinearSolver::set_petsc_preconditioner_type()
 
       }
 
+      case SolverSpecify::GAMG_PRECOND:
+      {
+        // NOTE: the jacobian matrix and residual are already row scaled by vector L (see *_Fill_Value),
+        // which makes the diagonal of each equation in the same order. AMG needs this.
+#if PETSC_VERSION_GE(3,3,0)
+        // insulator/electrode nodes and bc dofs break the nodal block, apply AMG to semiconductor dofs only
+        if (!amg_uniform_block() && set_petsc_amg_fieldsplit_preconditioner()) return;
+
+        MESSAGE<< "Using GAMG preconditioner with block size " << (amg_uniform_block() ? amg_block_size() : 1) << "..."<<std::endl;
+        RECORD();
+        ierr = PCSetType (pc, (char*) PCGAMG);      genius_assert(!ierr);
+        ierr = PetscOptionsSetValue("-pc_gamg_type","agg"); genius_assert(!ierr);
+        ierr = PetscOptionsSetValue("-pc_gamg_agg_nsmooths","1"); genius_assert(!ierr);
+        set_petsc_amg_near_null_space();
+        return;
+#elif defined(PETSC_HAVE_ML)
+        MESSAGE<< "Using ML smoothed aggregation preconditioner with block size " << (amg_uniform_block() ? amg_block_size() : 1) << "..."<<std::endl;
+        RECORD();
+        ierr = PCSetType (pc, (char*) PCML);        genius_assert(!ierr);
+        return;
+#elif defined(PETSC_HAVE_LIBHYPRE)
+        MESSAGE<< "Using Hypre/BoomerAMG preconditioner with block size " << (amg_uniform_block() ? amg_block_size() : 1) << "..."<<std::endl;
+        RECORD();
+        ierr = PCSetType (pc, (char*) PCHYPRE);     genius_assert(!ierr);
+        ierr = PCHYPRESetType (pc, "boomeramg");    genius_assert(!ierr);
+        if (amg_uniform_block() && amg_block_size() > 1)
+        { ierr = PetscOptionsSetValue("-pc_hypre_boomeramg_nodal_coarsen","1"); genius_assert(!ierr); }
+        // hypre suggests a larger strong threshold for 3D problem
+        if (_system.mesh().mesh_dimension() == 3)
+        { ierr = PetscOptionsSetValue("-pc_hypre_boomeramg_strong_threshold","0.5"); genius_assert(!ierr); }
+        return;
+#else
+        MESSAGE << "Warning:  no AMG preconditioner configured, use ASM instead!" << std::endl;
+        RECORD();
+        ierr = PCSetType (pc, (char*) PCASM);       genius_assert(!ierr);
+        return;
+#endif
+      }
+
+      case SolverSpecify::SCHUR_PRECOND:
+      {
+        // only the linear system of each newton step is condensed,
+        // newton still iterates on the insulator/conductor/vacuum dofs
+        if (set_petsc_schur_complement_preconditioner()) return;
+
+        MESSAGE << "Warning:  no insulator/conductor/vacuum region for Schur complement preconditioner, use ASM instead!" << std::endl;
+        RECORD();
+        ierr = PCSetType (pc, (char*) PCASM);       genius_assert(!ierr);
+        return;
+      }
+
       case SolverSpecify::JACOBI_PRECOND:
       ierr = PCSetType (pc, (char*) PCJACOBI);    genius_assert(!ierr); return;
 
@@ -1021,6 +1080,339 @@ void FVM_NonlinearSolver::set_petsc_preconditioner_type()
 }
 
 
+unsigned int FVM_NonlinearSolver::amg_block_size() const
+{
+  unsigned int block_size = 0;
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    const SimulationRegion * region = _system.region(n);
+    if (region->type() != SemiconductorRegion) continue;
+    unsigned int dofs = node_dofs(region);
+    if (block_size && block_size != dofs) return 1;
+    block_size = dofs;
+  }
+
+  return block_size ? block_size : 1;
+}
+
+
+
+bool FVM_NonlinearSolver::amg_uniform_block() const
+{
+  // extra dofs of bc and solver break the nodal block structure
+  if (n_global_dofs != n_global_node_dofs) return false;
+
+  const unsigned int block_size = amg_block_size();
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    unsigned int dofs = node_dofs(_system.region(n));
+    if (dofs && dofs != block_size) return false;
+  }
+
+  return true;
+}
+
+
+
+void FVM_NonlinearSolver::set_petsc_amg_near_null_space()
+{
+#if PETSC_VERSION_GE(3,3,0)
+  PetscErrorCode ierr;
+
+  unsigned int n_vecs = 0;
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+    n_vecs = std::max(n_vecs, node_dofs(_system.region(n)));
+  if (!n_vecs) return;
+
+  // piecewise constant vector for each nodal variable, it is the near kernel of
+  // the diffusion-like operator of poisson's, continuity and energy balance equations
+  std::vector<Vec> null_vecs(n_vecs);
+  for(unsigned int i=0; i<n_vecs; ++i)
+  {
+    ierr = VecDuplicate(x, &null_vecs[i]); genius_assert(!ierr);
+    ierr = VecSet(null_vecs[i], 0.0); genius_assert(!ierr);
+  }
+
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    const SimulationRegion * region = _system.region(n);
+    unsigned int dofs = node_dofs(region);
+
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * fvm_node = *node_it;
+      for(unsigned int i=0; i<dofs; ++i)
+      { ierr = VecSetValue(null_vecs[i], fvm_node->global_offset()+i, 1.0, INSERT_VALUES); genius_assert(!ierr); }
+    }
+  }
+
+  // extra bc dofs are electrode potentials, which belong to the last processor
+  if (Genius::processor_id() == Genius::n_processors()-1)
+  {
+    for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
+    {
+      const BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+      if (bc_dofs(bc) > 0)
+      { ierr = VecSetValue(null_vecs[0], bc->global_offset(), 1.0, INSERT_VALUES); genius_assert(!ierr); }
+    }
+  }
+
+  for(unsigned int i=0; i<n_vecs; ++i)
+  {
+    ierr = VecAssemblyBegin(null_vecs[i]); genius_assert(!ierr);
+    ierr = VecAssemblyEnd(null_vecs[i]);   genius_assert(!ierr);
+    // these vectors have disjoint nonzero pattern, they are orthonormal after normalization
+    ierr = VecNormalize(null_vecs[i], PETSC_NULL); genius_assert(!ierr);
+  }
+
+  MatNullSpace near_null_space;
+  ierr = MatNullSpaceCreate(PETSC_COMM_WORLD, PETSC_FALSE, n_vecs, &null_vecs[0], &near_null_space); genius_assert(!ierr);
+  ierr = MatSetNearNullSpace(J, near_null_space); genius_assert(!ierr);
+  ierr = MatNullSpaceDestroy(PetscDestroyObject(near_null_space)); genius_assert(!ierr);
+
+  for(unsigned int i=0; i<n_vecs; ++i)
+  { ierr = VecDestroy(PetscDestroyObject(null_vecs[i])); genius_assert(!ierr); }
+#endif
+}
+
+
+
+bool FVM_NonlinearSolver::set_petsc_amg_fieldsplit_preconditioner()
+{
+  // the sub matrix takes block size and near null space from index set since PETSc 3.4
+#if PETSC_VERSION_GE(3,4,0)
+  PetscErrorCode ierr;
+
+  const unsigned int block_size = amg_block_size();
+  if (block_size < 2) return false;
+
+  // semiconductor node dofs, in the order of global dof, node by node
+  std::vector<bool> is_semiconductor_dof(n_local_dofs, false);
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    const SimulationRegion * region = _system.region(n);
+    if (region->type() != SemiconductorRegion) continue;
+
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * fvm_node = *node_it;
+      for(unsigned int i=0; i<block_size; ++i)
+        is_semiconductor_dof[fvm_node->global_offset()+i-global_offset] = true;
+    }
+  }
+
+  std::vector<PetscInt> semiconductor_dofs, other_dofs;
+  for(unsigned int i=0; i<n_local_dofs; ++i)
+  {
+    if (is_semiconductor_dof[i])
+      semiconductor_dofs.push_back(global_offset+i);
+    else
+      other_dofs.push_back(global_offset+i);
+  }
+
+  unsigned int n_semiconductor_dofs = semiconductor_dofs.size();
+  Parallel::sum(n_semiconductor_dofs);
+  if (!n_semiconductor_dofs || n_semiconductor_dofs == n_global_dofs) return false;
+
+  MESSAGE<< "Using GAMG preconditioner with block size " << block_size << " on " << n_semiconductor_dofs << " of " << n_global_dofs
+         << " dofs in semiconductor regions..."<<std::endl;
+  RECORD();
+
+  IS is_semiconductor, is_other;
+  ierr = ISCreateGeneral(PETSC_COMM_WORLD, semiconductor_dofs.size(), semiconductor_dofs.empty() ? PETSC_NULL : &semiconductor_dofs[0], PETSC_COPY_VALUES, &is_semiconductor); genius_assert(!ierr);
+  ierr = ISCreateGeneral(PETSC_COMM_WORLD, other_dofs.size(), other_dofs.empty() ? PETSC_NULL : &other_dofs[0], PETSC_COPY_VALUES, &is_other); genius_assert(!ierr);
+  ierr = ISSetBlockSize(is_semiconductor, block_size); genius_assert(!ierr);
+
+  // piecewise constant vector for each nodal variable of semiconductor dofs
+  std::vector<Vec> null_vecs(block_size);
+  for(unsigned int i=0; i<block_size; ++i)
+  {
+    ierr = VecCreateMPI(PETSC_COMM_WORLD, semiconductor_dofs.size(), n_semiconductor_dofs, &null_vecs[i]); genius_assert(!ierr);
+    ierr = VecSet(null_vecs[i], 0.0); genius_assert(!ierr);
+
+    PetscScalar * array;
+    ierr = VecGetArray(null_vecs[i], &array); genius_assert(!ierr);
+    for(unsigned int j=i; j<semiconductor_dofs.size(); j+=block_size)
+      array[j] = 1.0;
+    ierr = VecRestoreArray(null_vecs[i], &array); genius_assert(!ierr);
+    ierr = VecNormalize(null_vecs[i], PETSC_NULL); genius_assert(!ierr);
+  }
+
+  MatNullSpace near_null_space;
+  ierr = MatNullSpaceCreate(PETSC_COMM_WORLD, PETSC_FALSE, block_size, &null_vecs[0], &near_null_space); genius_assert(!ierr);
+  ierr = PetscObjectCompose((PetscObject)is_semiconductor, "nearnullspace", (PetscObject)near_null_space); genius_assert(!ierr);
+  ierr = MatNullSpaceDestroy(PetscDestroyObject(near_null_space)); genius_assert(!ierr);
+  for(unsigned int i=0; i<block_size; ++i)
+  { ierr = VecDestroy(PetscDestroyObject(null_vecs[i])); genius_assert(!ierr); }
+
+  ierr = PCSetType (pc, (char*) PCFIELDSPLIT);  genius_assert(!ierr);
+  ierr = PCFieldSplitSetIS(pc, "0", is_semiconductor); genius_assert(!ierr);
+  ierr = PCFieldSplitSetIS(pc, "1", is_other);         genius_assert(!ierr);
+  ierr = PCFieldSplitSetType(pc, PC_COMPOSITE_MULTIPLICATIVE); genius_assert(!ierr);
+
+  // PCFieldSplit holds the reference of index set
+  ierr = ISDestroy(PetscDestroyObject(is_semiconductor)); genius_assert(!ierr);
+  ierr = ISDestroy(PetscDestroyObject(is_other));         genius_assert(!ierr);
+
+  // nodal AMG for semiconductor dofs
+  ierr = PetscOptionsSetValue("-fieldsplit_0_ksp_type","preonly"); genius_assert(!ierr);
+  ierr = PetscOptionsSetValue("-fieldsplit_0_pc_type","gamg"); genius_assert(!ierr);
+  ierr = PetscOptionsSetValue("-fieldsplit_0_pc_gamg_type","agg"); genius_assert(!ierr);
+  ierr = PetscOptionsSetValue("-fieldsplit_0_pc_gamg_agg_nsmooths","1"); genius_assert(!ierr);
+
+  // insulator/electrode node dofs and bc dofs, ILU as the default preconditioner does
+  ierr = PetscOptionsSetValue("-fieldsplit_1_ksp_type","preonly"); genius_assert(!ierr);
+  if (Genius::n_processors()>1)
+  {
+    ierr = PetscOptionsSetValue("-fieldsplit_1_pc_type","asm"); genius_assert(!ierr);
+    ierr = PetscOptionsSetValue("-fieldsplit_1_sub_pc_type","ilu"); genius_assert(!ierr);
+    ierr = PetscOptionsSetValue("-fieldsplit_1_sub_pc_factor_shift_type","NONZERO"); genius_assert(!ierr);
+  }
+  else
+  {
+    ierr = PetscOptionsSetValue("-fieldsplit_1_pc_type","ilu"); genius_assert(!ierr);
+    ierr = PetscOptionsSetValue("-fieldsplit_1_pc_factor_shift_type","NONZERO"); genius_assert(!ierr);
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+
+void FVM_NonlinearSolver::split_linear_region_dofs(std::vector<PetscInt> & linear_dofs, std::vector<PetscInt> & nonlinear_dofs) const
+{
+  linear_dofs.clear();
+  nonlinear_dofs.clear();
+
+  std::vector<bool> is_linear_dof(n_local_dofs, false);
+
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    const SimulationRegion * region = _system.region(n);
+    switch(region->type())
+    {
+      case InsulatorRegion :
+      case ElectrodeRegion :
+      case MetalRegion     :
+      case VacuumRegion    : break;
+      default              : continue;
+    }
+
+    unsigned int dofs = node_dofs(region);
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * fvm_node = *node_it;
+      for(unsigned int i=0; i<dofs; ++i)
+        is_linear_dof[fvm_node->global_offset()+i-global_offset] = true;
+    }
+  }
+
+  // semiconductor, bc and extra dofs are all considered as nonlinear ones
+  for(unsigned int i=0; i<n_local_dofs; ++i)
+  {
+    if (is_linear_dof[i])
+      linear_dofs.push_back(global_offset+i);
+    else
+      nonlinear_dofs.push_back(global_offset+i);
+  }
+}
+
+
+
+bool FVM_NonlinearSolver::set_petsc_schur_complement_preconditioner()
+{
+#if PETSC_VERSION_GE(3,1,0)
+  PetscErrorCode ierr;
+
+  std::vector<PetscInt> linear_dofs, nonlinear_dofs;
+  split_linear_region_dofs(linear_dofs, nonlinear_dofs);
+
+  unsigned int n_linear_dofs = linear_dofs.size();
+  Parallel::sum(n_linear_dofs);
+  if (!n_linear_dofs || n_linear_dofs == n_global_dofs) return false;
+
+  MESSAGE<< "Using Schur complement preconditioner for linear solver, " << n_linear_dofs << " of " << n_global_dofs
+         << " dofs in insulator/conductor/vacuum regions are split out..."<<std::endl;
+  RECORD();
+
+  IS is_linear, is_nonlinear;
+#if PETSC_VERSION_GE(3,2,0)
+  ierr = ISCreateGeneral(PETSC_COMM_WORLD, linear_dofs.size(), linear_dofs.empty() ? PETSC_NULL : &linear_dofs[0], PETSC_COPY_VALUES, &is_linear); genius_assert(!ierr);
+  ierr = ISCreateGeneral(PETSC_COMM_WORLD, nonlinear_dofs.size(), nonlinear_dofs.empty() ? PETSC_NULL : &nonlinear_dofs[0], PETSC_COPY_VALUES, &is_nonlinear); genius_assert(!ierr);
+#else
+  ierr = ISCreateGeneral(PETSC_COMM_WORLD, linear_dofs.size(), linear_dofs.empty() ? PETSC_NULL : &linear_dofs[0], &is_linear); genius_assert(!ierr);
+  ierr = ISCreateGeneral(PETSC_COMM_WORLD, nonlinear_dofs.size(), nonlinear_dofs.empty() ? PETSC_NULL : &nonlinear_dofs[0], &is_nonlinear); genius_assert(!ierr);
+#endif
+
+  ierr = PCSetType (pc, (char*) PCFIELDSPLIT);  genius_assert(!ierr);
+#if PETSC_VERSION_GE(3,3,0)
+  ierr = PCFieldSplitSetIS(pc, "0", is_linear);    genius_assert(!ierr);
+  ierr = PCFieldSplitSetIS(pc, "1", is_nonlinear); genius_assert(!ierr);
+#else
+  ierr = PCFieldSplitSetIS(pc, is_linear);    genius_assert(!ierr);
+  ierr = PCFieldSplitSetIS(pc, is_nonlinear); genius_assert(!ierr);
+#endif
+  ierr = PCFieldSplitSetType(pc, PC_COMPOSITE_SCHUR); genius_assert(!ierr);
+
+  // PCFieldSplit holds the reference of index set
+  ierr = ISDestroy(PetscDestroyObject(is_linear));    genius_assert(!ierr);
+  ierr = ISDestroy(PetscDestroyObject(is_nonlinear)); genius_assert(!ierr);
+
+  // the linear region block is eliminated by direct factorization.
+  // its nonzero pattern never changes, keep the ordering and fill
+  ierr = PetscOptionsSetValue("-fieldsplit_0_ksp_type","preonly"); genius_assert(!ierr);
+  if (Genius::n_processors()>1)
+  {
+#ifdef PETSC_HAVE_MUMPS
+    ierr = PetscOptionsSetValue("-fieldsplit_0_pc_type","lu"); genius_assert(!ierr);
+    ierr = PetscOptionsSetValue("-fieldsplit_0_pc_factor_mat_solver_package","mumps"); genius_assert(!ierr);
+#else
+    ierr = PetscOptionsSetValue("-fieldsplit_0_pc_type","bjacobi"); genius_assert(!ierr);
+    ierr = PetscOptionsSetValue("-fieldsplit_0_sub_pc_type","lu"); genius_assert(!ierr);
+#endif
+  }
+  else
+  {
+    ierr = PetscOptionsSetValue("-fieldsplit_0_pc_type","lu"); genius_assert(!ierr);
+    ierr = PetscOptionsSetValue("-fieldsplit_0_pc_factor_reuse_ordering","1"); genius_assert(!ierr);
+    ierr = PetscOptionsSetValue("-fieldsplit_0_pc_factor_reuse_fill","1"); genius_assert(!ierr);
+  }
+  ierr = PetscOptionsSetValue("-fieldsplit_0_pc_factor_shift_type","NONZERO"); genius_assert(!ierr);
+
+  // the Schur complement of semiconductor dofs, preconditioned by its diagonal block.
+  // inner iterations make the preconditioner vary from step to step, which only a flexible
+  // outer solver allows. otherwise apply the preconditioner of the Schur complement once.
+  if (_linear_solver_type == SolverSpecify::FGMRES)
+  {
+    ierr = PetscOptionsSetValue("-fieldsplit_1_ksp_type","gmres"); genius_assert(!ierr);
+    ierr = PetscOptionsSetValue("-fieldsplit_1_ksp_rtol","1e-3"); genius_assert(!ierr);
+  }
+  else
+  {
+    ierr = PetscOptionsSetValue("-fieldsplit_1_ksp_type","preonly"); genius_assert(!ierr);
+  }
+  ierr = PetscOptionsSetValue("-fieldsplit_1_pc_type", Genius::n_processors()>1 ? "asm" : "ilu"); genius_assert(!ierr);
+  ierr = PetscOptionsSetValue("-fieldsplit_1_sub_pc_type","ilu"); genius_assert(!ierr);
+  ierr = PetscOptionsSetValue("-fieldsplit_1_pc_factor_shift_type","NONZERO"); genius_assert(!ierr);
+  ierr = PetscOptionsSetValue("-fieldsplit_1_sub_pc_factor_shift_type","NONZERO"); genius_assert(!ierr);
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+
 #if PETSC_VERSION_LE(3,1,0)
 #define SNES_DIVERGED_LINE_SEARCH SNES_DIVERGED_LS_FAILURE
 #endif
@@ -21,6 +21,7 @@
 
 
 #include <cmath>
+#include <new>
 
 #include "plane.h"
 #include "light_thread.h"
@@ -51,7 +52,8 @@ std::vector<double> LightThread::advance_to(const Point & p_end, double a_band,
 }
 
 
-std::pair<LightThread *, LightThread *> LightThread::interface_light_gen_linear_polarized(const Point & in_p, const Point & norm, double n1, double n2)
+std::pair<LightThread *, LightThread *> LightThread::interface_light_gen_linear_polarized(const Point & in_p, const Point & norm, double n1, double n2,
+                                                                                       LightThreadPool * pool)
 {
   double n = n2/n1;
 
@@ -107,13 +109,13 @@ std::pair<LightThread *, LightThread *> LightThread::interface_light_gen_linear_
           _E_dir_reflect = (sqrt(reflect_parallel)*reflect_dir.cross(incident_plane.unit_normal()) - sqrt(reflect_perpendicular)*E_perpendicular).unit();
         else
           _E_dir_reflect = (sqrt(reflect_parallel)*reflect_dir.cross(incident_plane.unit_normal()) + sqrt(reflect_perpendicular)*E_perpendicular).unit();
-        reflect_light = new LightThread(in_p, reflect_dir, _E_dir_reflect, _wavelength, _init_power, reflect_eff*_power);
+        reflect_light = _new_light(pool, in_p, reflect_dir, _E_dir_reflect, _wavelength, _init_power, reflect_eff*_power);
       }
 
       if( refract_eff >=1e-9 )
       {
         Point _E_dir_refract = (sqrt(refract_parallel)*refract_dir.cross(incident_plane.unit_normal()) + sqrt(refract_perpendicular)*E_perpendicular).unit();
-        refract_light = new LightThread(in_p, refract_dir, _E_dir_refract, _wavelength, _init_power, refract_eff*_power);
+        refract_light = _new_light(pool, in_p, refract_dir, _E_dir_refract, _wavelength, _init_power, refract_eff*_power);
       }
 
       return std::make_pair(reflect_light, refract_light);
@@ -121,7 +123,7 @@ std::pair<LightThread *, LightThread *> LightThread::interface_light_gen_linear_
     else //for full reflection
     {
       Point _E_dir_reflect = (reflect_dir.cross(incident_plane.unit_normal()) + E_perpendicular).unit();
-      LightThread * reflect_light = new LightThread(in_p, reflect_dir, _E_dir_reflect, _wavelength, _init_power, _power);
+      LightThread * reflect_light = _new_light(pool, in_p, reflect_dir, _E_dir_reflect, _wavelength, _init_power, _power);
 
       return std::make_pair(reflect_light, (LightThread *)0);
     }
@@ -131,11 +133,51 @@ std::pair<LightThread *, LightThread *> LightThread::interface_light_gen_linear_
     double reflect_eff = (n-1)*(n-1)/((n+1)*(n+1));
     double refract_eff = 4*n/((n+1)*(n+1));
 
-    LightThread * reflect_light = new LightThread(in_p, -_dir, -_E_dir, _wavelength, _init_power, reflect_eff*_power);
-    LightThread * refract_light = new LightThread(in_p,  _dir,  _E_dir, _wavelength, _init_power, refract_eff*_power);
+    LightThread * reflect_light = _new_light(pool, in_p, -_dir, -_E_dir, _wavelength, _init_power, reflect_eff*_power);
+    LightThread * refract_light = _new_light(pool, in_p,  _dir,  _E_dir, _wavelength, _init_power, refract_eff*_power);
 
     return std::make_pair(reflect_light, refract_light);
   }
 
 }
 
+
+
+
+LightThread * LightThread::_new_light(LightThreadPool * pool, const Point & p, const Point & dir, const Point & E_dir,
+                                      double wavelength, double init_power, double power)
+{
+  if(pool) return pool->create(p, dir, E_dir, wavelength, init_power, power);
+  return new LightThread(p, dir, E_dir, wavelength, init_power, power);
+}
+
+
+
+LightThreadPool::~LightThreadPool()
+{
+  for(unsigned int n=0; n<_free_list.size(); ++n)
+    ::operator delete(_free_list[n]);
+  _free_list.clear();
+}
+
+
+LightThread * LightThreadPool::create(const Point & p, const Point & dir, const Point & E_dir, double wavelength, double init_power, double power)
+{
+  void * storage;
+  if(_free_list.empty())
+    storage = ::operator new(sizeof(LightThread));
+  else
+  {
+    storage = _free_list.back();
+    _free_list.pop_back();
+  }
+  return new (storage) LightThread(p, dir, E_dir, wavelength, init_power, power);
+}
+
+
+void LightThreadPool::recycle(LightThread * light)
+{
+  if(light==NULL) return;
+  light->~LightThread();
+  _free_list.push_back(light);
+}
@@ -23,6 +23,10 @@
 #include <iomanip>
 #include <numeric>
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 
 #include "sphere.h"
 #include "mesh_base.h"
@@ -33,6 +37,7 @@
 #include "light_lenses.h"
 #include "ray_tracing/light_thread.h"
 #include "ray_tracing/object_tree.h"
+#include "ray_tracing/surface_bvh.h"
 #include "ray_tracing/ray_tracing.h"
 #include "parallel.h"
 
@@ -52,9 +57,175 @@ RayTraceSolver::RayTraceSolver(SimulationSystem & system, const Parser::Card & c
     : SolverBase(system), _card(c), surface_elem_tree(0)
 {
   system.record_active_solver(this->solver_type());
+
+  int n_threads = c.get_int("threads", 1);
+  _n_threads = n_threads > 1 ? n_threads : 1;
+#ifndef HAVE_PTHREAD
+  _n_threads = 1;
+#endif
 }
 
 
+
+/**
+ * the chunks [chunk_begin, chunk_end) are taken by tracing threads one by one,
+ * each chunk has its own deposit records, so the threads never write the same memory
+ */
+struct RayTraceSolver::TraceBatch
+{
+  double lamda;
+  double power;
+  unsigned int n_rays;
+  unsigned int chunk_begin;
+  unsigned int chunk_end;
+  unsigned int next_chunk;
+  std::vector<std::vector<RayTraceSolver::EnergyDeposit> > deposits;
+
+#ifdef HAVE_PTHREAD
+  pthread_mutex_t mutex;
+#endif
+
+  /**
+   * get the next chunk to be traced, false when all the chunks are taken
+   */
+  bool take_chunk(unsigned int & chunk)
+  {
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&mutex);
+#endif
+    bool ok = next_chunk < chunk_end;
+    if(ok) chunk = next_chunk++;
+#ifdef HAVE_PTHREAD
+    pthread_mutex_unlock(&mutex);
+#endif
+    return ok;
+  }
+};
+
+
+
+#ifdef HAVE_PTHREAD
+/**
+ * the worker threads live for the whole solve, they sleep until a batch is posted,
+ * trace chunks from it, and report back when the batch is empty
+ */
+struct RayTraceSolver::TraceWorkers
+{
+  const RayTraceSolver * solver;
+  std::vector<pthread_t> threads;
+  /**
+   * light thread storage, one for each worker
+   */
+  std::vector<LightThreadPool *> pools;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t  work_posted;
+  pthread_cond_t  work_done;
+
+  /**
+   * current batch, generation is increased each time a batch is posted
+   */
+  TraceBatch * batch;
+  unsigned int generation;
+  /**
+   * number of workers still working on current batch
+   */
+  unsigned int busy;
+  bool quit;
+
+  struct Arg
+  {
+    TraceWorkers * workers;
+    LightThreadPool * pool;
+  };
+  std::vector<Arg> args;
+
+  TraceWorkers(const RayTraceSolver * s, const std::vector<LightThreadPool *> & worker_pools)
+    : solver(s), pools(worker_pools), batch(0), generation(0), busy(0), quit(false)
+  {
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&work_posted, NULL);
+    pthread_cond_init(&work_done, NULL);
+
+    args.resize(pools.size());
+    for(unsigned int t=0; t<pools.size(); ++t)
+    {
+      args[t].workers = this;
+      args[t].pool    = pools[t];
+      pthread_t thread;
+      if( pthread_create(&thread, NULL, RayTraceSolver::_thread_entry, &args[t]) == 0 )
+        threads.push_back(thread);
+    }
+  }
+
+  ~TraceWorkers()
+  {
+    pthread_mutex_lock(&mutex);
+    quit = true;
+    pthread_cond_broadcast(&work_posted);
+    pthread_mutex_unlock(&mutex);
+
+    for(unsigned int t=0; t<threads.size(); ++t)
+      pthread_join(threads[t], NULL);
+
+    pthread_cond_destroy(&work_done);
+    pthread_cond_destroy(&work_posted);
+    pthread_mutex_destroy(&mutex);
+  }
+
+  /**
+   * hand the batch to all the workers
+   */
+  void post(TraceBatch & b)
+  {
+    pthread_mutex_lock(&mutex);
+    batch = &b;
+    generation++;
+    busy = threads.size();
+    pthread_cond_broadcast(&work_posted);
+    pthread_mutex_unlock(&mutex);
+  }
+
+  /**
+   * wait until no worker touches the batch any more
+   */
+  void wait()
+  {
+    pthread_mutex_lock(&mutex);
+    while( busy )
+      pthread_cond_wait(&work_done, &mutex);
+    batch = 0;
+    pthread_mutex_unlock(&mutex);
+  }
+
+  /**
+   * main loop of a worker
+   */
+  void run(LightThreadPool & pool)
+  {
+    unsigned int seen = 0;
+    pthread_mutex_lock(&mutex);
+    while( true )
+    {
+      while( !quit && generation == seen )
+        pthread_cond_wait(&work_posted, &mutex);
+      if( quit ) break;
+      seen = generation;
+      TraceBatch * b = batch;
+      pthread_mutex_unlock(&mutex);
+
+      solver->trace_batch(*b, pool);
+
+      pthread_mutex_lock(&mutex);
+      if( --busy == 0 )
+        pthread_cond_signal(&work_done);
+    }
+    pthread_mutex_unlock(&mutex);
+  }
+};
+#endif
+
+
 int RayTraceSolver::create_solver()
 {
   MESSAGE<< '\n' << "Ray tracing Solver init... ";
@@ -73,6 +244,7 @@ int RayTraceSolver::create_solver()
   // parse input deck
   define_lenses();
   create_rays();
+  build_region_surface_bvh();
 
   MESSAGE<< _total_rays <<" rays for each wave length."<<std::endl;
   RECORD();
@@ -85,6 +257,24 @@ int RayTraceSolver::solve()
 {
   START_LOG("solve()", "RayTraceSolver");
 
+  // light thread storage of each tracing thread
+  std::vector<LightThreadPool *> pools;
+  for(unsigned int t=0; t<_n_threads; ++t)
+    pools.push_back(new LightThreadPool);
+
+#ifdef HAVE_PTHREAD
+  // the other threads are started once and kept for all the batches and wave lengths
+  TraceWorkers * workers = 0;
+  if( _n_threads > 1 )
+    workers = new TraceWorkers(this, std::vector<LightThreadPool *>(pools.begin()+1, pools.end()));
+#endif
+
+  // the energy deposit of all the wave lengths are accumulated in elem,
+  // and only be reduced once after the whole spectrum is traced
+  _optical_gen_in_elem.assign(_system.mesh().n_elem(), 0.0);
+  _optical_heat_in_elem.assign(_system.mesh().n_elem(), 0.0);
+  _total_absorption_energy_in_elem.assign(_system.mesh().n_elem(), 0.0);
+
   // for each wavelentgh
   for(unsigned int n=0; n<_optical_sources.size(); ++n)
   {
@@ -94,36 +284,45 @@ int RayTraceSolver::solve()
 
     build_region_refractive_index(lamda);
 
-    // clear and re-create the array to record energy deposition
-    _band_absorption_energy_in_elem.clear();
-    _band_absorption_energy_in_elem.resize(_system.mesh().n_elem(), 0.0);
-
-    _total_absorption_energy_in_elem.clear();
-    _total_absorption_energy_in_elem.resize(_system.mesh().n_elem(), 0.0);
-
     MESSAGE<< "  process light of " /*<< std::setiosflags(std::ios::fixed)*/  << lamda/um << " um";
     RECORD();
 
-    //process all the rays
-    unsigned int n_on_processor_rays = _wave_plane.n_on_processor_rays();
-    for(unsigned int k=0; k<n_on_processor_rays; ++k)
+    //process all the rays, chunk by chunk. a batch holds several chunks for each thread,
+    //after the batch is traced, the deposit records are added in chunk order
+    const unsigned int n_on_processor_rays = _wave_plane.n_on_processor_rays();
+    const unsigned int n_chunks = (n_on_processor_rays + _rays_per_chunk - 1)/_rays_per_chunk;
+    const unsigned int chunks_per_batch = 16*_n_threads;
+    unsigned int dots = 0;
+    for(unsigned int c=0; c<n_chunks; c+=chunks_per_batch)
     {
-      // create ray
-      LightThread * light = new  LightThread(_wave_plane.ray_start_point(k),
-                                             _wave_plane.norm,
-                                             _wave_plane.E_dir,
-                                             lamda,
-                                             power,
-                                             power
-                                            );
+      TraceBatch batch;
+      batch.lamda       = lamda;
+      batch.power       = power;
+      batch.n_rays      = n_on_processor_rays;
+      batch.chunk_begin = c;
+      batch.chunk_end   = c + chunks_per_batch < n_chunks ? c + chunks_per_batch : n_chunks;
+      batch.next_chunk  = c;
+      batch.deposits.resize(batch.chunk_end - batch.chunk_begin);
+
+#ifdef HAVE_PTHREAD
+      pthread_mutex_init(&batch.mutex, NULL);
+      // this thread also takes part in tracing
+      if(workers) workers->post(batch);
+#endif
 
-      if(!_lenses->empty())  light = (*_lenses) << light;
+      trace_batch(batch, *pools[0]);
 
-      // call function ray_tracing to process a single ray
-      ray_tracing(light);
+#ifdef HAVE_PTHREAD
+      if(workers) workers->wait();
+      pthread_mutex_destroy(&batch.mutex);
+#endif
+
+      // add the deposit records in ray order
+      accumulate_deposits(n, batch.deposits);
 
       //indicator
-      if(k%(n_on_processor_rays/20)==0)
+      unsigned int traced = batch.chunk_end*_rays_per_chunk < n_on_processor_rays ? batch.chunk_end*_rays_per_chunk : n_on_processor_rays;
+      for(; dots < 20*traced/n_on_processor_rays; ++dots)
       {
         MESSAGE<< ".";
         RECORD();
@@ -133,20 +332,26 @@ int RayTraceSolver::solve()
 #endif
     }
 
-    // gather energy deposit from all the processors
-    Parallel::sum(_band_absorption_energy_in_elem);
-    Parallel::sum(_total_absorption_energy_in_elem);
-
-    // convert energy deposit to carrier optical generation
-    optical_generation(n);
-
     MESSAGE<< "ok" <<std::endl;
     RECORD();
   }
+
+#ifdef HAVE_PTHREAD
+  delete workers;
+#endif
+
+  // collect energy deposit of local elems from all the processors
+  exchange_energy_deposit();
+
+  // convert energy deposit to carrier optical generation
+  optical_generation();
 #if defined(HAVE_FENV_H) && defined(DEBUG)
   genius_assert( !fetestexcept(FE_INVALID) );
 #endif
 
+  for(unsigned int t=0; t<pools.size(); ++t)
+    delete pools[t];
+
   STOP_LOG("solve()", "RayTraceSolver");
 
   return 0;
@@ -157,6 +362,10 @@ int RayTraceSolver::destroy_solver()
 {
   delete surface_elem_tree;
 
+  for(unsigned int n=0; n<_region_surface_bvh.size(); ++n)
+    delete _region_surface_bvh[n];
+  _region_surface_bvh.clear();
+
   {
     std::map<const Elem *, std::vector<const Elem *>,  lt_edge>::iterator it = _elems_shared_this_edge.begin();
     for(; it!=_elems_shared_this_edge.end(); ++it)
@@ -494,6 +703,14 @@ void RayTraceSolver::build_region_refractive_index(double lamda)
 
   // set env refractive index
   _region_refractive_index[invalid_uint] = std::make_pair(1.0, 0.0);
+
+  // no band absorption and free carrier absorption
+  _region_transparent.assign(_system.n_regions(), false);
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    if( _system.region(n)->type() == SemiconductorRegion ) continue;
+    _region_transparent[n] = _region_refractive_index[n].second <= 0.0;
+  }
 }
 
 
@@ -626,6 +843,36 @@ void RayTraceSolver::build_boundary_elems_map()
 
 
 
+void RayTraceSolver::build_region_surface_bvh()
+{
+  const MeshBase &mesh = _system.mesh();
+
+  std::vector<std::vector<std::pair<const Elem *, unsigned int> > > region_faces(_system.n_regions());
+
+  MeshBase::const_element_iterator       el  = mesh.elements_begin();
+  const MeshBase::const_element_iterator el_end = mesh.elements_end();
+  for (; el != el_end; ++el)
+  {
+    const Elem * elem = *el;
+    if( _system.region(elem->subdomain_id())->type() == SemiconductorRegion ) continue;
+
+    for(unsigned int s=0; s<elem->n_sides(); ++s)
+    {
+      const Elem * neighbor = elem->neighbor(s);
+      if( neighbor && neighbor->subdomain_id() == elem->subdomain_id() ) continue;
+      region_faces[elem->subdomain_id()].push_back(std::make_pair(elem, s));
+    }
+  }
+
+  _region_surface_bvh.assign(_system.n_regions(), static_cast<SurfaceBVH *>(0));
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    if( region_faces[n].empty() ) continue;
+    _region_surface_bvh[n] = new SurfaceBVH(region_faces[n], _dim);
+  }
+}
+
+
 bool RayTraceSolver::is_full_reflect_surface(const Elem *elem, unsigned int side) const
 {
   if(_full_reflect_surface.find(elem)==_full_reflect_surface.end()) return false;
@@ -710,7 +957,84 @@ const Elem * RayTraceSolver::ray_hit(const Point &p, const Point &dir, const Ele
 
 
 
-void RayTraceSolver::ray_tracing(LightThread *ray)
+void RayTraceSolver::jump_to_region_surface(LightThread * ray) const
+{
+  if( ray->result.state != Intersect_Body || ray->result.hit_points.size() != 2 ) return;
+
+  const Elem * elem = ray->hit_elem;
+  const SurfaceBVH * bvh = _region_surface_bvh[elem->subdomain_id()];
+  if( bvh == NULL ) return;
+
+  // the region surface can not be crossed before the ray leaves current elem,
+  // search from the middle of current elem to skip the surface the ray enters from
+  const Point & p = ray->start_point();
+  const double t_in  = ray->result.hit_points[0].t;
+  const double t_out = ray->result.hit_points[1].t;
+
+  const Elem * surface_elem;
+  unsigned int side;
+  double t;
+  if( !bvh->hit(p, ray->dir(), 0.5*(t_in+t_out), surface_elem, side, t) ) return;
+  if( surface_elem == elem || t <= t_out ) return;
+
+  IntersectionResult result;
+  surface_elem->ray_hit(p, ray->dir(), result, _dim);
+  if( result.state != Intersect_Body || result.hit_points.size() != 2 ) return;
+
+  // the ray should go out of surface_elem at the surface we found
+  if( std::abs(result.hit_points[1].t - t) > 1e-6*t ) return;
+
+  ray->hit_elem = surface_elem;
+  ray->result   = result;
+}
+
+
+void * RayTraceSolver::_thread_entry(void * arg)
+{
+#ifdef HAVE_PTHREAD
+  TraceWorkers::Arg * worker = static_cast<TraceWorkers::Arg *>(arg);
+  worker->workers->run(*worker->pool);
+#endif
+  return NULL;
+}
+
+
+void RayTraceSolver::trace_batch(TraceBatch & batch, LightThreadPool & pool) const
+{
+  unsigned int chunk;
+  while( batch.take_chunk(chunk) )
+  {
+    unsigned int begin = chunk*_rays_per_chunk;
+    unsigned int end   = begin + _rays_per_chunk < batch.n_rays ? begin + _rays_per_chunk : batch.n_rays;
+    trace_rays(begin, end, batch.lamda, batch.power, pool, batch.deposits[chunk - batch.chunk_begin]);
+  }
+}
+
+
+void RayTraceSolver::trace_rays(unsigned int begin, unsigned int end, double lamda, double power,
+                                LightThreadPool & pool, std::vector<EnergyDeposit> & deposits) const
+{
+  for(unsigned int k=begin; k<end; ++k)
+  {
+    // create ray
+    LightThread * light = pool.create(_wave_plane.ray_start_point(k),
+                                      _wave_plane.norm,
+                                      _wave_plane.E_dir,
+                                      lamda,
+                                      power,
+                                      power
+                                     );
+
+    if(!_lenses->empty())  light = (*_lenses) << light;
+
+    // call function ray_tracing to process a single ray
+    ray_tracing(light, pool, deposits);
+  }
+}
+
+
+
+void RayTraceSolver::ray_tracing(LightThread *ray, LightThreadPool & pool, std::vector<EnergyDeposit> & deposits) const
 {
 
   // use stack to save all the rays (origin and secondary)
@@ -730,7 +1054,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
       // find the first element this ray hit
       const Elem * elem = surface_elem_tree->hit(current_ray);
       if(elem==NULL)
-      {delete current_ray; continue;}
+      {pool.recycle(current_ray); continue;}
       else
         current_ray->hit_elem = elem;
 
@@ -748,14 +1072,14 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
           {
             // if reflect surface
             if(is_full_reflect_surface(elem, hit_point.mark))
-            {  delete current_ray; continue; }
+            {  pool.recycle(current_ray); continue; }
 
             Point p = hit_point.p;
             Point norm = elem->outside_unit_normal(hit_point.mark);
             double n1 = get_refractive_index_re(elem->subdomain_id(hit_point.mark));
             double n2 = get_refractive_index_re(elem->subdomain_id());
             //generate reflect/refract rays
-            std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2);
+            std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2, &pool);
 
             // for refract ray
             LightThread *refract_ray = ray_pair.second;
@@ -779,10 +1103,10 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
                 if(reflect_ray->hit_elem)
                   ray_stack.push(reflect_ray);
                 else
-                  delete reflect_ray;
+                  pool.recycle(reflect_ray);
               }
               else
-                delete reflect_ray;
+                pool.recycle(reflect_ray);
             }
           }
           break;
@@ -817,7 +1141,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
               double n1 = get_refractive_index_re(boundary_elem->subdomain_id(side));
               double n2 = get_refractive_index_re(boundary_elem->subdomain_id());
               //generate reflect/refract rays
-              std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2);
+              std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2, &pool);
 
               // for refract ray
               LightThread *refract_ray = ray_pair.second;
@@ -827,7 +1151,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
                 if(refract_ray->hit_elem)
                   ray_stack.push(refract_ray);
                 else
-                  delete refract_ray;
+                  pool.recycle(refract_ray);
               }
 
               // for reflect ray
@@ -844,10 +1168,10 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
                   if(reflect_ray->hit_elem)
                     ray_stack.push(reflect_ray);
                   else
-                    delete reflect_ray;
+                    pool.recycle(reflect_ray);
                 }
                 else
-                  delete reflect_ray;
+                  pool.recycle(reflect_ray);
               }
             }
             break;
@@ -889,7 +1213,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
               double n1 = get_refractive_index_re(boundary_elem->subdomain_id(side));
               double n2 = get_refractive_index_re(boundary_elem->subdomain_id());
               //generate reflect/refract rays
-              std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2);
+              std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2, &pool);
 
               // for refract ray
               LightThread *refract_ray = ray_pair.second;
@@ -899,7 +1223,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
                 if(refract_ray->hit_elem)
                   ray_stack.push(refract_ray);
                 else
-                  delete refract_ray;
+                  pool.recycle(refract_ray);
               }
 
               // for reflect ray
@@ -916,10 +1240,10 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
                   if(reflect_ray->hit_elem)
                     ray_stack.push(reflect_ray);
                   else
-                    delete reflect_ray;
+                    pool.recycle(reflect_ray);
                 }
                 else
-                  delete reflect_ray;
+                  pool.recycle(reflect_ray);
               }
             }
             break;
@@ -928,7 +1252,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
           default: genius_error();
       }
 
-      delete current_ray;
+      pool.recycle(current_ray);
       continue;
     }
 
@@ -938,10 +1262,14 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
     if( current_ray->result.hit_points.size() != 2 )
     {
       // FIXME, should not happen...
-      delete current_ray;
+      pool.recycle(current_ray);
       continue;
     }
 
+    // the ray goes across transparent region directly
+    if( _region_transparent[current_ray->hit_elem->subdomain_id()] )
+      jump_to_region_surface(current_ray);
+
     // calculate energy deposit
     const Elem * elem = current_ray->hit_elem;
     Hit_Point  end_point = current_ray->result.hit_points[1];
@@ -958,20 +1286,17 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
     {
         // all the energy deposited in this elem
         case Intersect_Body :
-          _band_absorption_energy_in_elem[elem->id()] += energy_deposit[0];
-          _total_absorption_energy_in_elem[elem->id()] += total_energy_deposit;
+          deposit(deposits, elem->id(), energy_deposit[0], total_energy_deposit);
         break;
         // two elem shares the energy deposite
         case On_Face        :
         {
-          _band_absorption_energy_in_elem[elem->id()] += 0.5*energy_deposit[0];
-          _total_absorption_energy_in_elem[elem->id()] += 0.5*total_energy_deposit;
+          deposit(deposits, elem->id(), 0.5*energy_deposit[0], 0.5*total_energy_deposit);
           unsigned int side = current_ray->result.mark;
           const Elem * neighbor = elem->neighbor(side);
           if(neighbor)
           {
-            _band_absorption_energy_in_elem[neighbor->id()] += 0.5*energy_deposit[0];
-            _total_absorption_energy_in_elem[neighbor->id()] += 0.5*total_energy_deposit;
+            deposit(deposits, neighbor->id(), 0.5*energy_deposit[0], 0.5*total_energy_deposit);
           }
           break;
         }
@@ -984,8 +1309,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
           assert(elems.size());
           for(unsigned int n=0; n<elems.size(); ++n)
           {
-            _band_absorption_energy_in_elem[elems[n]->id()] += energy_deposit[0]/elems.size();
-            _total_absorption_energy_in_elem[elems[n]->id()] += total_energy_deposit/elems.size();
+            deposit(deposits, elems[n]->id(), energy_deposit[0]/elems.size(), total_energy_deposit/elems.size());
           }
           break;
         }
@@ -995,7 +1319,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
 
 
     if(current_ray->is_dead())
-    { delete current_ray; continue; }
+    { pool.recycle(current_ray); continue; }
 
     // safe guard: when the number of rays in stack exceed 1000, we may fall into endless loop
     // force to exit
@@ -1005,7 +1329,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
       {
         LightThread * current_ray = ray_stack.top();
         ray_stack.pop();
-        delete current_ray;
+        pool.recycle(current_ray);
       }
       return;
     }
@@ -1030,14 +1354,14 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
           {
             // if reflect surface
             if(is_full_reflect_surface(elem, side))
-            {  delete current_ray; continue; }
+            {  pool.recycle(current_ray); continue; }
 
             Point p = end_point.p;
             Point norm = - elem->outside_unit_normal(side);
             double n1 = get_refractive_index_re(elem->subdomain_id());
             double n2 = get_refractive_index_re(elem->subdomain_id(side));
             //generate reflect/refract rays
-            std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2);
+            std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2, &pool);
 
             // for refract ray
             LightThread *refract_ray = ray_pair.second;
@@ -1060,7 +1384,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
               assert(reflect_ray->result.state!=Missed);
               ray_stack.push(reflect_ray);
             }
-            delete current_ray;
+            pool.recycle(current_ray);
           }
         }
         break;
@@ -1115,7 +1439,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
               double n1 = get_refractive_index_re(boundary_elem->subdomain_id(side));
               double n2 = get_refractive_index_re(boundary_elem->subdomain_id());
               //generate reflect/refract rays
-              std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2);
+              std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2, &pool);
 
               // for refract ray
               LightThread *refract_ray = ray_pair.second;
@@ -1125,7 +1449,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
                 if(refract_ray->hit_elem)
                   ray_stack.push(refract_ray);
                 else
-                  delete refract_ray;
+                  pool.recycle(refract_ray);
               }
 
               // for reflect ray
@@ -1136,11 +1460,11 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
               if(reflect_ray->hit_elem)
                 ray_stack.push(reflect_ray);
               else
-                delete reflect_ray;
+                pool.recycle(reflect_ray);
               }
             }
 
-            delete current_ray;
+            pool.recycle(current_ray);
           }
         }
         break;
@@ -1148,7 +1472,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
         {
           unsigned int vertex_index = end_point.mark;
           const Node * node = elem->get_node(vertex_index);
-          std::vector<const Elem *> & elems = _elems_shared_this_node[node->id()];
+          const std::vector<const Elem *> & elems = _elems_shared_this_node[node->id()];
           // the node is not on boundary
           if( _boundary_node_to_elem_side_map.find(node)==_boundary_node_to_elem_side_map.end())
           {
@@ -1191,7 +1515,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
               double n1 = get_refractive_index_re(boundary_elem->subdomain_id(side));
               double n2 = get_refractive_index_re(boundary_elem->subdomain_id());
               //generate reflect/refract rays
-              std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2);
+              std::pair<LightThread *, LightThread *> ray_pair = current_ray->interface_light_gen_linear_polarized(p, norm, n1, n2, &pool);
 
               // for refract ray
               LightThread *refract_ray = ray_pair.second;
@@ -1201,7 +1525,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
                 if(refract_ray->hit_elem)
                   ray_stack.push(refract_ray);
                 else
-                  delete refract_ray;
+                  pool.recycle(refract_ray);
               }
 
               // for reflect ray
@@ -1212,10 +1536,10 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
               if(reflect_ray->hit_elem)
                 ray_stack.push(reflect_ray);
               else
-                delete reflect_ray;
+                pool.recycle(reflect_ray);
               }
             }
-            delete current_ray;
+            pool.recycle(current_ray);
           }
         }
         break;
@@ -1228,65 +1552,150 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
 
 
 
-void RayTraceSolver::optical_generation(unsigned int n)
+void RayTraceSolver::accumulate_deposits(unsigned int n, const std::vector<std::vector<EnergyDeposit> > & deposits)
 {
   const MeshBase &mesh = _system.mesh();
 
   double c = 1.0/sqrt(eps0*mu0);
   double lamda    = _optical_sources[n].wave_length;
-  double quan_eff = _optical_sources[n].eta;
+  double E_photon = h*c/lamda;
 
-  for (unsigned int i=0; i<_band_absorption_energy_in_elem.size(); i++)
+  // generation per absorbed energy and band gap of each semiconductor region
+  std::vector<double> region_gen_factor(_system.n_regions(), 0.0);
+  std::vector<double> region_Eg(_system.n_regions(), 0.0);
+  for(unsigned int r=0; r<_system.n_regions(); ++r)
   {
-    const Elem * elem = mesh.elem(i);
-    if(!elem->on_local()) continue; //skip nonlocal elements
+    SimulationRegion* region = _system.region(r);
+    // only semiconductor region generating carriers
+    if(region->type() != SemiconductorRegion) continue;
 
-    SimulationRegion* elem_region = _system.region(elem->subdomain_id());
+    double Eg = region->get_optical_Eg(region->T_external());
+    double quan_eff = _optical_sources[n].eta;
+    if(_optical_sources[n].eta_auto)
+    {
+      // calculate optical gen quantum efficiency
+      quan_eff = floor(E_photon/Eg);
+    }
+    region_gen_factor[r] = quan_eff/E_photon;
+    region_Eg[r] = Eg;
+  }
 
-    // only semiconductor region generating carriers
-    if(elem_region->type() == SemiconductorRegion)
+  for(unsigned int k=0; k<deposits.size(); ++k)
+    for(unsigned int i=0; i<deposits[k].size(); ++i)
     {
-      double Eg = elem_region->get_optical_Eg(elem_region->T_external());
-      double E_photon = h*c/lamda;
-      if(_optical_sources[n].eta_auto)
-      {
-        // calculate optical gen quantum efficiency
-        quan_eff = floor(E_photon/Eg);
-      }
+      const EnergyDeposit & d = deposits[k][i];
+      _total_absorption_energy_in_elem[d.elem] += d.total;
 
-      double gen = _band_absorption_energy_in_elem[i]/E_photon*quan_eff;
-      double heat = _band_absorption_energy_in_elem[i] - Eg*gen;
+      unsigned int r = mesh.elem(d.elem)->subdomain_id();
+      if(region_gen_factor[r] == 0.0) continue;
 
-      double volumn = 0;
-      for(unsigned int nd=0; nd<elem->n_nodes(); nd++)
-      {
-        volumn += elem->partial_volume_truncated(nd);
-      }
+      double gen = d.band*region_gen_factor[r];
+      _optical_gen_in_elem[d.elem]  += gen;
+      _optical_heat_in_elem[d.elem] += d.band - region_Eg[r]*gen;
+    }
+}
 
-      for(unsigned int nd=0; nd<elem->n_nodes(); nd++)
-      {
-        const Node* node = elem->get_node(nd);
-        double vol_ratio = elem->partial_volume_truncated(nd)/(volumn+1e-10);
 
-        FVM_Node* fvm_node = elem_region->region_fvm_node(node);
-        assert(fvm_node->node_data());
+void RayTraceSolver::exchange_energy_deposit()
+{
+  if(Genius::n_processors() == 1) return;
+
+  START_LOG("exchange_energy_deposit()", "RayTraceSolver");
 
-        fvm_node->node_data()->OptG() += gen*vol_ratio/fvm_node->volume();
-        fvm_node->node_data()->OptQ() += heat*vol_ratio/fvm_node->volume();
-      }
+  const MeshBase &mesh = _system.mesh();
+
+  // record: elem id, generation, heat, total energy
+  std::vector<std::vector<double> > send(Genius::n_processors()), recv;
+
+  // the deposit to elems of other processors
+  MeshBase::const_element_iterator       el  = mesh.elements_begin();
+  const MeshBase::const_element_iterator el_end = mesh.elements_end();
+  for (; el != el_end; ++el)
+  {
+    const Elem * elem = *el;
+    if( elem->on_processor() ) continue;
+
+    const unsigned int i = elem->id();
+    if( _optical_gen_in_elem[i]==0.0 && _optical_heat_in_elem[i]==0.0 && _total_absorption_energy_in_elem[i]==0.0 ) continue;
+
+    std::vector<double> & buffer = send[elem->processor_id()];
+    buffer.push_back(i);
+    buffer.push_back(_optical_gen_in_elem[i]);
+    buffer.push_back(_optical_heat_in_elem[i]);
+    buffer.push_back(_total_absorption_energy_in_elem[i]);
+
+    _optical_gen_in_elem[i] = 0.0;
+    _optical_heat_in_elem[i] = 0.0;
+    _total_absorption_energy_in_elem[i] = 0.0;
+  }
+
+  Parallel::alltoall(send, recv);
+
+  // owner adds them up, in processor order
+  for(unsigned int p=0; p<recv.size(); ++p)
+    for(unsigned int k=0; k<recv[p].size(); k+=4)
+    {
+      const unsigned int i = static_cast<unsigned int>(recv[p][k]);
+      _optical_gen_in_elem[i]             += recv[p][k+1];
+      _optical_heat_in_elem[i]            += recv[p][k+2];
+      _total_absorption_energy_in_elem[i] += recv[p][k+3];
     }
+
+  // ask the owners for ghost elems
+  std::vector<std::vector<unsigned int> > ghost_elems(Genius::n_processors()), required_elems;
+  for (el = mesh.elements_begin(); el != el_end; ++el)
+  {
+    const Elem * elem = *el;
+    if( elem->is_ghost() )
+      ghost_elems[elem->processor_id()].push_back(elem->id());
   }
 
+  Parallel::alltoall(ghost_elems, required_elems);
+
+  for(unsigned int p=0; p<required_elems.size(); ++p)
+  {
+    send[p].clear();
+    for(unsigned int k=0; k<required_elems[p].size(); ++k)
+    {
+      const unsigned int i = required_elems[p][k];
+      if( _optical_gen_in_elem[i]==0.0 && _optical_heat_in_elem[i]==0.0 && _total_absorption_energy_in_elem[i]==0.0 ) continue;
+      send[p].push_back(i);
+      send[p].push_back(_optical_gen_in_elem[i]);
+      send[p].push_back(_optical_heat_in_elem[i]);
+      send[p].push_back(_total_absorption_energy_in_elem[i]);
+    }
+  }
+
+  Parallel::alltoall(send, recv);
+
+  for(unsigned int p=0; p<recv.size(); ++p)
+    for(unsigned int k=0; k<recv[p].size(); k+=4)
+    {
+      const unsigned int i = static_cast<unsigned int>(recv[p][k]);
+      _optical_gen_in_elem[i]             = recv[p][k+1];
+      _optical_heat_in_elem[i]            = recv[p][k+2];
+      _total_absorption_energy_in_elem[i] = recv[p][k+3];
+    }
+
+  STOP_LOG("exchange_energy_deposit()", "RayTraceSolver");
+}
+
+
+void RayTraceSolver::optical_generation()
+{
+  const MeshBase &mesh = _system.mesh();
 
   for (unsigned int i=0; i<_total_absorption_energy_in_elem.size(); i++)
   {
     const Elem * elem = mesh.elem(i);
     if(!elem->on_local()) continue; //skip nonlocal elements
 
-    SimulationRegion* elem_region = _system.region(elem->subdomain_id());
-
+    double gen    = _optical_gen_in_elem[i];
+    double heat   = _optical_heat_in_elem[i];
     double energy = _total_absorption_energy_in_elem[i];
-    if(energy==0.0) continue;
+    if(gen==0.0 && heat==0.0 && energy==0.0) continue;
+
+    SimulationRegion* elem_region = _system.region(elem->subdomain_id());
 
     double volumn = 0;
     for(unsigned int nd=0; nd<elem->n_nodes(); nd++)
@@ -1302,6 +1711,12 @@ void RayTraceSolver::optical_generation(unsigned int n)
       FVM_Node* fvm_node = elem_region->region_fvm_node(node);
       assert(fvm_node->node_data());
 
+      // only semiconductor region generating carriers
+      if(elem_region->type() == SemiconductorRegion)
+      {
+        fvm_node->node_data()->OptG() += gen*vol_ratio/fvm_node->volume();
+        fvm_node->node_data()->OptQ() += heat*vol_ratio/fvm_node->volume();
+      }
       fvm_node->node_data()->OptE() += energy*vol_ratio/fvm_node->volume();
     }
   }
@@ -0,0 +1,358 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+
+#include <cmath>
+#include <algorithm>
+
+#include "elem.h"
+#include "ray_tracing/surface_bvh.h"
+
+
+namespace
+{
+  // binned SAH
+  const unsigned int n_bins = 16;
+
+  struct Bin
+  {
+    Point lower;
+    Point upper;
+    unsigned int count;
+  };
+
+  void box_reset(Point & lower, Point & upper)
+  {
+    lower = Point( 1e30,  1e30,  1e30);
+    upper = Point(-1e30, -1e30, -1e30);
+  }
+
+  void box_expand(Point & lower, Point & upper, const Point & p)
+  {
+    for(unsigned int i=0; i<3; ++i)
+    {
+      lower(i) = std::min(lower(i), p(i));
+      upper(i) = std::max(upper(i), p(i));
+    }
+  }
+
+  // the bin a centroid belongs to
+  struct BinOf
+  {
+    unsigned int axis;
+    double lower;
+    double scale;
+    unsigned int operator()(const Point & c) const
+    {
+      unsigned int b = static_cast<unsigned int>((c(axis) - lower)*scale);
+      return std::min(b, n_bins-1);
+    }
+  };
+}
+
+
+
+SurfaceBVH::SurfaceBVH(const std::vector<std::pair<const Elem *, unsigned int> > & faces, unsigned int dim)
+    : _dim(dim)
+{
+  _faces.resize(faces.size());
+  for(unsigned int n=0; n<faces.size(); ++n)
+  {
+    Face & face = _faces[n];
+    face.elem = faces[n].first;
+    face.side = faces[n].second;
+
+    AutoPtr<Elem> side = face.elem->build_side(face.side, false);
+    face.n_points = std::min(side->n_vertices(), 4u);
+
+    box_reset(face.lower, face.upper);
+    face.centroid = Point(0, 0, 0);
+    for(unsigned int i=0; i<face.n_points; ++i)
+    {
+      face.points[i] = side->point(i);
+      box_expand(face.lower, face.upper, face.points[i]);
+      face.centroid += face.points[i]/face.n_points;
+    }
+  }
+
+  if(!_faces.empty())
+    _build(0, _faces.size());
+}
+
+
+double SurfaceBVH::_box_area(const Point & lower, const Point & upper) const
+{
+  Point l = upper - lower;
+  if(_dim == 2) return l(0) + l(1);
+  return l(0)*l(1) + l(1)*l(2) + l(2)*l(0);
+}
+
+
+unsigned int SurfaceBVH::_build(unsigned int begin, unsigned int end)
+{
+  const unsigned int index = _nodes.size();
+  _nodes.push_back(Node());
+
+  Point lower, upper, c_lower, c_upper;
+  box_reset(lower, upper);
+  box_reset(c_lower, c_upper);
+  for(unsigned int n=begin; n<end; ++n)
+  {
+    box_expand(lower, upper, _faces[n].lower);
+    box_expand(lower, upper, _faces[n].upper);
+    box_expand(c_lower, c_upper, _faces[n].centroid);
+  }
+  // pad the box a bit, axis aligned sides should not be missed
+  Point pad = 1e-9*(upper - lower) + Point(1e-30, 1e-30, 1e-30);
+  _nodes[index].lower = lower - pad;
+  _nodes[index].upper = upper + pad;
+  _nodes[index].offset = begin;
+  _nodes[index].count  = end - begin;
+
+  if(end - begin <= _leaf_size) return index;
+
+  // split along the longest axis of centroid box
+  unsigned int axis = 0;
+  Point extent = c_upper - c_lower;
+  for(unsigned int i=1; i<3; ++i)
+    if(extent(i) > extent(axis)) axis = i;
+  // all the centroids are at the same place
+  if(extent(axis) <= 0.0) return index;
+
+  BinOf bin_of;
+  bin_of.axis  = axis;
+  bin_of.lower = c_lower(axis);
+  bin_of.scale = n_bins*(1-1e-6)/extent(axis);
+
+  Bin bins[n_bins];
+  for(unsigned int b=0; b<n_bins; ++b)
+  {
+    box_reset(bins[b].lower, bins[b].upper);
+    bins[b].count = 0;
+  }
+  for(unsigned int n=begin; n<end; ++n)
+  {
+    Bin & bin = bins[bin_of(_faces[n].centroid)];
+    box_expand(bin.lower, bin.upper, _faces[n].lower);
+    box_expand(bin.lower, bin.upper, _faces[n].upper);
+    bin.count++;
+  }
+
+  // sweep from the right to get the cost of right part
+  double right_cost[n_bins];
+  {
+    Point l, u;
+    box_reset(l, u);
+    unsigned int count = 0;
+    for(unsigned int b=n_bins-1; b>0; --b)
+    {
+      if(bins[b].count)
+      {
+        box_expand(l, u, bins[b].lower);
+        box_expand(l, u, bins[b].upper);
+      }
+      count += bins[b].count;
+      right_cost[b] = count ? count*_box_area(l, u) : 0.0;
+    }
+  }
+
+  // sweep from the left, split between bin b-1 and b
+  unsigned int best_split = 0;
+  double best_cost = 1e300;
+  {
+    Point l, u;
+    box_reset(l, u);
+    unsigned int count = 0;
+    for(unsigned int b=1; b<n_bins; ++b)
+    {
+      if(bins[b-1].count)
+      {
+        box_expand(l, u, bins[b-1].lower);
+        box_expand(l, u, bins[b-1].upper);
+      }
+      count += bins[b-1].count;
+      if(count == 0 || count == end - begin) continue;
+      double cost = count*_box_area(l, u) + right_cost[b];
+      if(cost < best_cost)
+      {
+        best_cost  = cost;
+        best_split = b;
+      }
+    }
+  }
+
+  unsigned int mid;
+  if(best_split)
+  {
+    // partition the faces by bin
+    unsigned int i = begin, j = end;
+    while(i < j)
+    {
+      if(bin_of(_faces[i].centroid) < best_split) ++i;
+      else std::swap(_faces[i], _faces[--j]);
+    }
+    mid = i;
+  }
+  else
+  {
+    // can not separate by bins, split at median
+    mid = (begin + end)/2;
+    for(unsigned int n=begin; n<end; ++n)
+      for(unsigned int m=n+1; m<end; ++m)
+        if(_faces[m].centroid(axis) < _faces[n].centroid(axis)) std::swap(_faces[n], _faces[m]);
+  }
+
+  _build(begin, mid);
+  unsigned int right = _build(mid, end);
+
+  _nodes[index].offset = right;
+  _nodes[index].count  = 0;
+
+  return index;
+}
+
+
+bool SurfaceBVH::_hit_box(const Node & node, const Point & p, const Point & d, double t_min, double t_max, double & t_near) const
+{
+  for(unsigned int i=0; i<3; ++i)
+  {
+    if(std::abs(d(i)) < 1e-30)
+    {
+      if(p(i) < node.lower(i) || p(i) > node.upper(i)) return false;
+      continue;
+    }
+    double t1 = (node.lower(i) - p(i))/d(i);
+    double t2 = (node.upper(i) - p(i))/d(i);
+    if(t1 > t2) std::swap(t1, t2);
+    t_min = std::max(t_min, t1);
+    t_max = std::min(t_max, t2);
+    if(t_min > t_max) return false;
+  }
+  t_near = t_min;
+  return true;
+}
+
+
+bool SurfaceBVH::_hit_triangle(const Point & a, const Point & b, const Point & c, const Point & p, const Point & d, double & t)
+{
+  Point e1 = b - a;
+  Point e2 = c - a;
+  Point h = d.cross(e2);
+  double det = e1.dot(h);
+  if(std::abs(det) < 1e-30) return false;
+
+  double f = 1.0/det;
+  Point s = p - a;
+  double u = f*s.dot(h);
+  if(u < -1e-10 || u > 1.0+1e-10) return false;
+
+  Point q = s.cross(e1);
+  double v = f*d.dot(q);
+  if(v < -1e-10 || u + v > 1.0+1e-10) return false;
+
+  t = f*e2.dot(q);
+  return true;
+}
+
+
+bool SurfaceBVH::_hit_face(const Face & face, const Point & p, const Point & d, double t_min, double & t) const
+{
+  if(_dim == 2 || face.n_points == 2)
+  {
+    // segment in xy plane
+    const Point & a = face.points[0];
+    Point e = face.points[1] - a;
+    double denom = d(0)*e(1) - d(1)*e(0);
+    // parallel, the tangent ray is left to the elem walk
+    if(std::abs(denom) < 1e-30) return false;
+
+    Point ap = a - p;
+    double s = (ap(0)*d(1) - ap(1)*d(0))/denom;
+    if(s < -1e-10 || s > 1.0+1e-10) return false;
+
+    t = (ap(0)*e(1) - ap(1)*e(0))/denom;
+    return t > t_min;
+  }
+
+  double t1;
+  bool hit = false;
+  t = 1e300;
+  if(_hit_triangle(face.points[0], face.points[1], face.points[2], p, d, t1) && t1 > t_min)
+  { t = t1; hit = true; }
+  if(face.n_points == 4 && _hit_triangle(face.points[0], face.points[2], face.points[3], p, d, t1) && t1 > t_min && t1 < t)
+  { t = t1; hit = true; }
+  return hit;
+}
+
+
+bool SurfaceBVH::hit(const Point & p, const Point & d, double t_min, const Elem * & elem, unsigned int & side, double & t) const
+{
+  if(_nodes.empty()) return false;
+
+  double t_best = 1e300;
+  bool   found  = false;
+
+  unsigned int stack[64];
+  unsigned int top = 0;
+  stack[top++] = 0;
+
+  while(top)
+  {
+    const Node & node = _nodes[stack[--top]];
+    double t_near;
+    if(!_hit_box(node, p, d, t_min, t_best, t_near)) continue;
+
+    if(node.count)
+    {
+      for(unsigned int n=node.offset; n<node.offset+node.count; ++n)
+      {
+        double t_face;
+        if(_hit_face(_faces[n], p, d, t_min, t_face) && t_face < t_best)
+        {
+          t_best = t_face;
+          elem   = _faces[n].elem;
+          side   = _faces[n].side;
+          found  = true;
+        }
+      }
+      continue;
+    }
+
+    // visit the nearer child first
+    unsigned int left  = &node - &_nodes[0] + 1;
+    unsigned int right = node.offset;
+    double t_left, t_right;
+    bool hit_left  = _hit_box(_nodes[left],  p, d, t_min, t_best, t_left);
+    bool hit_right = _hit_box(_nodes[right], p, d, t_min, t_best, t_right);
+    if(hit_left && hit_right)
+    {
+      genius_assert(top + 2 <= 64);
+      if(t_left < t_right) { stack[top++] = right; stack[top++] = left; }
+      else                 { stack[top++] = left;  stack[top++] = right; }
+    }
+    else if(hit_left)  stack[top++] = left;
+    else if(hit_right) stack[top++] = right;
+  }
+
+  t = t_best;
+  return found;
+}
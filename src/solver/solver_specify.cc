@@ -177,6 +177,32 @@ namespace SolverSpecify
    */
   bool     ksp_singular;
 
+  /**
+   * use Eisenstat-Walker forcing term as the relative tolerance
+   * of the linear solver (iterative solvers only)
+   */
+  bool     ksp_ew;
+
+  /**
+   * initial forcing term of Eisenstat-Walker method
+   */
+  double   ksp_ew_rtol0;
+
+  /**
+   * max forcing term of Eisenstat-Walker method
+   */
+  double   ksp_ew_rtol_max;
+
+  /**
+   * gamma parameter of Eisenstat-Walker method
+   */
+  double   ksp_ew_gamma;
+
+  /**
+   * alpha parameter of Eisenstat-Walker method
+   */
+  double   ksp_ew_alpha;
+
   //--------------------------------------------
   // nonlinear solver convergence criteria
   //--------------------------------------------
@@ -366,6 +392,16 @@ namespace SolverSpecify
    */
   int       T_Cycles;
 
+  /**
+   * the time step at clock is accepted, but clock is not advanced to the next step yet
+   */
+  bool      TimeStepDone = false;
+
+  /**
+   * time integration state is restored from checkpoint
+   */
+  bool      Resume = false;
+
 
   //------------------------------------------------------
   // parameters for DC and TRACE simulation
@@ -632,6 +668,11 @@ namespace SolverSpecify
     ksp_atol                  = 1e-15;
     ksp_atol_fnorm            = 1e-7;
     ksp_singular              = false;
+    ksp_ew                    = false;
+    ksp_ew_rtol0              = 0.3;
+    ksp_ew_rtol_max           = 0.9;
+    ksp_ew_gamma              = 0.9;
+    ksp_ew_alpha              = 2.0;
 
     absolute_toler            = 1e-12;
     relative_toler            = 1e-5;
@@ -650,14 +691,18 @@ namespace SolverSpecify
     TimeDependent             = false;
     TStepMin                  = 1e-14*s;
     TS_type                   = BDF2;
-    BDF2_LowerOrder           = true;
     UIC                       = false;
     tran_op                   = true;
     AutoStep                  = true;
     RejectStep                = true;
     Predict                   = true;
-    clock                     = 0.0;
-    dt                        = 1e100;
+    // keep the time integration state restored from checkpoint
+    if( !Resume )
+    {
+      BDF2_LowerOrder         = true;
+      clock                   = 0.0;
+      dt                      = 1e100;
+    }
 
 
     VStepMax          = 1.0;
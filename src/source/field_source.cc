@@ -166,7 +166,7 @@ void FieldSource::update(double time, bool force_update_system)
   if(!SolverSpecify::PatG && !SolverSpecify::OptG) return;
 
   if(force_update_system)
-    this->update_system();
+    this->_update_light_sources();
 
   // second order trapezoidal quadrature
   double particle_gen_waveform = 0.0;
@@ -181,7 +181,11 @@ void FieldSource::update(double time, bool force_update_system)
   if(current_waveform)
     optical_gen_waveform = 0.5*(current_waveform->waveform(time) + current_waveform->waveform(time-SolverSpecify::dt));
 
+  const double particle_factor = SolverSpecify::PatG ? particle_gen_waveform : 0.0;
+  const double optical_factor  = SolverSpecify::OptG ? optical_gen_waveform  : 0.0;
 
+  // all the sources in one pass. PatG/OptG are read from node data at each step,
+  // since solvers such as RAYTRACE and EMFEM2D write OptG directly
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
     SimulationRegion * region = _system.region(n);
@@ -191,25 +195,12 @@ void FieldSource::update(double time, bool force_update_system)
       SimulationRegion::processor_node_iterator it_end = region->on_processor_nodes_end();
       for(; it!=it_end; ++it)
       {
-        FVM_Node * fvm_node = (*it);
-        FVM_NodeData * fvm_node_data = fvm_node->node_data();
-
-        double G=0;
-
-        if(SolverSpecify::PatG)
-        {
-          G += fvm_node_data->PatG()*particle_gen_waveform;
-        }
-
-        if(SolverSpecify::OptG)
-        {
-          G += fvm_node_data->OptG()*optical_gen_waveform;
-        }
-
-        fvm_node_data->Field_G() = G;
+        FVM_NodeData * fvm_node_data = (*it)->node_data();
+        fvm_node_data->Field_G() = fvm_node_data->PatG()*particle_factor + fvm_node_data->OptG()*optical_factor;
       }
     }
   }
+
 #if defined(HAVE_FENV_H) && defined(DEBUG)
   genius_assert( !fetestexcept(FE_INVALID) );
 #endif
@@ -252,6 +243,29 @@ void FieldSource::update_system()
 }
 
 
+void FieldSource::_update_light_sources()
+{
+  if( _light_sources.empty() ) return;
+
+  // clear old optical generation
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    SimulationRegion * region = _system.region(n);
+    if( region->type()== SemiconductorRegion)
+    {
+      SimulationRegion::processor_node_iterator it = region->on_local_nodes_begin();
+      SimulationRegion::processor_node_iterator it_end = region->on_local_nodes_end();
+      for(; it!=it_end; ++it)
+        (*it)->node_data()->OptG() = 0.0;
+    }
+  }
+
+  std::vector<Light_Source *>::iterator lit = _light_sources.begin();
+  for(; lit!=_light_sources.end(); ++lit)
+    (*lit)->update_system();
+}
+
+
 
 double FieldSource::limit_dt(double time, double dt) const
 {
@@ -264,15 +264,22 @@ void Light_Source_From_File::update_system()
     Complex r = region->get_optical_refraction(_wave_length);
     Complex eps(r.real()*r.real()-r.imag()*r.imag(), -2*r.real()*r.imag()) ;
 
+    std::vector<FVM_Node *> fvm_nodes;
+    std::vector<Point> points;
     SimulationRegion::processor_node_iterator it = region->on_processor_nodes_begin();
     SimulationRegion::processor_node_iterator it_end = region->on_processor_nodes_end();
     for(; it!=it_end; ++it)
     {
-      FVM_Node * fvm_node = (*it);
-      FVM_NodeData * node_data = fvm_node->node_data();
+      fvm_nodes.push_back(*it);
+      points.push_back(*((*it)->root_node()));
+    }
 
-      double E_field = interpolator->get_interpolated_value(*(fvm_node->root_node()), 0);
-      node_data->OptG() += eta*M_PI/h*eps0*(-eps.imag())* E_field *E_field * scale;
+    std::vector<double> E_field;
+    interpolator->get_interpolated_values(points, 0, E_field);
+    for(unsigned int i=0; i<fvm_nodes.size(); ++i)
+    {
+      FVM_NodeData * node_data = fvm_nodes[i]->node_data();
+      node_data->OptG() += eta*M_PI/h*eps0*(-eps.imag())* E_field[i] *E_field[i] * scale;
     }
   }
 
@@ -30,7 +30,6 @@
 #include "interpolation_2d_csa.h"
 //#include "interpolation_3d_qshep.h"
 #include "interpolation_3d_nbtet.h"
-#include "nearest_node_locator.h"
 #include "parallel.h"
 #include "mathfunc.h"
 #include "log.h"
@@ -251,16 +250,22 @@ void Particle_Source_DataFile::update_system()
 
     if( region->type() != SemiconductorRegion ) continue;
 
+    std::vector<FVM_Node *> fvm_nodes;
+    std::vector<Point> points;
     SimulationRegion::processor_node_iterator it = region->on_processor_nodes_begin();
     SimulationRegion::processor_node_iterator it_end = region->on_processor_nodes_end();
     for(; it!=it_end; ++it)
     {
-      FVM_Node * fvm_node = (*it);
-      FVM_NodeData * node_data = fvm_node->node_data();
-
-      double E = interpolator->get_interpolated_value(*(fvm_node->root_node()), 0);
-      node_data->PatG() += 2*E/_quan_eff/_t_char/sqrt(3.1415926536)/(1+Erf((_t_max-_t0)/_t_char));
+      fvm_nodes.push_back(*it);
+      points.push_back(*((*it)->root_node()));
+    }
 
+    std::vector<double> E;
+    interpolator->get_interpolated_values(points, 0, E);
+    for(unsigned int i=0; i<fvm_nodes.size(); ++i)
+    {
+      FVM_NodeData * node_data = fvm_nodes[i]->node_data();
+      node_data->PatG() += 2*E[i]/_quan_eff/_t_char/sqrt(3.1415926536)/(1+Erf((_t_max-_t0)/_t_char));
     }
   }
 }
@@ -363,6 +368,10 @@ Particle_Source_Track::Particle_Source_Track(SimulationSystem &system, const Par
 
   _lateral_char = c.get_real("lateral.char", 0.1)*um;
 
+  // node index is built at the first update_system call
+  _bin_size = 0.0;
+  _n_bins[0] = _n_bins[1] = _n_bins[2] = 0;
+
   MESSAGE<<"ok\n"<<std::endl; RECORD();
 }
 
@@ -431,79 +440,249 @@ void Particle_Source_Track::update_system()
   const double pi = 3.1415926536;
   genius_assert(_system.mesh().mesh_dimension() == 3);
 
-  AutoPtr<NearestNodeLocator> nn_locator( new NearestNodeLocator(_system.mesh()) );
-
-  // for each track
-  for(unsigned int t=0; t<_tracks.size(); ++t)
+  // the energy deposit only depends on mesh and tracks, rebuild it when the fvm nodes changed.
+  // the decision should be made collectively since track normalization requires communication
   {
-    const track_t & track = _tracks[t];
-    // prevent bad tracks
-    if( track.energy == 0.0 ) continue;
-    if((track.end - track.start).size() == 0.0) continue;
-
-    const Point track_dir = (track.end - track.start).unit(); // track direction
-    const double ed = track.energy/(track.end - track.start).size(); // linear energy density
-    // find the nodes that near the track
-    std::multimap<const Node *, std::pair<FVM_Node *, double> > impacted_fvm_nodes;
+    std::vector<FVM_Node *> fvm_nodes;
     for(unsigned int r=0; r<_system.n_regions(); r++)
     {
-      const SimulationRegion * region = _system.region(r);
+      SimulationRegion * region = _system.region(r);
+      SimulationRegion::processor_node_iterator it = region->on_processor_nodes_begin();
+      SimulationRegion::processor_node_iterator it_end = region->on_processor_nodes_end();
+      for(; it!=it_end; ++it)
+        fvm_nodes.push_back(*it);
+    }
 
-      Real radii = 5*_lateral_char;
-      std::vector<const Node *> nn = nn_locator->nearest_nodes(track.start, track.end, radii, r);
-      for(unsigned int n=0; n<nn.size(); ++n)
-      {
-        Point loc = *nn[n];
-        FVM_Node * fvm_node = region->region_fvm_node(nn[n]); // may be NULL, if not on local
-        if(!fvm_node || !fvm_node->on_processor()) continue;
-
-        Point loc_pp = track.start + (loc-track.start)*track_dir*track_dir;
-        Real r = (loc-loc_pp).size();
-        double e_r = exp(-r*r/(_lateral_char*_lateral_char));
-        double e_z = Erf((loc_pp-track.start)*track_dir/_lateral_char) - Erf((loc_pp-track.end)*track_dir/_lateral_char);
-        double energy = ed/(2*pi*_lateral_char*_lateral_char)*e_r*e_z;
-        impacted_fvm_nodes.insert(std::make_pair(nn[n], std::make_pair(fvm_node, energy)));
-      }
+    unsigned int changed = (fvm_nodes != _indexed_fvm_nodes || _node_energy.size() != fvm_nodes.size()) ? 1 : 0;
+    Parallel::sum(changed);
+    if(changed)
+    {
+      _indexed_fvm_nodes = fvm_nodes;
+      _build_node_index();
+      _deposit_tracks();
     }
+  }
+
+  // the cached profile is the peak generation, carrier_generation(t) gives its time scaling
+  const double time_norm = _t_char/2.0*sqrt(pi)*(1+Erf((_t_max-_t0)/_t_char));
+  for(unsigned int n=0; n<_bin_nodes.size(); ++n)
+  {
+    if( _node_energy[n] == 0.0 ) continue;
 
+    FVM_Node * fvm_node = _bin_nodes[n];
+    SimulationRegion * region = _system.region(fvm_node->subdomain_id());
+    if( region->type() != SemiconductorRegion) continue;
 
-    // statistic total energy deposit
-    double alpha = 1.0; //used for keep energy conservation
+    FVM_NodeData * node_data = fvm_node->node_data();
+    node_data->PatG() += _node_energy[n]/_quan_eff/time_norm;
+    node_data->PatE() += _node_energy[n];
+  }
+}
+
+
+
+void Particle_Source_Track::_build_node_index()
+{
+  _bin_nodes.clear();
+  _bin_node_x.clear();
+  _bin_node_y.clear();
+  _bin_node_z.clear();
+  _bin_node_volume.clear();
+  _bin_offset.clear();
+
+  // bounding box of local nodes
+  Point p_min( 1e30,  1e30,  1e30);
+  Point p_max(-1e30, -1e30, -1e30);
+  for(unsigned int n=0; n<_indexed_fvm_nodes.size(); ++n)
+  {
+    const Point & p = *_indexed_fvm_nodes[n]->root_node();
+    for(unsigned int d=0; d<3; ++d)
     {
-      double energy_statistics = 0.0;
-      std::multimap<const Node *, std::pair<FVM_Node *, double> >::iterator it=impacted_fvm_nodes.begin();
-      for( ; it!=impacted_fvm_nodes.end(); ++it)
-      {
-        const FVM_Node * fvm_node = it->second.first;
-        if(fvm_node && fvm_node->on_processor())
-          energy_statistics += it->second.second*fvm_node->volume();
-      }
-      Parallel::sum(energy_statistics);
-      alpha = energy_statistics > 0.0 ? track.energy/energy_statistics : 1.0; //used for keep energy conservation
+      p_min(d) = std::min(p_min(d), p(d));
+      p_max(d) = std::max(p_max(d), p(d));
     }
+  }
+  if(_indexed_fvm_nodes.empty())
+  {
+    p_min = Point(0, 0, 0);
+    p_max = Point(0, 0, 0);
+  }
+
+  // bin size matches the kernel cut off radius, but limit the total bin number to
+  // the order of node number, to avoid too many empty bins for small lateral char. length
+  _bin_size = 5*_lateral_char;
+  const double n_bin_limit = 4.0*_indexed_fvm_nodes.size() + 1.0;
+  while(true)
+  {
+    double n_bin = 1.0;
+    for(unsigned int d=0; d<3; ++d)
+      n_bin *= std::floor((p_max(d)-p_min(d))/_bin_size) + 1;
+    if(n_bin <= n_bin_limit) break;
+    _bin_size *= 2.0;
+  }
+
+  _bin_origin = p_min;
+  for(unsigned int d=0; d<3; ++d)
+    _n_bins[d] = static_cast<unsigned int>(std::floor((p_max(d)-p_min(d))/_bin_size)) + 1;
+  const unsigned int n_bins = _n_bins[0]*_n_bins[1]*_n_bins[2];
+
+  // counting sort of the nodes by bin
+  std::vector<unsigned int> node_bin(_indexed_fvm_nodes.size());
+  _bin_offset.resize(n_bins+1, 0);
+  for(unsigned int n=0; n<_indexed_fvm_nodes.size(); ++n)
+  {
+    const Point & p = *_indexed_fvm_nodes[n]->root_node();
+    unsigned int lo[3], hi[3];
+    _bin_range(p, p, lo, hi);
+    node_bin[n] = (lo[2]*_n_bins[1] + lo[1])*_n_bins[0] + lo[0];
+    _bin_offset[node_bin[n]+1]++;
+  }
+  for(unsigned int b=0; b<n_bins; ++b)
+    _bin_offset[b+1] += _bin_offset[b];
 
-    std::multimap<const Node *, std::pair<FVM_Node *, double> >::iterator it=impacted_fvm_nodes.begin();
-    for( ; it!=impacted_fvm_nodes.end(); ++it)
+  _bin_nodes.resize(_indexed_fvm_nodes.size());
+  _bin_node_x.resize(_indexed_fvm_nodes.size());
+  _bin_node_y.resize(_indexed_fvm_nodes.size());
+  _bin_node_z.resize(_indexed_fvm_nodes.size());
+  _bin_node_volume.resize(_indexed_fvm_nodes.size());
+
+  std::vector<unsigned int> fill(_bin_offset.begin(), _bin_offset.end()-1);
+  for(unsigned int n=0; n<_indexed_fvm_nodes.size(); ++n)
+  {
+    FVM_Node * fvm_node = _indexed_fvm_nodes[n];
+    const Point & p = *fvm_node->root_node();
+    unsigned int i = fill[node_bin[n]]++;
+    _bin_nodes[i]       = fvm_node;
+    _bin_node_x[i]      = p(0);
+    _bin_node_y[i]      = p(1);
+    _bin_node_z[i]      = p(2);
+    _bin_node_volume[i] = fvm_node->volume();
+  }
+}
+
+
+
+void Particle_Source_Track::_bin_range(const Point &p_min, const Point &p_max, unsigned int lo[3], unsigned int hi[3]) const
+{
+  for(unsigned int d=0; d<3; ++d)
+  {
+    double l = std::floor((p_min(d)-_bin_origin(d))/_bin_size);
+    double h = std::floor((p_max(d)-_bin_origin(d))/_bin_size);
+    l = std::max(l, 0.0);
+    h = std::min(h, static_cast<double>(_n_bins[d])-1);
+    lo[d] = static_cast<unsigned int>(l);
+    // empty range when the box is outside the grid
+    hi[d] = h < l ? 0 : static_cast<unsigned int>(h);
+    if(h < l) lo[d] = 1;
+  }
+}
+
+
+
+void Particle_Source_Track::_deposit_tracks()
+{
+  START_LOG("_deposit_tracks()", "Particle_Source_Track");
+
+  const double pi = 3.1415926536;
+  const double radii = 5*_lateral_char;
+
+  _node_energy.assign(_bin_nodes.size(), 0.0);
+
+  // energy density of each (track, node) pair, tracks are stored continuously
+  std::vector<unsigned int> hit_node;
+  std::vector<double>       hit_energy;
+  std::vector<unsigned int> track_offset(1, 0);
+  // energy deposit of each track in local nodes
+  std::vector<double>       track_energy(_tracks.size(), 0.0);
+
+  // scratch buffer for batch evaluation of the nodes in one bin
+  std::vector<double> batch_r2, batch_z;
+
+  for(unsigned int t=0; t<_tracks.size(); ++t)
+  {
+    const track_t & track = _tracks[t];
+    // prevent bad tracks
+    if( track.energy == 0.0 || (track.end - track.start).size() == 0.0 )
     {
-      FVM_Node * fvm_node = it->second.first;
-      if(!fvm_node) continue;
+      track_offset.push_back(hit_node.size());
+      continue;
+    }
+
+    const double length = (track.end - track.start).size();
+    const Point track_dir = (track.end - track.start).unit(); // track direction
+    const double ed = track.energy/length; // linear energy density
+    const double scale = ed/(2*pi*_lateral_char*_lateral_char);
 
-      SimulationRegion * region = _system.region(fvm_node->subdomain_id());
-      if( region->type() != SemiconductorRegion) continue;
+    // bins covered by the bounding box of track segment, extended by cut off radius
+    Point p_min, p_max;
+    for(unsigned int d=0; d<3; ++d)
+    {
+      p_min(d) = std::min(track.start(d), track.end(d)) - radii;
+      p_max(d) = std::max(track.start(d), track.end(d)) + radii;
+    }
+    unsigned int lo[3], hi[3];
+    _bin_range(p_min, p_max, lo, hi);
 
-      if(fvm_node && fvm_node->on_local())
+    for(unsigned int k=lo[2]; k<=hi[2]; ++k)
+      for(unsigned int j=lo[1]; j<=hi[1]; ++j)
       {
-        FVM_NodeData * node_data = fvm_node->node_data();
-        node_data->PatG() += alpha*it->second.second/_quan_eff/(_t_char/2.0*sqrt(pi)*(1+Erf((_t_max-_t0)/_t_char)));
-        node_data->PatE() += alpha*it->second.second;//*fvm_node->volume();
-        //total_energy = alpha*it->second.second*fvm_node->volume();
-        //region_energy[ _system.region(fvm_node->subdomain_id())->name() ] += alpha*it->second.second*fvm_node->volume();
+        // bins along x direction are continuous in node arrays
+        if(hi[0] < lo[0]) continue;
+        const unsigned int b_begin = (k*_n_bins[1] + j)*_n_bins[0] + lo[0];
+        const unsigned int b_end   = (k*_n_bins[1] + j)*_n_bins[0] + hi[0] + 1;
+
+        const unsigned int begin = _bin_offset[b_begin];
+        const unsigned int end   = _bin_offset[b_end];
+        const unsigned int size  = end - begin;
+        if(!size) continue;
+
+        // first pass, radial distance and axial projection, branch free
+        batch_r2.resize(size);
+        batch_z.resize(size);
+        const double * x = &_bin_node_x[begin];
+        const double * y = &_bin_node_y[begin];
+        const double * z = &_bin_node_z[begin];
+        for(unsigned int n=0; n<size; ++n)
+        {
+          const double dx = x[n] - track.start(0);
+          const double dy = y[n] - track.start(1);
+          const double dz = z[n] - track.start(2);
+          const double proj = dx*track_dir(0) + dy*track_dir(1) + dz*track_dir(2);
+          batch_z[n]  = proj;
+          batch_r2[n] = dx*dx + dy*dy + dz*dz - proj*proj;
+        }
+
+        // second pass, evaluate kernel for the nodes near the segment
+        for(unsigned int n=0; n<size; ++n)
+        {
+          const double proj = batch_z[n];
+          const double r2   = std::max(batch_r2[n], 0.0);
+          // distance to segment
+          const double over = proj < 0.0 ? -proj : (proj > length ? proj - length : 0.0);
+          if( r2 + over*over > radii*radii ) continue;
+
+          const double e_r = exp(-r2/(_lateral_char*_lateral_char));
+          const double e_z = Erf(proj/_lateral_char) - Erf((proj-length)/_lateral_char);
+          const double energy = scale*e_r*e_z;
+
+          hit_node.push_back(begin + n);
+          hit_energy.push_back(energy);
+          track_energy[t] += energy*_bin_node_volume[begin + n];
+        }
       }
-    }
+
+    track_offset.push_back(hit_node.size());
+  }
+
+  // statistic total energy deposit of all the tracks at once
+  Parallel::sum(track_energy);
+
+  for(unsigned int t=0; t<_tracks.size(); ++t)
+  {
+    double alpha = track_energy[t] > 0.0 ? _tracks[t].energy/track_energy[t] : 1.0; //used for keep energy conservation
+    for(unsigned int h=track_offset[t]; h<track_offset[t+1]; ++h)
+      _node_energy[hit_node[h]] += alpha*hit_energy[h];
   }
 
-  //std::map<std::string, double>::const_iterator it = region_energy.begin();
-  //for(;it != region_energy.end(); ++it)
-  //  std::cout<<it->first << " " << it->second<<std::endl;
-  //std::cout<<total_energy<<std::endl;
+  STOP_LOG("_deposit_tracks()", "Particle_Source_Track");
 }
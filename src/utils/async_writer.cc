@@ -0,0 +1,189 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <iostream>
+
+#include "async_writer.h"
+#include "perf_log.h"
+
+
+AsyncWriter & AsyncWriter::instance()
+{
+  static AsyncWriter writer;
+  return writer;
+}
+
+
+AsyncWriter::AsyncWriter()
+  : _pending_memory(0), _max_pending_memory(512*1024*1024), _busy(false)
+{
+#ifdef HAVE_PTHREAD
+  _thread_started = false;
+  _stop = false;
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_job_cond, NULL);
+  pthread_cond_init(&_done_cond, NULL);
+#endif
+}
+
+
+AsyncWriter::~AsyncWriter()
+{
+#ifdef HAVE_PTHREAD
+  if(_thread_started)
+  {
+    pthread_mutex_lock(&_mutex);
+    _stop = true;
+    pthread_cond_signal(&_job_cond);
+    pthread_mutex_unlock(&_mutex);
+
+    // the thread will finish all the pending jobs before exit
+    pthread_join(_thread, NULL);
+  }
+  pthread_cond_destroy(&_done_cond);
+  pthread_cond_destroy(&_job_cond);
+  pthread_mutex_destroy(&_mutex);
+#endif
+}
+
+
+void AsyncWriter::_execute(Job * job)
+{
+  try
+  {
+    job->run();
+  }
+  catch(...)
+  {
+    std::cerr<<"ERROR: background write of "<<job->file_name()<<" failed."<<std::endl;
+  }
+  delete job;
+}
+
+
+void AsyncWriter::submit(Job * job)
+{
+#ifdef HAVE_PTHREAD
+
+  START_LOG("submit()", "AsyncWriter");
+
+  const size_t size = job->memory_size();
+
+  pthread_mutex_lock(&_mutex);
+
+  // back-pressure: wait for the I/O thread to release memory.
+  // a job larger than the limit is accepted when the queue is empty
+  while( _pending_memory > 0 && _pending_memory + size > _max_pending_memory )
+    pthread_cond_wait(&_done_cond, &_mutex);
+
+  if(!_thread_started)
+  {
+    if( pthread_create(&_thread, NULL, AsyncWriter::_thread_entry, this) == 0 )
+      _thread_started = true;
+  }
+
+  if(_thread_started)
+  {
+    _jobs.push_back(job);
+    _pending_memory += size;
+    pthread_cond_signal(&_job_cond);
+  }
+
+  pthread_mutex_unlock(&_mutex);
+
+  // can not start the thread, write it here
+  if(!_thread_started)
+    _execute(job);
+
+  STOP_LOG("submit()", "AsyncWriter");
+
+#else
+
+  _execute(job);
+
+#endif
+}
+
+
+void AsyncWriter::flush()
+{
+#ifdef HAVE_PTHREAD
+  START_LOG("flush()", "AsyncWriter");
+
+  pthread_mutex_lock(&_mutex);
+  while( !_jobs.empty() || _busy )
+    pthread_cond_wait(&_done_cond, &_mutex);
+  pthread_mutex_unlock(&_mutex);
+
+  STOP_LOG("flush()", "AsyncWriter");
+#endif
+}
+
+
+unsigned int AsyncWriter::n_pending_jobs() const
+{
+  unsigned int n = 0;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_lock(&_mutex);
+  n = _jobs.size() + (_busy ? 1 : 0);
+  pthread_mutex_unlock(&_mutex);
+#endif
+  return n;
+}
+
+
+#ifdef HAVE_PTHREAD
+
+void * AsyncWriter::_thread_entry(void * writer)
+{
+  static_cast<AsyncWriter *>(writer)->_thread_loop();
+  return NULL;
+}
+
+
+void AsyncWriter::_thread_loop()
+{
+  pthread_mutex_lock(&_mutex);
+  while(true)
+  {
+    while( _jobs.empty() && !_stop )
+      pthread_cond_wait(&_job_cond, &_mutex);
+
+    if( _jobs.empty() && _stop ) break;
+
+    Job * job = _jobs.front();
+    _jobs.pop_front();
+    const size_t size = job->memory_size();
+    _busy = true;
+    pthread_mutex_unlock(&_mutex);
+
+    // do the write without lock, the solver may submit more jobs meanwhile
+    _execute(job);
+
+    pthread_mutex_lock(&_mutex);
+    _busy = false;
+    _pending_memory -= size;
+    pthread_cond_broadcast(&_done_cond);
+  }
+  pthread_mutex_unlock(&_mutex);
+}
+
+#endif
@@ -0,0 +1,93 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "genius_common.h"
+#include "parallel.h"
+#include "structure_cache.h"
+
+
+// bump it when the layout of cached structure changes
+#define STRUCTURE_CACHE_VERSION  "1"
+
+namespace {
+
+  // 64bit FNV-1a
+  const unsigned long long fnv_offset = 14695981039346656037ULL;
+  const unsigned long long fnv_prime  = 1099511628211ULL;
+
+  void fnv_hash(unsigned long long & h, const char * data, size_t n)
+  {
+    for(size_t i=0; i<n; ++i)
+    {
+      h ^= static_cast<unsigned char>(data[i]);
+      h *= fnv_prime;
+    }
+  }
+
+  bool fnv_hash_file(unsigned long long & h, const std::string & file)
+  {
+    FILE * fp = fopen(file.c_str(), "rb");
+    if( !fp ) return false;
+
+    std::vector<char> buffer(1<<20);
+    size_t n;
+    while( (n = fread(&buffer[0], 1, buffer.size(), fp)) > 0 )
+      fnv_hash(h, &buffer[0], n);
+
+    fclose(fp);
+    return true;
+  }
+
+}
+
+
+std::string structure_cache_file(const std::vector<std::string> & sources, const std::string & format)
+{
+  std::string cache_file;
+
+  if( Genius::processor_id() == 0 && !sources.empty() )
+  {
+    unsigned long long h = fnv_offset;
+
+    std::string salt = std::string(STRUCTURE_CACHE_VERSION) + format;
+    fnv_hash(h, salt.c_str(), salt.size());
+
+    bool readable = true;
+    for(unsigned int n=0; n<sources.size(); ++n)
+      readable = readable && fnv_hash_file(h, sources[n]);
+
+    if( readable )
+    {
+      std::ostringstream ss;
+      ss << sources[0] << '.' << std::hex << std::setw(16) << std::setfill('0') << h << ".cache.cgns";
+      cache_file = ss.str();
+    }
+  }
+
+  Parallel::broadcast(cache_file);
+
+  return cache_file;
+}